@@ -36,9 +36,16 @@ namespace golos { namespace api {
 
         void select_active_votes(
             std::vector<vote_state>& result, uint32_t& total_count,
-            const std::string& author, const std::string& permlink, uint32_t limit
+            const std::string& author, const std::string& permlink, uint32_t limit,
+            vote_order order, const std::string& start_voter
         ) const ;
 
+        template <typename Index>
+        void select_active_votes(
+            std::vector<vote_state>& result, const comment_object& comment,
+            uint32_t limit, const std::string& start_voter
+        ) const;
+
         share_type get_curator_unclaimed_rewards(const discussion& d, share_type max_rewards) const;
 
         void set_pending_payout(discussion& d) const;
@@ -133,7 +140,8 @@ namespace golos { namespace api {
         discussion d = create_discussion(c);
         set_url(d);
         set_pending_payout(d);
-        select_active_votes(d.active_votes, d.active_votes_count, d.author, d.permlink, vote_limit);
+        select_active_votes(
+            d.active_votes, d.active_votes_count, d.author, d.permlink, vote_limit, vote_order::by_voter, std::string());
         return d;
     }
 
@@ -143,27 +151,60 @@ namespace golos { namespace api {
 //
 
 // select_active_votes
+    template <typename Index>
+    void discussion_helper::impl::select_active_votes(
+        std::vector<vote_state>& result, const comment_object& comment,
+        uint32_t limit, const std::string& start_voter
+    ) const {
+        const auto& votes = database().get_index<comment_vote_index>().indices();
+        const auto& idx = votes.get<Index>();
+        comment_object::id_type cid(comment.id);
+
+        auto itr = idx.lower_bound(cid);
+        if (!start_voter.empty()) {
+            const auto* voter = database().find_account(start_voter);
+            if (voter == nullptr) {
+                return;
+            }
+            const auto& voter_idx = votes.get<by_comment_voter>();
+            auto voter_itr = voter_idx.find(std::make_tuple(cid, voter->id));
+            if (voter_itr == voter_idx.end()) {
+                return;
+            }
+            itr = idx.iterator_to(*voter_itr);
+        }
+
+        for (; itr != idx.end() && itr->comment == cid && result.size() < limit; ++itr) {
+            const auto& vo = database().get(itr->voter);
+            vote_state vstate;
+            vstate.voter = vo.name;
+            vstate.weight = itr->weight;
+            vstate.rshares = itr->rshares;
+            vstate.percent = itr->vote_percent;
+            vstate.time = itr->last_update;
+            fill_reputation_(database(), vo.name, vstate.reputation);
+            result.emplace_back(vstate);
+        }
+    }
+
     void discussion_helper::impl::select_active_votes(
         std::vector<vote_state>& result, uint32_t& total_count,
-        const std::string& author, const std::string& permlink, uint32_t limit
+        const std::string& author, const std::string& permlink, uint32_t limit,
+        vote_order order, const std::string& start_voter
     ) const {
         const auto& comment = database().get_comment(author, permlink);
-        const auto& idx = database().get_index<comment_vote_index>().indices().get<by_comment_voter>();
-        comment_object::id_type cid(comment.id);
-        total_count = 0;
+        total_count = comment.vote_count;
         result.clear();
-        for (auto itr = idx.lower_bound(cid); itr != idx.end() && itr->comment == cid; ++itr, ++total_count) {
-            if (result.size() < limit) {
-                const auto& vo = database().get(itr->voter);
-                vote_state vstate;
-                vstate.voter = vo.name;
-                vstate.weight = itr->weight;
-                vstate.rshares = itr->rshares;
-                vstate.percent = itr->vote_percent;
-                vstate.time = itr->last_update;
-                fill_reputation_(database(), vo.name, vstate.reputation);
-                result.emplace_back(vstate);
-            }
+        switch (order) {
+            case vote_order::by_rshares:
+                select_active_votes<by_comment_rshares_voter>(result, comment, limit, start_voter);
+                break;
+            case vote_order::by_last_update:
+                select_active_votes<by_comment_last_update_voter>(result, comment, limit, start_voter);
+                break;
+            default:
+                select_active_votes<by_comment_voter>(result, comment, limit, start_voter);
+                break;
         }
     }
 
@@ -171,7 +212,15 @@ namespace golos { namespace api {
         std::vector<vote_state>& result, uint32_t& total_count,
         const std::string& author, const std::string& permlink, uint32_t limit
     ) const {
-        pimpl->select_active_votes(result, total_count, author, permlink, limit);
+        pimpl->select_active_votes(result, total_count, author, permlink, limit, vote_order::by_voter, std::string());
+    }
+
+    void discussion_helper::select_active_votes(
+        std::vector<vote_state>& result, uint32_t& total_count,
+        const std::string& author, const std::string& permlink, uint32_t limit,
+        vote_order order, const std::string& start_voter
+    ) const {
+        pimpl->select_active_votes(result, total_count, author, permlink, limit, order, start_voter);
     }
 
     share_type discussion_helper::impl::get_curator_unclaimed_rewards(const discussion& d, share_type max_rewards) const {
@@ -31,6 +31,16 @@ namespace golos { namespace api {
             const std::string& author, const std::string& permlink, uint32_t limit
         ) const;
 
+        /**
+         * Selects up to limit votes of comment in the order starting from the vote of start_voter (inclusive),
+         * total_count is the number of all votes of comment.
+         */
+        void select_active_votes(
+            std::vector<vote_state>& result, uint32_t& total_count,
+            const std::string& author, const std::string& permlink, uint32_t limit,
+            vote_order order, const std::string& start_voter
+        ) const;
+
         discussion create_discussion(const std::string& author) const;
 
         discussion create_discussion(const comment_object& o) const;
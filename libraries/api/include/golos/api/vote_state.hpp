@@ -13,7 +13,18 @@ namespace golos { namespace api {
         time_point_sec time;
     };
 
+    /**
+     * Order of votes in get_active_votes
+     */
+    enum class vote_order: uint8_t {
+        by_voter,       ///< by id of voter
+        by_rshares,     ///< from the largest rshares
+        by_last_update  ///< from the newest votes
+    };
+
 } } // golos::api
 
 
-FC_REFLECT((golos::api::vote_state), (voter)(weight)(rshares)(percent)(reputation)(time));
\ No newline at end of file
+FC_REFLECT((golos::api::vote_state), (voter)(weight)(rshares)(percent)(reputation)(time));
+
+FC_REFLECT_ENUM(golos::api::vote_order, (by_voter)(by_rshares)(by_last_update))
\ No newline at end of file
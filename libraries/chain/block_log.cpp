@@ -1,6 +1,7 @@
 #include <algorithm>
 #include <fstream>
 #include <golos/chain/block_log.hpp>
+#include <golos/chain/compressed_block_log.hpp>
 #include <golos/protocol/exceptions.hpp>
 #include <boost/iostreams/device/mapped_file.hpp>
 #include <boost/filesystem.hpp>
@@ -102,6 +103,37 @@ namespace golos { namespace chain {
                 return end_pos + sizeof(uint64_t);
             }
 
+            uint32_t read_packed_blocks(
+                uint32_t first_block_num, uint32_t count, std::size_t max_size, std::vector<char>& result
+            ) const {
+                if (!head.valid() || first_block_num == 0) {
+                    return 0;
+                }
+
+                const auto head_num = protocol::block_header::num_from_id(head_id);
+                const auto file_size = get_mapped_size(block_mapped_file);
+                uint32_t read_count = 0;
+                for (auto block_num = first_block_num; read_count < count && block_num <= head_num; ++block_num) {
+                    // each block is followed by its position
+                    const auto pos = get_block_pos(block_num);
+                    const auto next_pos = block_num < head_num ? get_block_pos(block_num + 1) : file_size;
+                    GOLOS_CHECK_DATABASE(pos + sizeof(uint64_t) < next_pos &&
+                        get_uint64(block_mapped_file, next_pos - sizeof(uint64_t)) == pos,
+                        database_corrupted::wrong_position_marker_was_read,
+                        "Wrong position makers was read (read ${block_pos}, expected ${expected})",
+                        ("block_pos", next_pos)("expected", pos));
+
+                    const auto size = next_pos - sizeof(uint64_t) - pos;
+                    if (read_count > 0 && result.size() + size > max_size) {
+                        break;
+                    }
+                    const auto* ptr = block_mapped_file.data() + pos;
+                    result.insert(result.end(), ptr, ptr + size);
+                    ++read_count;
+                }
+                return read_count;
+            }
+
             signed_block read_head() const {
                 auto pos = get_last_uint64(block_mapped_file);
                 signed_block block;
@@ -252,20 +284,43 @@ namespace golos { namespace chain {
 
     void block_log::open(const fc::path& file) {
         detail::write_lock lock(my->mutex);
+        if (compressed_block_log::is_compressed(file)) {
+            my->close();
+            ilog("Block log is compressed");
+            compressed = std::make_unique<compressed_block_log>();
+            compressed->open(file);
+            return;
+        }
+        compressed.reset();
         my->open(file);
     }
 
     void block_log::close() {
         detail::write_lock lock(my->mutex);
+        if (compressed) {
+            compressed->close();
+            return;
+        }
         my->close();
     }
 
     bool block_log::is_open() const {
         detail::read_lock lock(my->mutex);
+        if (compressed) {
+            return compressed->is_open();
+        }
         return my->block_mapped_file.is_open();
     }
 
+    bool block_log::is_compressed() const {
+        detail::read_lock lock(my->mutex);
+        return !!compressed;
+    }
+
     uint64_t block_log::append(const signed_block& block) { try {
+        if (compressed) {
+            return compressed->append(block);
+        }
         auto data = fc::raw::pack(block);
         detail::write_lock lock(my->mutex);
         return my->append(block, data);
@@ -276,6 +331,9 @@ namespace golos { namespace chain {
     }
 
     std::pair<signed_block, uint64_t> block_log::read_block(uint64_t pos) const {
+        if (compressed) {
+            return compressed->read_block(pos);
+        }
         detail::read_lock lock(my->mutex);
         std::pair<signed_block, uint64_t> result;
         result.second = my->read_block(pos, result.first);
@@ -283,6 +341,9 @@ namespace golos { namespace chain {
     }
 
     optional<signed_block> block_log::read_block_by_num(uint32_t block_num) const { try {
+        if (compressed) {
+            return compressed->read_block_by_num(block_num);
+        }
         detail::read_lock lock(my->mutex);
         optional<signed_block> result;
         uint64_t pos = my->get_block_pos(block_num);
@@ -298,17 +359,49 @@ namespace golos { namespace chain {
         return result;
     } FC_LOG_AND_RETHROW() }
 
+    uint32_t block_log::read_packed_blocks(
+        uint32_t first_block_num, uint32_t count, std::size_t max_size, std::vector<char>& result
+    ) const { try {
+        if (compressed) {
+            // blocks are unpacked from frames and packed again
+            uint32_t read_count = 0;
+            for (; read_count < count; ++read_count) {
+                auto block = compressed->read_block_by_num(first_block_num + read_count);
+                if (!block) {
+                    break;
+                }
+                auto data = fc::raw::pack(*block);
+                if (read_count > 0 && result.size() + data.size() > max_size) {
+                    break;
+                }
+                result.insert(result.end(), data.begin(), data.end());
+            }
+            return read_count;
+        }
+        detail::read_lock lock(my->mutex);
+        return my->read_packed_blocks(first_block_num, count, max_size, result);
+    } FC_LOG_AND_RETHROW() }
+
     uint64_t block_log::get_block_pos(uint32_t block_num) const {
+        if (compressed) {
+            return compressed->get_block_pos(block_num);
+        }
         detail::read_lock lock(my->mutex);
         return my->get_block_pos(block_num);
     }
 
     signed_block block_log::read_head() const {
+        if (compressed) {
+            return compressed->read_head();
+        }
         detail::read_lock lock(my->mutex);
         return my->read_head();
     }
 
     const optional<signed_block>& block_log::head() const {
+        if (compressed) {
+            return compressed->head();
+        }
         detail::read_lock lock(my->mutex);
         return my->head;
     }
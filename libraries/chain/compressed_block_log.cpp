@@ -0,0 +1,509 @@
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <golos/chain/compressed_block_log.hpp>
+#include <golos/protocol/exceptions.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/thread/shared_mutex.hpp>
+#include <zlib.h>
+
+namespace golos { namespace chain {
+    namespace detail {
+        using read_write_mutex = boost::shared_mutex;
+        using read_lock = boost::shared_lock<read_write_mutex>;
+        using write_lock = boost::unique_lock<read_write_mutex>;
+
+        static constexpr char compressed_log_magic[8] = {'G', 'L', 'S', 'B', 'L', 'O', 'G', '2'};
+
+        struct file_header final {
+            char magic[8];
+            uint32_t frame_size = 0;
+            uint32_t reserved = 0;
+        };
+
+        struct frame_header final {
+            uint32_t compressed_size = 0;
+            uint32_t raw_size = 0;
+            uint32_t first_block_num = 0;
+            uint32_t block_count = 0;
+        };
+
+        struct head_header final {
+            uint32_t first_block_num = 0;
+            uint32_t reserved = 0;
+        };
+
+        using frame_data = std::shared_ptr<const std::vector<char>>;
+
+        class compressed_block_log_impl {
+        public:
+            optional<signed_block> head;
+            block_id_type head_id;
+            uint32_t frame_size = 0;
+
+            std::string block_path;
+            std::string index_path;
+            std::string head_path;
+            boost::iostreams::mapped_file_source block_mapped_file;
+
+            // positions of frames in the main file
+            std::vector<uint64_t> frames;
+            // packed blocks of the head frame
+            std::vector<std::vector<char>> head_blocks;
+            read_write_mutex mutex;
+
+            // the last decompressed frame, sequential reads hit it frame_size - 1 times of frame_size
+            mutable std::mutex cache_mutex;
+            mutable uint64_t cached_frame = compressed_block_log::npos;
+            mutable frame_data cached_data;
+
+            uint32_t head_block_num() const {
+                return frames.size() * frame_size + head_blocks.size();
+            }
+
+            uint32_t head_frame_first_block_num() const {
+                return frames.size() * frame_size + 1;
+            }
+
+            uint64_t get_block_pos(uint32_t block_num) const {
+                if (block_num > 0 && block_num <= head_block_num()) {
+                    return block_num - 1;
+                }
+                return compressed_block_log::npos;
+            }
+
+            frame_header read_frame_header(uint64_t pos) const {
+                frame_header header;
+                const auto file_size = block_mapped_file.size();
+                GOLOS_CHECK_DATABASE(pos + sizeof(header) <= file_size,
+                    database_corrupted::reading_data_beyond_end_of_file,
+                    "Reading data beyond end of file",
+                    ("pos", pos)("size", sizeof(header))("file_size", file_size));
+
+                std::memcpy(&header, block_mapped_file.data() + pos, sizeof(header));
+                return header;
+            }
+
+            frame_data read_frame(std::size_t frame) const {
+                {
+                    std::lock_guard<std::mutex> lock(cache_mutex);
+                    if (cached_frame == frame) {
+                        return cached_data;
+                    }
+                }
+
+                const auto pos = frames[frame];
+                const auto header = read_frame_header(pos);
+                const auto file_size = block_mapped_file.size();
+                const auto data_pos = pos + sizeof(header);
+                GOLOS_CHECK_DATABASE(data_pos + header.compressed_size <= file_size,
+                    database_corrupted::reading_data_beyond_end_of_file,
+                    "Reading data beyond end of file",
+                    ("pos", data_pos)("size", header.compressed_size)("file_size", file_size));
+
+                auto data = std::make_shared<std::vector<char>>(header.raw_size);
+                uLongf raw_size = header.raw_size;
+                auto result = uncompress(
+                    reinterpret_cast<Bytef*>(data->data()), &raw_size,
+                    reinterpret_cast<const Bytef*>(block_mapped_file.data() + data_pos), header.compressed_size);
+                GOLOS_CHECK_DATABASE(result == Z_OK && raw_size == header.raw_size,
+                    database_corrupted::decompression_failed,
+                    "Can't decompress frame ${frame} of block log",
+                    ("frame", frame)("pos", pos)("result", result));
+
+                std::lock_guard<std::mutex> lock(cache_mutex);
+                cached_frame = frame;
+                cached_data = data;
+                return data;
+            }
+
+            void read_block(uint32_t block_num, signed_block& block) const {
+                GOLOS_CHECK_DATABASE(block_num > 0 && block_num <= head_block_num(),
+                    database_corrupted::reading_data_beyond_end_of_file,
+                    "Reading block beyond end of block log",
+                    ("block_num", block_num)("head_block_num", head_block_num()));
+
+                const auto first_head_block_num = head_frame_first_block_num();
+                if (block_num >= first_head_block_num) {
+                    const auto& data = head_blocks[block_num - first_head_block_num];
+                    fc::datastream<const char*> ds(data.data(), data.size());
+                    fc::raw::unpack(ds, block);
+                } else {
+                    const auto frame = (block_num - 1) / frame_size;
+                    const auto index = (block_num - 1) % frame_size;
+                    const auto data = read_frame(frame);
+                    const auto* offsets = reinterpret_cast<const uint32_t*>(data->data());
+
+                    const uint32_t begin = offsets[index];
+                    const uint32_t end = (index + 1 < frame_size) ? offsets[index + 1] : data->size();
+                    GOLOS_CHECK_DATABASE(begin <= end && end <= data->size(),
+                        database_corrupted::reading_data_beyond_end_of_file,
+                        "Reading data beyond end of frame",
+                        ("begin", begin)("end", end)("frame_size", data->size()));
+
+                    fc::datastream<const char*> ds(data->data() + begin, end - begin);
+                    fc::raw::unpack(ds, block);
+                }
+
+                GOLOS_CHECK_DATABASE(block.block_num() == block_num,
+                    database_corrupted::wrong_block_num_was_read,
+                    "Wrong block was read from block log (read ${block_num}, expected ${expected}).",
+                    ("block_num", block.block_num())("expected", block_num));
+            }
+
+            signed_block read_head() const {
+                signed_block block;
+                read_block(head_block_num(), block);
+                return block;
+            }
+
+            void create_block_file(uint32_t new_frame_size) const {
+                file_header header;
+                std::memcpy(header.magic, compressed_log_magic, sizeof(header.magic));
+                header.frame_size = new_frame_size;
+
+                std::ofstream stream(block_path, std::ios::out|std::ios::binary|std::ios::trunc);
+                stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+                FC_ASSERT(stream.good(), "Can't create block log ${path}", ("path", block_path));
+            }
+
+            void reset_head_file(uint32_t first_block_num) const {
+                head_header header;
+                header.first_block_num = first_block_num;
+
+                std::ofstream stream(head_path, std::ios::out|std::ios::binary|std::ios::trunc);
+                stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+                FC_ASSERT(stream.good(), "Can't write block log head file ${path}", ("path", head_path));
+            }
+
+            void open_block_mapped_file() {
+                block_mapped_file.close();
+                block_mapped_file.open(block_path);
+            }
+
+            void reset_cache() {
+                std::lock_guard<std::mutex> lock(cache_mutex);
+                cached_frame = compressed_block_log::npos;
+                cached_data.reset();
+            }
+
+            bool load_index() {
+                frames.clear();
+
+                std::ifstream stream(index_path, std::ios::in|std::ios::binary);
+                if (!stream.good()) {
+                    return false;
+                }
+
+                uint64_t pos;
+                while (stream.read(reinterpret_cast<char*>(&pos), sizeof(pos))) {
+                    frames.push_back(pos);
+                }
+
+                // index is valid if its last frame ends exactly at the end of the main file
+                uint64_t end_pos = sizeof(file_header);
+                if (!frames.empty()) {
+                    if (frames.back() + sizeof(frame_header) > block_mapped_file.size()) {
+                        return false;
+                    }
+                    auto header = read_frame_header(frames.back());
+                    if (header.first_block_num != (frames.size() - 1) * frame_size + 1) {
+                        return false;
+                    }
+                    end_pos = frames.back() + sizeof(header) + header.compressed_size;
+                }
+                return end_pos == block_mapped_file.size();
+            }
+
+            void construct_index() {
+                ilog("Reconstructing Block Log Index...");
+                frames.clear();
+
+                const uint64_t file_size = block_mapped_file.size();
+                uint64_t pos = sizeof(file_header);
+                while (pos + sizeof(frame_header) <= file_size) {
+                    auto header = read_frame_header(pos);
+                    auto end_pos = pos + sizeof(header) + header.compressed_size;
+                    if (end_pos > file_size ||
+                        header.first_block_num != frames.size() * frame_size + 1 ||
+                        header.block_count != frame_size
+                    ) {
+                        break;
+                    }
+                    frames.push_back(pos);
+                    pos = end_pos;
+                }
+
+                if (pos != file_size) {
+                    wlog("Block log has ${n} bytes of incomplete frame, truncate it", ("n", file_size - pos));
+                    block_mapped_file.close();
+                    boost::filesystem::resize_file(block_path, pos);
+                    open_block_mapped_file();
+                }
+
+                std::ofstream stream(index_path, std::ios::out|std::ios::binary|std::ios::trunc);
+                for (auto frame_pos: frames) {
+                    stream.write(reinterpret_cast<const char*>(&frame_pos), sizeof(frame_pos));
+                }
+                FC_ASSERT(stream.good(), "Can't write block log index ${path}", ("path", index_path));
+            }
+
+            void load_head_blocks() {
+                head_blocks.clear();
+
+                const auto first_block_num = head_frame_first_block_num();
+                std::ifstream stream(head_path, std::ios::in|std::ios::binary);
+                head_header header;
+                if (!stream.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+                    reset_head_file(first_block_num);
+                    return;
+                }
+
+                if (header.first_block_num != first_block_num) {
+                    // the frame was already moved to the main file, but the head file wasn't reset
+                    wlog("Head file of block log starts from block ${n}, expected ${e}, reset it",
+                        ("n", header.first_block_num)("e", first_block_num));
+                    stream.close();
+                    reset_head_file(first_block_num);
+                    return;
+                }
+
+                uint64_t valid_size = sizeof(header);
+                uint32_t size;
+                while (stream.read(reinterpret_cast<char*>(&size), sizeof(size))) {
+                    std::vector<char> data(size);
+                    if (!stream.read(data.data(), size)) {
+                        break;
+                    }
+                    head_blocks.push_back(std::move(data));
+                    valid_size += sizeof(size) + size;
+                }
+                stream.close();
+
+                if (valid_size != boost::filesystem::file_size(head_path)) {
+                    wlog("Head file of block log has incomplete block, truncate it");
+                    boost::filesystem::resize_file(head_path, valid_size);
+                }
+            }
+
+            void open(const fc::path& file, uint32_t new_frame_size) { try {
+                close();
+
+                block_path = file.string();
+                index_path = block_path + ".index";
+                head_path = block_path + ".head";
+
+                if (!boost::filesystem::is_regular_file(block_path) || boost::filesystem::file_size(block_path) == 0) {
+                    FC_ASSERT(new_frame_size > 0, "Size of frame should be positive");
+                    create_block_file(new_frame_size);
+                    boost::filesystem::remove_all(index_path);
+                    boost::filesystem::remove_all(head_path);
+                }
+
+                file_header header;
+                {
+                    std::ifstream stream(block_path, std::ios::in|std::ios::binary);
+                    stream.read(reinterpret_cast<char*>(&header), sizeof(header));
+                    FC_ASSERT(stream.good() &&
+                        std::memcmp(header.magic, compressed_log_magic, sizeof(header.magic)) == 0 &&
+                        header.frame_size > 0,
+                        "File ${path} isn't a compressed block log", ("path", block_path));
+                }
+                frame_size = header.frame_size;
+
+                open_block_mapped_file();
+
+                if (!load_index()) {
+                    construct_index();
+                }
+
+                load_head_blocks();
+                if (head_blocks.size() >= frame_size) {
+                    ilog("Head frame of block log is full, move it to the main file");
+                    head_blocks.resize(frame_size);
+                    write_head_frame();
+                }
+
+                if (head_block_num() > 0) {
+                    head = read_head();
+                    head_id = head->id();
+                }
+
+                ilog("Block log has ${f} frames of ${s} blocks and ${h} blocks in head frame",
+                    ("f", frames.size())("s", frame_size)("h", head_blocks.size()));
+            } FC_LOG_AND_RETHROW() }
+
+            void write_head_frame() {
+                const auto first_block_num = head_frame_first_block_num();
+                const uint32_t count = head_blocks.size();
+
+                std::vector<uint32_t> offsets(count);
+                uint32_t offset = count * sizeof(uint32_t);
+                for (uint32_t i = 0; i < count; ++i) {
+                    offsets[i] = offset;
+                    offset += head_blocks[i].size();
+                }
+
+                std::vector<char> raw;
+                raw.reserve(offset);
+                raw.insert(raw.end(),
+                    reinterpret_cast<const char*>(offsets.data()),
+                    reinterpret_cast<const char*>(offsets.data() + count));
+                for (const auto& data: head_blocks) {
+                    raw.insert(raw.end(), data.begin(), data.end());
+                }
+
+                uLongf compressed_size = compressBound(raw.size());
+                std::vector<char> compressed(compressed_size);
+                auto result = compress2(
+                    reinterpret_cast<Bytef*>(compressed.data()), &compressed_size,
+                    reinterpret_cast<const Bytef*>(raw.data()), raw.size(), Z_DEFAULT_COMPRESSION);
+                FC_ASSERT(result == Z_OK, "Can't compress frame of block log", ("result", result));
+
+                frame_header header;
+                header.compressed_size = compressed_size;
+                header.raw_size = raw.size();
+                header.first_block_num = first_block_num;
+                header.block_count = count;
+
+                const uint64_t pos = block_mapped_file.size();
+                block_mapped_file.close();
+                {
+                    std::ofstream stream(block_path, std::ios::out|std::ios::binary|std::ios::app);
+                    stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+                    stream.write(compressed.data(), compressed_size);
+                    FC_ASSERT(stream.good(), "Can't write block log ${path}", ("path", block_path));
+                }
+                open_block_mapped_file();
+
+                {
+                    std::ofstream stream(index_path, std::ios::out|std::ios::binary|std::ios::app);
+                    stream.write(reinterpret_cast<const char*>(&pos), sizeof(pos));
+                    FC_ASSERT(stream.good(), "Can't write block log index ${path}", ("path", index_path));
+                }
+
+                frames.push_back(pos);
+                head_blocks.clear();
+                reset_head_file(head_frame_first_block_num());
+                reset_cache();
+            }
+
+            uint64_t append(const signed_block& b, const std::vector<char>& data) { try {
+                GOLOS_CHECK_DATABASE(b.block_num() == head_block_num() + 1,
+                    database_corrupted::append_index_file_at_wrong_position,
+                    "Append to block log occuring at wrong position.",
+                    ("block_num", b.block_num())
+                    ("expected", head_block_num() + 1));
+
+                {
+                    const uint32_t size = data.size();
+                    std::ofstream stream(head_path, std::ios::out|std::ios::binary|std::ios::app);
+                    stream.write(reinterpret_cast<const char*>(&size), sizeof(size));
+                    stream.write(data.data(), data.size());
+                    FC_ASSERT(stream.good(), "Can't write block log head file ${path}", ("path", head_path));
+                }
+                head_blocks.push_back(data);
+
+                head = b;
+                head_id = b.id();
+
+                if (head_blocks.size() >= frame_size) {
+                    write_head_frame();
+                }
+                return b.block_num() - 1;
+            } FC_LOG_AND_RETHROW() }
+
+            void close() {
+                block_mapped_file.close();
+                frames.clear();
+                head_blocks.clear();
+                head.reset();
+                head_id = block_id_type();
+                reset_cache();
+            }
+        };
+    }
+
+    compressed_block_log::compressed_block_log()
+            : my(std::make_unique<detail::compressed_block_log_impl>()) {
+    }
+
+    compressed_block_log::~compressed_block_log() {
+        flush();
+    }
+
+    void compressed_block_log::open(const fc::path& file, uint32_t frame_size) {
+        detail::write_lock lock(my->mutex);
+        my->open(file, frame_size);
+    }
+
+    void compressed_block_log::close() {
+        detail::write_lock lock(my->mutex);
+        my->close();
+    }
+
+    bool compressed_block_log::is_open() const {
+        detail::read_lock lock(my->mutex);
+        return my->block_mapped_file.is_open();
+    }
+
+    uint64_t compressed_block_log::append(const signed_block& block) { try {
+        auto data = fc::raw::pack(block);
+        detail::write_lock lock(my->mutex);
+        return my->append(block, data);
+    } FC_LOG_AND_RETHROW() }
+
+    void compressed_block_log::flush() {
+        // it isn't needed, because all files are written on append
+    }
+
+    std::pair<signed_block, uint64_t> compressed_block_log::read_block(uint64_t pos) const {
+        detail::read_lock lock(my->mutex);
+        std::pair<signed_block, uint64_t> result;
+        my->read_block(pos + 1, result.first);
+        result.second = pos + 1;
+        return result;
+    }
+
+    optional<signed_block> compressed_block_log::read_block_by_num(uint32_t block_num) const { try {
+        detail::read_lock lock(my->mutex);
+        optional<signed_block> result;
+        if (my->get_block_pos(block_num) != npos) {
+            signed_block block;
+            my->read_block(block_num, block);
+            result = std::move(block);
+        }
+        return result;
+    } FC_LOG_AND_RETHROW() }
+
+    uint64_t compressed_block_log::get_block_pos(uint32_t block_num) const {
+        detail::read_lock lock(my->mutex);
+        return my->get_block_pos(block_num);
+    }
+
+    signed_block compressed_block_log::read_head() const {
+        detail::read_lock lock(my->mutex);
+        return my->read_head();
+    }
+
+    const optional<signed_block>& compressed_block_log::head() const {
+        detail::read_lock lock(my->mutex);
+        return my->head;
+    }
+
+    uint32_t compressed_block_log::frame_size() const {
+        detail::read_lock lock(my->mutex);
+        return my->frame_size;
+    }
+
+    bool compressed_block_log::is_compressed(const fc::path& file) {
+        char magic[sizeof(detail::compressed_log_magic)];
+        std::ifstream stream(file.string(), std::ios::in|std::ios::binary);
+        if (!stream.read(magic, sizeof(magic))) {
+            return false;
+        }
+        return std::memcmp(magic, detail::compressed_log_magic, sizeof(magic)) == 0;
+    }
+} } // golos::chain
@@ -28,9 +28,14 @@
 #include <fc/io/json.hpp>
 
 #include <appbase/application.hpp>
+#include <algorithm>
 #include <csignal>
 #include <cerrno>
 #include <cstring>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 
 #define VIRTUAL_SCHEDULE_LAP_LENGTH  ( fc::uint128_t(uint64_t(-1)) )
 #define VIRTUAL_SCHEDULE_LAP_LENGTH2 ( fc::uint128_t::max_value() )
@@ -66,6 +71,11 @@ namespace golos { namespace chain {
         using std::sig_atomic_t;
         using boost::container::flat_set;
 
+        static size_t max_block_header_size() {
+            static const size_t size = fc::raw::pack_size(signed_block_header()) + 4;
+            return size;
+        }
+
         inline u256 to256(const fc::uint128_t &t) {
             u256 v(t.hi);
             v <<= 64;
@@ -165,6 +175,178 @@ namespace golos { namespace chain {
             return is_interrupted;
         }
 
+        /**
+         * Reads blocks from the block log ahead of the applying thread during replay.
+         *
+         * Block numbers are distributed between reader threads in round-robin order. Each reader
+         *   unpacks its blocks, precomputes transaction ids and puts the result into a ring of slots,
+         *   so the applying thread takes blocks back strictly in order of block numbers.
+         */
+        class replay_pipeline final {
+        public:
+            struct item final {
+                signed_block block;
+                uint64_t block_pos = 0;
+                std::vector<transaction_id_type> trx_ids;
+            };
+
+            replay_pipeline(
+                const block_log& log, uint32_t from_block_num, uint32_t last_block_num,
+                uint32_t threads, uint32_t queue_size);
+
+            ~replay_pipeline();
+
+            /**
+             * Waits for the next block. Returns false if all blocks were read or the pipeline was stopped.
+             * Rethrows an exception if it happened in a reader thread.
+             */
+            bool pop(item& result);
+
+            void stop();
+
+            /// Time of waiting for a free slot, summed by all readers
+            fc::microseconds reader_stall_time() const {
+                return fc::microseconds(_reader_stall_time.load());
+            }
+
+            /// Time of waiting for a next block in the applying thread
+            fc::microseconds apply_stall_time() const {
+                return fc::microseconds(_apply_stall_time);
+            }
+
+        private:
+            struct slot final {
+                bool ready = false;
+                item value;
+            };
+
+            void read_loop(uint32_t block_num);
+
+            const block_log& _log;
+            const uint32_t _last_block_num;
+            const uint32_t _threads;
+            uint32_t _next_block_num;
+            bool _stopped = false;
+            std::exception_ptr _error;
+
+            std::vector<slot> _slots;
+            std::mutex _mutex;
+            std::condition_variable _slot_ready;
+            std::condition_variable _slot_free;
+
+            std::atomic<int64_t> _reader_stall_time{0};
+            int64_t _apply_stall_time = 0;
+
+            std::vector<std::thread> _readers;
+        };
+
+        replay_pipeline::replay_pipeline(
+            const block_log& log, uint32_t from_block_num, uint32_t last_block_num,
+            uint32_t threads, uint32_t queue_size
+        ) : _log(log),
+            _last_block_num(last_block_num),
+            _threads(std::max<uint32_t>(threads, 1)),
+            _next_block_num(from_block_num),
+            _slots(std::max(queue_size, _threads)) {
+
+            _readers.reserve(_threads);
+            for (uint32_t i = 0; i < _threads; ++i) {
+                _readers.emplace_back([this, from_block_num, i]() {
+                    read_loop(from_block_num + i);
+                });
+            }
+        }
+
+        replay_pipeline::~replay_pipeline() {
+            stop();
+            for (auto& reader: _readers) {
+                reader.join();
+            }
+        }
+
+        void replay_pipeline::stop() {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _stopped = true;
+            _slot_free.notify_all();
+            _slot_ready.notify_all();
+        }
+
+        void replay_pipeline::read_loop(uint32_t block_num) {
+            try {
+                for (; block_num <= _last_block_num; block_num += _threads) {
+                    item value;
+                    value.block_pos = _log.get_block_pos(block_num);
+
+                    auto block = _log.read_block_by_num(block_num);
+                    GOLOS_CHECK_DATABASE(block.valid(),
+                        database_corrupted::wrong_block_num_was_read,
+                        "Block ${block_num} is absent in block log", ("block_num", block_num));
+                    value.block = std::move(*block);
+
+                    value.trx_ids.reserve(value.block.transactions.size());
+                    for (const auto& trx: value.block.transactions) {
+                        value.trx_ids.push_back(trx.id());
+                    }
+
+                    std::unique_lock<std::mutex> lock(_mutex);
+                    if (!_stopped && block_num >= _next_block_num + _slots.size()) {
+                        auto start = fc::time_point::now();
+                        _slot_free.wait(lock, [&]() {
+                            return _stopped || block_num < _next_block_num + _slots.size();
+                        });
+                        _reader_stall_time += (fc::time_point::now() - start).count();
+                    }
+
+                    if (_stopped) {
+                        return;
+                    }
+
+                    auto& s = _slots[block_num % _slots.size()];
+                    s.value = std::move(value);
+                    s.ready = true;
+                    _slot_ready.notify_all();
+                }
+            } catch (...) {
+                std::unique_lock<std::mutex> lock(_mutex);
+                if (!_error) {
+                    _error = std::current_exception();
+                }
+                _stopped = true;
+                _slot_free.notify_all();
+                _slot_ready.notify_all();
+            }
+        }
+
+        bool replay_pipeline::pop(item& result) {
+            std::unique_lock<std::mutex> lock(_mutex);
+            if (_next_block_num > _last_block_num) {
+                return false;
+            }
+
+            auto& s = _slots[_next_block_num % _slots.size()];
+            if (!s.ready && !_stopped) {
+                auto start = fc::time_point::now();
+                _slot_ready.wait(lock, [&]() {
+                    return _stopped || s.ready;
+                });
+                _apply_stall_time += (fc::time_point::now() - start).count();
+            }
+
+            if (_error) {
+                std::rethrow_exception(_error);
+            }
+
+            if (!s.ready) {
+                return false;
+            }
+
+            result = std::move(s.value);
+            s.ready = false;
+            ++_next_block_num;
+            _slot_free.notify_all();
+            return true;
+        }
+
         class database_impl {
         public:
             database_impl(database &self);
@@ -203,13 +385,19 @@ namespace golos { namespace chain {
                     start = fc::time_point::now();
                     wlog("Start opening block log. Please wait, don't break application...");
 
+                    _block_log.open(data_dir / "block_log");
+
                     if (!find<dynamic_global_property_object>()) {
                         with_strong_write_lock([&]() {
-                            init_genesis(initial_supply);
+                            if (!_snapshot_file.empty()) {
+                                load_snapshot(_snapshot_file);
+                                set_revision(head_block_num());
+                            } else {
+                                init_genesis(initial_supply);
+                            }
                         });
                     }
-
-                    _block_log.open(data_dir / "block_log");
+                    _snapshot_file = fc::path();
 
                     // Rewind all undo state. This should return us to the state at the last irreversible block.
                     with_strong_write_lock([&]() {
@@ -273,44 +461,95 @@ namespace golos { namespace chain {
                         skip_block_log;
 
                 with_strong_write_lock([&]() {
-                    auto cur_block_num = from_block_num;
                     auto last_block_num = _block_log.head()->block_num();
+                    if (from_block_num > last_block_num) {
+                        ilog("No blocks to replay after block ${n}", ("n", from_block_num - 1));
+                        return;
+                    }
                     auto last_block_pos = _block_log.get_block_pos(last_block_num);
                     int last_reindex_percent = 0;
 
-                    set_reserved_memory(1024*1024*1024); // protect from memory fragmentations ...
-                    while (cur_block_num < last_block_num) {
-                        if (signal_guard::get_is_interrupted()) {
+                    std::unique_ptr<replay_pipeline> pipeline;
+                    if (_replay_threads > 0) {
+                        ilog("Replaying with ${n} reader threads and queue of ${q} blocks",
+                            ("n", _replay_threads)("q", _replay_queue_size));
+                        pipeline = std::make_unique<replay_pipeline>(
+                            _block_log, from_block_num, last_block_num, _replay_threads, _replay_queue_size);
+                    }
+
+                    auto print_progress = [&](uint32_t cur_block_num, uint64_t cur_block_pos) {
+                        auto reindex_percent = cur_block_pos * 100 / last_block_pos;
+                        if (reindex_percent - last_reindex_percent < 1) {
                             return;
                         }
 
                         auto end = fc::time_point::now();
-                        auto cur_block_pos = _block_log.get_block_pos(cur_block_num);
-                        auto cur_block = *_block_log.read_block_by_num(cur_block_num);
-
-                        auto reindex_percent = cur_block_pos * 100 / last_block_pos;
-                        if (reindex_percent - last_reindex_percent >= 1) {
+                        std::cerr
+                            << "   " << reindex_percent << "%   "
+                            << cur_block_num << " of " << last_block_num
+                            << "   ("  << (free_memory() / (1024 * 1024)) << "M free"
+                            << ", elapsed " << double((end - start).count()) / 1000000.0 << " sec";
+                        if (pipeline) {
                             std::cerr
-                                << "   " << reindex_percent << "%   "
-                                << cur_block_num << " of " << last_block_num
-                                << "   ("  << (free_memory() / (1024 * 1024)) << "M free"
-                                << ", elapsed " << double((end - start).count()) / 1000000.0 << " sec)\n";
-
-                            last_reindex_percent = reindex_percent;
+                                << ", readers stalled " << double(pipeline->reader_stall_time().count()) / 1000000.0 << " sec"
+                                << ", apply stalled " << double(pipeline->apply_stall_time().count()) / 1000000.0 << " sec";
                         }
+                        std::cerr << ")\n";
+
+                        last_reindex_percent = reindex_percent;
+                    };
+
+                    auto apply_replay_block = [&](const signed_block& cur_block) {
+                        auto cur_block_num = cur_block.block_num();
 
                         apply_block(cur_block, skip_flags);
 
-                        if (cur_block_num % 1000 == 0) {
+                        if (cur_block_num % 1000 == 0 || cur_block_num == last_block_num) {
                             set_revision(head_block_num());
                         }
 
                         check_free_memory(true, cur_block_num);
-                        cur_block_num++;
-                    }
+                    };
+
+                    set_reserved_memory(1024*1024*1024); // protect from memory fragmentations ...
+                    if (pipeline) {
+                        replay_pipeline::item item;
+                        while (pipeline->pop(item)) {
+                            if (item.block.block_num() != last_block_num && signal_guard::get_is_interrupted()) {
+                                return;
+                            }
+
+                            print_progress(item.block.block_num(), item.block_pos);
 
-                    auto cur_block = *_block_log.read_block_by_num(cur_block_num);
-                    apply_block(cur_block, skip_flags);
+                            _replay_trx_ids = &item.trx_ids;
+                            try {
+                                apply_replay_block(item.block);
+                            } catch (...) {
+                                _replay_trx_ids = nullptr;
+                                throw;
+                            }
+                            _replay_trx_ids = nullptr;
+                        }
+
+                        auto end = fc::time_point::now();
+                        ilog("Replay pipeline: readers stalled ${r} sec, apply stalled ${a} sec, elapsed ${t} sec",
+                            ("r", double(pipeline->reader_stall_time().count()) / 1000000.0)
+                            ("a", double(pipeline->apply_stall_time().count()) / 1000000.0)
+                            ("t", double((end - start).count()) / 1000000.0));
+                    } else {
+                        auto cur_block_num = from_block_num;
+                        while (cur_block_num < last_block_num) {
+                            if (signal_guard::get_is_interrupted()) {
+                                return;
+                            }
+
+                            print_progress(cur_block_num, _block_log.get_block_pos(cur_block_num));
+                            apply_replay_block(*_block_log.read_block_by_num(cur_block_num));
+                            cur_block_num++;
+                        }
+
+                        apply_replay_block(*_block_log.read_block_by_num(cur_block_num));
+                    }
                     set_reserved_memory(0);
                     set_revision(head_block_num());
                 });
@@ -344,6 +583,14 @@ namespace golos { namespace chain {
             _block_num_check_free_memory = value;
         }
 
+        void database::set_replay_threads(uint32_t value) {
+            _replay_threads = value;
+        }
+
+        void database::set_replay_queue_size(uint32_t value) {
+            _replay_queue_size = value;
+        }
+
 
         void database::set_store_account_metadata(store_metadata_modes store_account_metadata) {
             _store_account_metadata = store_account_metadata;
@@ -443,6 +690,7 @@ namespace golos { namespace chain {
             if (include_blocks) {
                 fc::remove_all(data_dir / "block_log");
                 fc::remove_all(data_dir / "block_log.index");
+                fc::remove_all(data_dir / "block_log.head");
             }
         }
 
@@ -459,6 +707,9 @@ namespace golos { namespace chain {
                 _block_log.close();
 
                 _fork_db.reset();
+
+                // indexes are registered again on the next open()
+                _snapshot_indexes.clear();
             }
             FC_CAPTURE_AND_RETHROW()
         }
@@ -936,6 +1187,7 @@ namespace golos { namespace chain {
             //fc::time_point begin_time = fc::time_point::now();
 
             bool result;
+            lock_stats::context_guard lock_context("push_block");
             with_strong_write_lock([&]() {
                 detail::without_pending_transactions(*this, skip, std::move(_pending_tx), [&]() {
                     try {
@@ -1073,6 +1325,7 @@ namespace golos { namespace chain {
                 GOLOS_ASSERT(fc::raw::pack_size(trx) <= (get_dynamic_global_properties().maximum_block_size - 256),
                         golos::protocol::tx_too_long, "Transaction data is too long. Maximum transaction size ${max} bytes",
                         ("max",get_dynamic_global_properties().maximum_block_size - 256));
+                lock_stats::context_guard lock_context("push_transaction");
                 with_weak_write_lock([&]() {
                     detail::with_producing(*this, [&]() {
                         _push_transaction(trx, skip);
@@ -1098,6 +1351,17 @@ namespace golos { namespace chain {
             _apply_transaction(trx, skip);
             _pending_tx.push_back(trx);
 
+            // the candidate stays a prefix of pending transactions, so each its transaction
+            //   was applied on top of the previous ones
+            if (_enable_candidate_block && _candidate_tx_count + 1 == _pending_tx.size()) {
+                auto size = fc::raw::pack_size(trx);
+                auto maximum_block_size = get_dynamic_global_properties().maximum_block_size;
+                if (max_block_header_size() + _candidate_block_size + size < maximum_block_size) {
+                    _candidate_block_size += size;
+                    ++_candidate_tx_count;
+                }
+            }
+
             notify_changed_objects();
             // The transaction applied successfully. Merge its changes into the pending block session.
             temp_session.squash();
@@ -1106,6 +1370,65 @@ namespace golos { namespace chain {
             notify_on_pending_transaction(trx);
         }
 
+        void database::_restore_pending_transactions(std::vector<signed_transaction>&& pending, uint32_t skip) {
+            auto start = fc::time_point::now();
+            auto& stats = _pending_tx_stats;
+
+            // the same conditions as in _validate_transaction(), checked before starting of undo session
+            auto now = head_block_time();
+            bool strict_expiration = has_hardfork(STEEMIT_HARDFORK_0_9);
+            auto is_expired = [&](const signed_transaction& tx) {
+                if (skip & skip_tapos_check) {
+                    return false;
+                }
+                return tx.expiration < now || (strict_expiration && tx.expiration == now);
+            };
+
+            auto restore = [&](const signed_transaction& tx, uint32_t tx_skip) -> bool {
+                if (is_known_transaction(tx.id())) {
+                    ++stats.dropped_included;
+                    return false;
+                }
+                if (is_expired(tx)) {
+                    ++stats.dropped_expired;
+                    return false;
+                }
+                try {
+                    // since push_transaction() takes a signed_transaction,
+                    // the operation_results field will be ignored.
+                    _push_transaction(tx, tx_skip);
+                    return true;
+                } catch (const fc::exception&) {
+                    ++stats.failed;
+                }
+                return false;
+            };
+
+            // validate() of operations doesn't depend on the state, it passed when the transaction was pushed
+            //   or when its popped block was applied. Authorities, TaPoS and evaluators are always checked,
+            //   signature keys are cached in the transaction.
+            auto tx_skip = skip | skip_validate_operations;
+
+            for (const auto& tx : _popped_tx) {
+                if (restore(tx, tx_skip)) {
+                    ++stats.reapplied;
+                }
+            }
+            _popped_tx.clear();
+
+            for (const auto& tx : pending) {
+                if (restore(tx, tx_skip)) {
+                    ++stats.reapplied;
+                }
+            }
+
+            auto elapsed = uint64_t((fc::time_point::now() - start).count());
+            ++stats.rebuilds;
+            stats.pending = _pending_tx.size();
+            stats.total_us += elapsed;
+            stats.max_us = std::max(stats.max_us, elapsed);
+        }
+
         signed_block database::generate_block(
                 fc::time_point_sec when,
                 const account_name_type &witness_owner,
@@ -1138,14 +1461,30 @@ namespace golos { namespace chain {
                 FC_ASSERT(witness_obj.signing_key ==
                           block_signing_private_key.get_public_key());
 
-            static const size_t max_block_header_size =
-                    fc::raw::pack_size(signed_block_header()) + 4;
             auto maximum_block_size = get_dynamic_global_properties().maximum_block_size; //STEEMIT_MAX_BLOCK_SIZE;
-            size_t total_block_size = max_block_header_size;
+            size_t total_block_size = max_block_header_size();
 
             signed_block pending_block;
 
+            lock_stats::context_guard lock_context("generate_block");
             with_strong_write_lock([&]() { detail::with_generating(*this, [&]() {
+                //
+                // The pending state is the result of applying of the candidate transactions
+                // (and maybe other ones after them), transactions of block are applied before
+                // the block time is set, so the candidate can be taken as is.
+                //
+                auto candidate_end = _pending_tx.begin() + std::min<size_t>(_candidate_tx_count, _pending_tx.size());
+                if (_enable_candidate_block &&
+                    (_pending_tx.empty() || _pending_tx_session.valid()) &&
+                    std::none_of(_pending_tx.begin(), candidate_end, [&](const signed_transaction& tx) {
+                        return tx.expiration < when;
+                    })
+                ) {
+                    pending_block.transactions.assign(_pending_tx.begin(), candidate_end);
+                    _pending_tx_session.reset();
+                    return;
+                }
+
                 //
                 // The following code throws away existing pending_tx_session and
                 // rebuilds it by re-applying pending transactions.
@@ -1160,6 +1499,9 @@ namespace golos { namespace chain {
                 _pending_tx_session.reset();
                 _pending_tx_session = start_undo_session();
 
+                auto start = fc::time_point::now();
+                auto& stats = _pending_tx_stats;
+
                 uint64_t postponed_tx_count = 0;
                 // pop pending state (reset to head block state)
                 for (const signed_transaction &tx : _pending_tx) {
@@ -1167,6 +1509,7 @@ namespace golos { namespace chain {
                     // this should clear problem transactions and allow block production to continue
 
                     if (tx.expiration < when) {
+                        ++stats.dropped_expired;
                         continue;
                     }
 
@@ -1186,8 +1529,10 @@ namespace golos { namespace chain {
 
                         total_block_size += fc::raw::pack_size(tx);
                         pending_block.transactions.push_back(tx);
+                        ++stats.reapplied;
                     }
                     catch (const fc::exception &e) {
+                        ++stats.failed;
                         // Do nothing, transaction will not be re-applied
                         //wlog( "Transaction was not processed while generating block due to ${e}", ("e", e) );
                         //wlog( "The transaction was ${t}", ("t", tx) );
@@ -1197,6 +1542,11 @@ namespace golos { namespace chain {
                     wlog("Postponed ${n} transactions due to block size limit", ("n", postponed_tx_count));
                 }
 
+                auto elapsed = uint64_t((fc::time_point::now() - start).count());
+                ++stats.rebuilds;
+                stats.total_us += elapsed;
+                stats.max_us = std::max(stats.max_us, elapsed);
+
                 _pending_tx_session.reset();
             }); });
 
@@ -1262,6 +1612,8 @@ namespace golos { namespace chain {
         void database::pop_block() {
             try {
                 _pending_tx_session.reset();
+                _candidate_tx_count = 0;
+                _candidate_block_size = 0;
                 auto head_id = head_block_id();
 
                 /// save the head block so we can recover its transactions
@@ -1283,6 +1635,8 @@ namespace golos { namespace chain {
                        _pending_tx_session.valid());
                 _pending_tx.clear();
                 _pending_tx_session.reset();
+                _candidate_tx_count = 0;
+                _candidate_block_size = 0;
             }
             FC_CAPTURE_AND_RETHROW()
         }
@@ -1291,6 +1645,10 @@ namespace golos { namespace chain {
             _enable_plugins_on_push_transaction = value;
         }
 
+        void database::enable_candidate_block(bool value) {
+            _enable_candidate_block = value;
+        }
+
         void database::notify_pre_apply_operation(operation_notification &note) {
             note.trx_id = _current_trx_id;
             note.block = _current_block_num;
@@ -3221,6 +3579,16 @@ namespace golos { namespace chain {
                 // this method can be used only for push_transaction(),
                 //  because such transactions only added to pending list,
                 //  and they will be rechecked on block generation
+                // keys are cached in the transaction and in its copy in the pending list,
+                //   so re-applying of pending transactions after each block skips the ECC recovery
+                if (!(skip & (skip_transaction_signatures | skip_authority_check))) {
+                    try {
+                        trx.precompute_signature_keys(STEEMIT_CHAIN_ID);
+                    } catch (...) {
+                        // the error will be thrown again on validation
+                    }
+                }
+
                 auto validate_action = [&]() {
                     _validate_transaction(trx, skip);
                 };
@@ -3634,11 +4002,16 @@ namespace golos { namespace chain {
 
         void database::_apply_transaction(const signed_transaction &trx, uint32_t skip) {
             try {
-                _current_trx_id = trx.id();
+                // transaction ids can be precomputed by reader threads on replay
+                if (_replay_trx_ids != nullptr && _current_trx_in_block < _replay_trx_ids->size()) {
+                    _current_trx_id = (*_replay_trx_ids)[_current_trx_in_block];
+                } else {
+                    _current_trx_id = trx.id();
+                }
                 _current_virtual_op = 0;
 
                 auto &trx_idx = get_index<transaction_index>();
-                auto trx_id = trx.id();
+                auto trx_id = _current_trx_id;
                 // idump((trx_id)(skip&skip_transaction_dupe_check));
                 if (!(skip & skip_transaction_dupe_check) &&
                           trx_idx.indices().get<by_trx_id>().find(trx_id) != trx_idx.indices().get<by_trx_id>().end()) {
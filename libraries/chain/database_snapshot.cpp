@@ -0,0 +1,293 @@
+#include <golos/chain/database.hpp>
+#include <golos/chain/state_snapshot.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <atomic>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+namespace golos { namespace chain {
+
+    namespace {
+        constexpr char snapshot_magic[8] = {'G', 'L', 'S', 'S', 'N', 'A', 'P', 'S'};
+        constexpr uint32_t snapshot_version = 1;
+        constexpr std::size_t snapshot_buffer_size = 1024 * 1024;
+
+        // Runs action(i) for i in [0, count) in several threads, rethrows the first exception
+        template<typename Action>
+        void run_parallel(uint32_t threads, std::size_t count, Action&& action) {
+            std::atomic<std::size_t> next{0};
+            std::exception_ptr error;
+            std::mutex error_mutex;
+
+            auto worker = [&]() {
+                for (auto i = next++; i < count; i = next++) {
+                    try {
+                        action(i);
+                    } catch (...) {
+                        std::lock_guard<std::mutex> lock(error_mutex);
+                        if (!error) {
+                            error = std::current_exception();
+                        }
+                        next = count;
+                    }
+                }
+            };
+
+            std::vector<std::thread> workers;
+            threads = std::max<uint32_t>(1, std::min<std::size_t>(threads, count));
+            for (uint32_t i = 1; i < threads; ++i) {
+                workers.emplace_back(worker);
+            }
+            worker();
+
+            for (auto& w: workers) {
+                w.join();
+            }
+            if (error) {
+                std::rethrow_exception(error);
+            }
+        }
+    }
+
+    snapshot_ostream::snapshot_ostream(const fc::path& file)
+        : _stream(file.string(), std::ios::out|std::ios::binary|std::ios::trunc) {
+        FC_ASSERT(_stream.good(), "Can't create snapshot file ${file}", ("file", file.string()));
+        _buffer.reserve(snapshot_buffer_size);
+    }
+
+    snapshot_ostream::~snapshot_ostream() {
+        try {
+            flush();
+        } catch (...) {
+        }
+    }
+
+    void snapshot_ostream::write(const char* data, std::size_t size) {
+        if (_buffer.size() + size > snapshot_buffer_size) {
+            flush();
+        }
+        if (size > snapshot_buffer_size) {
+            _stream.write(data, size);
+            _encoder.write(data, size);
+        } else {
+            _buffer.insert(_buffer.end(), data, data + size);
+        }
+        _size += size;
+    }
+
+    void snapshot_ostream::flush() {
+        if (!_buffer.empty()) {
+            _stream.write(_buffer.data(), _buffer.size());
+            _encoder.write(_buffer.data(), _buffer.size());
+            _buffer.clear();
+        }
+        _stream.flush();
+        FC_ASSERT(_stream.good(), "Can't write snapshot file");
+    }
+
+    fc::sha256 snapshot_ostream::checksum() {
+        flush();
+        return _encoder.result();
+    }
+
+    snapshot_istream::snapshot_istream(const fc::path& file, uint64_t offset, uint64_t size)
+        : _stream(file.string(), std::ios::in|std::ios::binary),
+          _remaining(size) {
+        FC_ASSERT(_stream.good(), "Can't open snapshot file ${file}", ("file", file.string()));
+        _stream.seekg(offset);
+    }
+
+    void snapshot_istream::fill() {
+        FC_ASSERT(_remaining > 0, "Reading data beyond end of snapshot section");
+
+        _buffer.resize(std::min<uint64_t>(_remaining, snapshot_buffer_size));
+        _stream.read(_buffer.data(), _buffer.size());
+        FC_ASSERT(_stream.good(), "Can't read snapshot file");
+        _encoder.write(_buffer.data(), _buffer.size());
+        _remaining -= _buffer.size();
+        _pos = 0;
+    }
+
+    void snapshot_istream::read(char* data, std::size_t size) {
+        while (size > 0) {
+            if (_pos == _buffer.size()) {
+                fill();
+            }
+            auto part = std::min(size, _buffer.size() - _pos);
+            std::memcpy(data, _buffer.data() + _pos, part);
+            _pos += part;
+            data += part;
+            size -= part;
+        }
+    }
+
+    fc::sha256 snapshot_istream::checksum() {
+        return _encoder.result();
+    }
+
+    void database::set_snapshot_file(const fc::path& file) {
+        _snapshot_file = file;
+    }
+
+    void database::set_snapshot_threads(uint32_t value) {
+        _snapshot_threads = value;
+    }
+
+    void database::add_snapshot_index(snapshot_index index) {
+        _snapshot_indexes.push_back(std::move(index));
+    }
+
+    void database::write_snapshot(const fc::path& file) { try {
+        auto start = fc::time_point::now();
+        ilog("Writing state snapshot at block ${n} to ${file}...", ("n", head_block_num())("file", file.string()));
+
+        snapshot_header header;
+        header.version = snapshot_version;
+        header.chain_id = get_chain_id();
+        header.head_block_num = head_block_num();
+        header.head_block_id = head_block_id();
+        header.head_block_time = head_block_time();
+        header.sections.resize(_snapshot_indexes.size());
+
+        auto part_path = [&](std::size_t i) {
+            return fc::path(file.string() + "." + std::to_string(i) + ".part");
+        };
+
+        run_parallel(_snapshot_threads, _snapshot_indexes.size(), [&](std::size_t i) {
+            const auto& index = _snapshot_indexes[i];
+            auto& section = header.sections[i];
+
+            snapshot_ostream stream(part_path(i));
+            section.name = index.name;
+            section.count = index.write(*this, stream, section.next_id);
+            section.checksum = stream.checksum();
+            section.size = stream.size();
+        });
+
+        uint64_t offset = 0;
+        for (auto& section: header.sections) {
+            section.offset = offset;
+            offset += section.size;
+        }
+
+        auto tmp_path = fc::path(file.string() + ".tmp");
+        {
+            auto data = fc::raw::pack(header);
+            uint64_t header_size = data.size();
+            auto checksum = fc::sha256::hash(data.data(), data.size());
+
+            std::ofstream stream(tmp_path.string(), std::ios::out|std::ios::binary|std::ios::trunc);
+            stream.write(snapshot_magic, sizeof(snapshot_magic));
+            stream.write(reinterpret_cast<const char*>(&header_size), sizeof(header_size));
+            stream.write(data.data(), data.size());
+            stream.write(checksum.data(), checksum.data_size());
+
+            for (std::size_t i = 0; i < header.sections.size(); ++i) {
+                std::ifstream part(part_path(i).string(), std::ios::in|std::ios::binary);
+                if (header.sections[i].size) {
+                    stream << part.rdbuf();
+                }
+                part.close();
+                boost::filesystem::remove(part_path(i).string());
+            }
+            FC_ASSERT(stream.good(), "Can't write snapshot file ${file}", ("file", tmp_path.string()));
+        }
+        boost::filesystem::rename(tmp_path.string(), file.string());
+
+        auto end = fc::time_point::now();
+        ilog("Done writing state snapshot: ${n} indexes, ${s} bytes, elapsed time ${t} sec",
+            ("n", header.sections.size())("s", offset)("t", double((end - start).count()) / 1000000.0));
+    } FC_CAPTURE_AND_RETHROW((file)) }
+
+    void database::load_snapshot(const fc::path& file) { try {
+        auto start = fc::time_point::now();
+        ilog("Loading state snapshot from ${file}...", ("file", file.string()));
+
+        snapshot_header header;
+        uint64_t data_offset = 0;
+        {
+            std::ifstream stream(file.string(), std::ios::in|std::ios::binary);
+            FC_ASSERT(stream.good(), "Can't open snapshot file ${file}", ("file", file.string()));
+
+            char magic[sizeof(snapshot_magic)];
+            uint64_t header_size = 0;
+            stream.read(magic, sizeof(magic));
+            stream.read(reinterpret_cast<char*>(&header_size), sizeof(header_size));
+            FC_ASSERT(stream.good() && std::memcmp(magic, snapshot_magic, sizeof(magic)) == 0,
+                "File ${file} isn't a state snapshot", ("file", file.string()));
+
+            std::vector<char> data(header_size);
+            fc::sha256 checksum;
+            stream.read(data.data(), data.size());
+            stream.read(checksum.data(), checksum.data_size());
+            FC_ASSERT(stream.good() && fc::sha256::hash(data.data(), data.size()) == checksum,
+                "Header of snapshot ${file} is corrupted", ("file", file.string()));
+
+            header = fc::raw::unpack<snapshot_header>(data);
+            data_offset = stream.tellg();
+        }
+
+        FC_ASSERT(header.version == snapshot_version,
+            "Unsupported version of snapshot ${v}, expected ${e}", ("v", header.version)("e", snapshot_version));
+        FC_ASSERT(header.chain_id == get_chain_id(),
+            "Snapshot is for other chain ${c}", ("c", header.chain_id));
+
+        ilog("Snapshot is at block ${n} (${id}), ${s} indexes",
+            ("n", header.head_block_num)("id", header.head_block_id)("s", header.sections.size()));
+
+        // blocks after the snapshot are replayed from block log, so it should contain the head of snapshot
+        if (header.head_block_num) {
+            auto log_head = _block_log.head();
+            FC_ASSERT(log_head && log_head->block_num() >= header.head_block_num,
+                "Snapshot is at block ${n}, which is beyond the head of block log ${h}",
+                ("n", header.head_block_num)("h", log_head ? log_head->block_num() : 0));
+            auto block = _block_log.read_block_by_num(header.head_block_num);
+            FC_ASSERT(block.valid() && block->id() == header.head_block_id,
+                "Block ${n} of snapshot doesn't match block log", ("n", header.head_block_num));
+        }
+
+        std::map<std::string, const snapshot_index*> indexes;
+        for (const auto& index: _snapshot_indexes) {
+            indexes[index.name] = &index;
+        }
+
+        std::vector<std::pair<const snapshot_section*, const snapshot_index*>> sections;
+        for (const auto& section: header.sections) {
+            auto itr = indexes.find(section.name);
+            if (itr == indexes.end()) {
+                wlog("Skip index ${name} from snapshot, it isn't used by this node", ("name", section.name));
+                continue;
+            }
+            sections.emplace_back(&section, itr->second);
+            indexes.erase(itr);
+        }
+        for (const auto& index: indexes) {
+            wlog("Index ${name} is absent in snapshot, it will be empty", ("name", index.first));
+        }
+
+        run_parallel(_snapshot_threads, sections.size(), [&](std::size_t i) {
+            const auto& section = *sections[i].first;
+            const auto& index = *sections[i].second;
+
+            snapshot_istream stream(file, data_offset + section.offset, section.size);
+            index.read(*this, stream, section.count, section.next_id);
+
+            FC_ASSERT(stream.remaining() == 0,
+                "Snapshot section ${name} has ${n} bytes of unknown data",
+                ("name", section.name)("n", stream.remaining()));
+            FC_ASSERT(stream.checksum() == section.checksum,
+                "Snapshot section ${name} is corrupted", ("name", section.name));
+        });
+
+        FC_ASSERT(head_block_num() == header.head_block_num && head_block_id() == header.head_block_id,
+            "Loaded state doesn't match header of snapshot");
+
+        auto end = fc::time_point::now();
+        ilog("Done loading state snapshot, elapsed time ${t} sec", ("t", double((end - start).count()) / 1000000.0));
+    } FC_CAPTURE_AND_RETHROW((file)) }
+
+} } // golos::chain
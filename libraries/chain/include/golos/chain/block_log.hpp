@@ -10,6 +10,8 @@ namespace golos {
 
         namespace detail { class block_log_impl; }
 
+        class compressed_block_log;
+
         /* The block log is an external append only log of the blocks. Blocks should only be written
          * to the log after they irreverisble as the log is append only. The log is a doubly linked
          * list of blocks. There is a secondary index file of only block positions that enables O(1)
@@ -33,6 +35,9 @@ namespace golos {
          *
          * The main file is the only file that needs to persist. The index file can be reconstructed during a
          * linear scan of the main file.
+         *
+         * If the file is a compressed block log (see compressed_block_log), all calls are passed to it.
+         * Positions of blocks are logical in this case.
          */
 
         class block_log {
@@ -55,6 +60,14 @@ namespace golos {
 
             optional <signed_block> read_block_by_num(uint32_t block_num) const;
 
+            /**
+             * Append packed blocks starting from first_block_num to result, while its size doesn't exceed
+             * max_size (at least one block is appended). Blocks are copied from the file without unpacking.
+             * @return the number of appended blocks
+             */
+            uint32_t read_packed_blocks(
+                uint32_t first_block_num, uint32_t count, std::size_t max_size, std::vector<char>& result) const;
+
             /**
              * Return offset of block in file, or block_log::npos if it does not exist.
              */
@@ -64,10 +77,16 @@ namespace golos {
 
             const optional <signed_block>& head() const;
 
+            /**
+             * Return true if the opened file is a compressed block log
+             */
+            bool is_compressed() const;
+
             static const uint64_t npos = std::numeric_limits<uint64_t>::max();
 
         private:
             std::unique_ptr<detail::block_log_impl> my;
+            std::unique_ptr<compressed_block_log> compressed;
         };
 
     }
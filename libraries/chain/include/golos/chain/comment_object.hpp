@@ -86,6 +86,7 @@ namespace golos {
             uint16_t reward_weight = 0;
 
             int32_t net_votes = 0;
+            uint32_t vote_count = 0; ///< number of stored comment_vote_objects, isn't used in consensus
 
             id_type root_comment;
 
@@ -128,6 +129,8 @@ namespace golos {
         struct by_voter_comment;
         struct by_comment_weight_voter;
         struct by_vote_last_update;
+        struct by_comment_rshares_voter;
+        struct by_comment_last_update_voter;
         using comment_vote_index = multi_index_container<
             comment_vote_object,
             indexed_by<
@@ -158,6 +161,22 @@ namespace golos {
                         member<comment_vote_object, account_id_type, &comment_vote_object::voter>
                     >,
                     composite_key_compare<std::less<comment_id_type>, std::greater<uint64_t>, std::less<account_id_type>>
+                >,
+                ordered_unique<tag<by_comment_rshares_voter>,
+                    composite_key<comment_vote_object,
+                        member<comment_vote_object, comment_id_type, &comment_vote_object::comment>,
+                        member<comment_vote_object, int64_t, &comment_vote_object::rshares>,
+                        member<comment_vote_object, account_id_type, &comment_vote_object::voter>
+                    >,
+                    composite_key_compare<std::less<comment_id_type>, std::greater<int64_t>, std::less<account_id_type>>
+                >,
+                ordered_unique<tag<by_comment_last_update_voter>,
+                    composite_key<comment_vote_object,
+                        member<comment_vote_object, comment_id_type, &comment_vote_object::comment>,
+                        member<comment_vote_object, time_point_sec, &comment_vote_object::last_update>,
+                        member<comment_vote_object, account_id_type, &comment_vote_object::voter>
+                    >,
+                    composite_key_compare<std::less<comment_id_type>, std::greater<time_point_sec>, std::less<account_id_type>>
                 >
             >,
             allocator<comment_vote_object>
@@ -211,6 +230,16 @@ namespace golos {
 
 FC_REFLECT_ENUM(golos::chain::comment_mode, (not_set)(first_payout)(second_payout)(archived))
 
+FC_REFLECT((golos::chain::comment_object),
+    (id)(parent_author)(parent_permlink)(author)(permlink)(created)(last_payout)(depth)(children)
+    (children_rshares2)(net_rshares)(abs_rshares)(vote_rshares)(children_abs_rshares)(cashout_time)
+    (max_cashout_time)(total_vote_weight)(reward_weight)(net_votes)(vote_count)(root_comment)(mode)
+    (max_accepted_payout)(percent_steem_dollars)(allow_replies)(allow_votes)(allow_curation_rewards)
+    (beneficiaries))
+
+FC_REFLECT((golos::chain::comment_vote_object),
+    (id)(voter)(comment)(weight)(rshares)(vote_percent)(last_update)(num_changes))
+
 CHAINBASE_SET_INDEX_TYPE(golos::chain::comment_object, golos::chain::comment_index)
 
 CHAINBASE_SET_INDEX_TYPE(golos::chain::comment_vote_object, golos::chain::comment_vote_index)
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <fc/filesystem.hpp>
+#include <golos/protocol/block.hpp>
+
+namespace golos {
+    namespace chain {
+
+        using namespace golos::protocol;
+
+        namespace detail { class compressed_block_log_impl; }
+
+        /* The compressed block log (block log v2) stores blocks in frames of a fixed number of blocks,
+         * each frame is compressed with zlib as a whole. Only full frames are compressed, the blocks of
+         * the current (head) frame are kept uncompressed in a separate file and are moved to the main file
+         * when the frame is full.
+         *
+         * Main file:
+         * +--------+---------+---------+-----+---------+
+         * | Header | Frame 0 | Frame 1 | ... | Frame N |
+         * +--------+---------+---------+-----+---------+
+         *
+         * Frame:
+         * +-----------------+----------+-----------------+-------------+------------------+
+         * | Compressed size | Raw size | First block num | Block count | Compressed data  |
+         * +-----------------+----------+-----------------+-------------+------------------+
+         *
+         * The decompressed data of a frame starts with offsets of blocks in it, so a block is found without
+         * unpacking the previous ones.
+         *
+         * Frame K contains blocks [K * frame_size + 1, (K + 1) * frame_size], so the index file holds only
+         * positions of frames and random access by block number is O(1). The index file can be reconstructed
+         * by walking frame headers of the main file.
+         *
+         * Positions of blocks (get_block_pos(), read_block()) are logical: the position of block N is N - 1.
+         */
+
+        class compressed_block_log {
+        public:
+            compressed_block_log();
+
+            ~compressed_block_log();
+
+            /**
+             * Opens log or creates a new one. frame_size is used only for new logs,
+             * the existing log keeps the size of frame from its header.
+             */
+            void open(const fc::path& file, uint32_t frame_size = default_frame_size);
+
+            void close();
+
+            bool is_open() const;
+
+            uint64_t append(const signed_block& b);
+
+            void flush();
+
+            std::pair<signed_block, uint64_t> read_block(uint64_t pos) const;
+
+            optional<signed_block> read_block_by_num(uint32_t block_num) const;
+
+            uint64_t get_block_pos(uint32_t block_num) const;
+
+            signed_block read_head() const;
+
+            const optional<signed_block>& head() const;
+
+            uint32_t frame_size() const;
+
+            /**
+             * Checks whether the file is a compressed block log
+             */
+            static bool is_compressed(const fc::path& file);
+
+            static constexpr uint32_t default_frame_size = 1000;
+
+            static const uint64_t npos = std::numeric_limits<uint64_t>::max();
+
+        private:
+            std::unique_ptr<detail::compressed_block_log_impl> my;
+        };
+
+    }
+}
@@ -4,6 +4,8 @@
 #include <golos/chain/node_property_object.hpp>
 #include <golos/chain/fork_database.hpp>
 #include <golos/chain/block_log.hpp>
+#include <golos/chain/state_snapshot.hpp>
+#include <golos/chain/lock_stats.hpp>
 #include <golos/chain/hardfork.hpp>
 #include <golos/protocol/protocol.hpp>
 
@@ -28,6 +30,26 @@ namespace golos { namespace chain {
 
         struct operation_notification;
 
+        namespace detail {
+            struct pending_transactions_restorer;
+        }
+
+        /**
+         * Statistics of re-applying of pending transactions after pushing and generating of blocks
+         */
+        struct pending_transactions_stats final {
+            uint32_t pending = 0;           ///< transactions in the pending state now
+            uint64_t rebuilds = 0;          ///< number of rebuilds of the pending state
+
+            uint64_t reapplied = 0;         ///< transactions applied again to the new pending state
+            uint64_t failed = 0;            ///< transactions which became invalid
+            uint64_t dropped_expired = 0;   ///< expired transactions dropped without applying
+            uint64_t dropped_included = 0;  ///< transactions included in new blocks
+
+            uint64_t total_us = 0;
+            uint64_t max_us = 0;
+        };
+
         /**
          *   @class database
          *   @brief tracks the blockchain state in an extensible manner
@@ -109,6 +131,79 @@ namespace golos { namespace chain {
             void set_min_free_shared_memory_size(size_t);
             void set_inc_shared_memory_size(size_t);
             void set_block_num_check_free_size(uint32_t);
+
+            /**
+             * Number of threads which read and unpack blocks ahead of the applying thread on replay.
+             * 0 - blocks are read in the applying thread.
+             */
+            void set_replay_threads(uint32_t);
+
+            /// Maximum number of blocks read ahead of the applying thread on replay
+            void set_replay_queue_size(uint32_t);
+
+            /**
+             * State snapshot to load on open instead of genesis, if the database is empty.
+             * It is loaded only once, blocks after the snapshot are replayed by reindex().
+             */
+            void set_snapshot_file(const fc::path& file);
+
+            /// Number of threads which write and read indexes of state snapshot
+            void set_snapshot_threads(uint32_t);
+
+            /**
+             * Writes all indexes (including plugin ones) to state snapshot file
+             */
+            void write_snapshot(const fc::path& file);
+
+            void add_snapshot_index(snapshot_index index);
+
+            /// Wait and hold times of chainbase locks by contexts, collected if enabled
+            lock_stats& get_lock_stats() const {
+                return _lock_stats;
+            }
+
+            const pending_transactions_stats& get_pending_transactions_stats() const {
+                return _pending_tx_stats;
+            }
+
+            // Locks of chainbase are wrapped to collect lock_stats
+
+            template<typename Lambda>
+            auto with_weak_read_lock(Lambda&& callback) const -> decltype(callback()) {
+                lock_stats::measure m(_lock_stats, lock_type::weak_read, read_wait_micro());
+                return chainbase::database::with_weak_read_lock([&]() -> decltype(callback()) {
+                    m.acquired();
+                    return callback();
+                });
+            }
+
+            template<typename Lambda>
+            auto with_strong_read_lock(Lambda&& callback) const -> decltype(callback()) {
+                lock_stats::measure m(_lock_stats, lock_type::strong_read, read_wait_micro());
+                return chainbase::database::with_strong_read_lock([&]() -> decltype(callback()) {
+                    m.acquired();
+                    return callback();
+                });
+            }
+
+            template<typename Lambda>
+            auto with_weak_write_lock(Lambda&& callback) -> decltype(callback()) {
+                lock_stats::measure m(_lock_stats, lock_type::weak_write, write_wait_micro());
+                return chainbase::database::with_weak_write_lock([&]() -> decltype(callback()) {
+                    m.acquired();
+                    return callback();
+                });
+            }
+
+            template<typename Lambda>
+            auto with_strong_write_lock(Lambda&& callback) -> decltype(callback()) {
+                lock_stats::measure m(_lock_stats, lock_type::strong_write, write_wait_micro());
+                return chainbase::database::with_strong_write_lock([&]() -> decltype(callback()) {
+                    m.acquired();
+                    return callback();
+                });
+            }
+
             void check_free_memory(bool skip_print, uint32_t current_block_num);
 
             void set_skip_virtual_ops();
@@ -249,6 +344,14 @@ namespace golos { namespace chain {
 
             void enable_plugins_on_push_transaction(bool);
 
+            /**
+             * Keeps the candidate block: the longest prefix of pending transactions which fits into
+             * maximum_block_size, its size is counted as transactions are pushed. generate_block() takes
+             * the candidate without re-applying of pending transactions, if none of them expires before
+             * the block time; the block is still validated by push_block() before it is returned.
+             */
+            void enable_candidate_block(bool);
+
             void push_transaction(const signed_transaction &trx, uint32_t skip = skip_nothing);
 
             void _maybe_warn_multiple_production(uint32_t height) const;
@@ -257,6 +360,14 @@ namespace golos { namespace chain {
 
             void _push_transaction(const signed_transaction &trx, uint32_t skip);
 
+            /**
+             * Re-applies popped and pending transactions after pushing of blocks.
+             *
+             * Expired transactions and transactions included in the blocks are dropped without applying.
+             * Other transactions skip the stateless validate() of operations, which they already passed.
+             */
+            void _restore_pending_transactions(std::vector<signed_transaction>&& pending, uint32_t skip);
+
             void push_proposal(const proposal_object&);
 
             void remove(const proposal_object&);
@@ -605,6 +716,8 @@ namespace golos { namespace chain {
 
             bool _resize(uint32_t block_num);
 
+            void load_snapshot(const fc::path& file);
+
             ///@}
 
             std::unique_ptr<database_impl> _my;
@@ -622,6 +735,8 @@ namespace golos { namespace chain {
 
             friend struct database_fixture;
 
+            friend struct detail::pending_transactions_restorer;
+
             fc::signal<void()> _plugin_index_signal;
 
             transaction_id_type _current_trx_id;
@@ -642,10 +757,26 @@ namespace golos { namespace chain {
 
             uint32_t _block_num_check_free_memory = 1000;
 
+            uint32_t _replay_threads = 0;
+            uint32_t _replay_queue_size = 1000;
+            const std::vector<transaction_id_type>* _replay_trx_ids = nullptr;
+
+            fc::path _snapshot_file;
+            uint32_t _snapshot_threads = 4;
+            std::vector<snapshot_index> _snapshot_indexes;
+
+            mutable lock_stats _lock_stats;
+
+            pending_transactions_stats _pending_tx_stats;
+
             uint32_t _clear_votes_block = 0;
             bool _skip_virtual_ops = false;
             bool _enable_plugins_on_push_transaction = true;
 
+            bool _enable_candidate_block = false;
+            uint32_t _candidate_tx_count = 0;    ///< the first transactions of _pending_tx are in the candidate block
+            uint64_t _candidate_block_size = 0;
+
             store_metadata_modes _store_account_metadata = store_metadata_for_all;
             std::vector<std::string> _accounts_to_store_metadata;
 
@@ -656,3 +787,6 @@ namespace golos { namespace chain {
         };
 
 } } // golos::chain
+
+FC_REFLECT((golos::chain::pending_transactions_stats),
+    (pending)(rebuilds)(reapplied)(failed)(dropped_expired)(dropped_included)(total_us)(max_us))
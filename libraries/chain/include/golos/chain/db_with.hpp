@@ -35,31 +35,7 @@ namespace golos {
                 }
 
                 ~pending_transactions_restorer() {
-                    for (const auto &tx : _db._popped_tx) {
-                        try {
-                            if (!_db.is_known_transaction(tx.id())) {
-                                // since push_transaction() takes a signed_transaction,
-                                // the operation_results field will be ignored.
-                                _db._push_transaction(tx, _skip);
-                            }
-                        } catch (const fc::exception &) {
-                        }
-                    }
-                    _db._popped_tx.clear();
-                    for (const signed_transaction &tx : _pending_transactions) {
-                        try {
-                            if (!_db.is_known_transaction(tx.id())) {
-                                // since push_transaction() takes a signed_transaction,
-                                // the operation_results field will be ignored.
-                                _db._push_transaction(tx, _skip);
-                            }
-                        } catch (const fc::exception &e) {
-
-                            //wlog( "Pending transaction became invalid after switching to block ${b}  ${t}", ("b", _db.head_block_id())("t",_db.head_block_time()) );
-                            //wlog( "The invalid pending transaction caused exception ${e}", ("e", e.to_detail_string() ) );
-
-                        }
-                    }
+                    _db._restore_pending_transactions(std::move(_pending_transactions), _skip);
                 }
 
                 database &_db;
@@ -1,13 +1,53 @@
 #pragma once
 
 #include <golos/chain/database.hpp>
+#include <golos/chain/state_snapshot.hpp>
 
 namespace golos {
     namespace chain {
 
+        template<typename MultiIndexType>
+        snapshot_index make_snapshot_index() {
+            using object_type = typename MultiIndexType::value_type;
+
+            snapshot_index result;
+            result.name = fc::get_typename<object_type>::name();
+
+            result.write = [](const database& db, snapshot_ostream& s, int64_t& next_id) -> uint64_t {
+                const auto& idx = db.get_index<MultiIndexType>();
+                uint64_t count = 0;
+                // the next id of index, it's greater than ids of existing objects if the newest ones were removed
+                next_id = idx.next_id();
+                for (const auto& o: idx.indices()) {
+                    fc::raw::pack(s, o.id);
+                    snapshot::write(s, o);
+                    ++count;
+                }
+                return count;
+            };
+
+            result.read = [](database& db, snapshot_istream& s, uint64_t count, int64_t next_id) {
+                auto& idx = db.get_mutable_index<MultiIndexType>();
+
+                // ids of objects are kept, and the next id is the same as on the node which wrote the snapshot
+                for (uint64_t i = 0; i < count; ++i) {
+                    typename object_type::id_type id;
+                    fc::raw::unpack(s, id);
+                    db.create<object_type>([&](object_type& o) {
+                        snapshot::read(s, o);
+                        o.id = id;
+                    });
+                }
+                idx.set_next_id(next_id);
+            };
+
+            return result;
+        }
+
         template<typename MultiIndexType>
         void _add_index_impl(database &db) {
             db.add_index<MultiIndexType>();
+            db.add_snapshot_index(make_snapshot_index<MultiIndexType>());
         }
 
         template<typename MultiIndexType>
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <fc/reflect/reflect.hpp>
+#include <fc/time.hpp>
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace golos { namespace chain {
+
+    enum class lock_type: uint8_t {
+        weak_read,
+        strong_read,
+        weak_write,
+        strong_write
+    };
+
+    /**
+     * Statistics of chainbase locks taken in one context (API method, push_block, ...)
+     */
+    struct lock_stats_item final {
+        std::string context;
+        lock_type type = lock_type::weak_read;
+
+        uint64_t count = 0;
+        uint64_t timeouts = 0;    ///< lock wasn't acquired after all retries
+        uint64_t retries = 0;     ///< estimated by wait time and read/write-wait-micro
+
+        uint64_t total_wait_us = 0;
+        uint64_t max_wait_us = 0;
+        uint64_t total_hold_us = 0;
+        uint64_t max_hold_us = 0;
+
+        /// Number of waits by buckets, see lock_stats::wait_buckets
+        std::vector<uint64_t> wait_histogram;
+    };
+
+    /**
+     * Collects wait and hold times of chainbase locks by contexts.
+     *
+     * The context is set per thread by context_guard, for example json_rpc sets the API method.
+     * Only the outermost lock of a thread is counted, nested locks are already held.
+     */
+    class lock_stats final {
+    public:
+        /// Upper bounds (microseconds) of buckets of wait histogram, the last bucket is unbounded
+        static const std::vector<uint64_t> wait_buckets;
+
+        class context_guard final {
+        public:
+            explicit context_guard(std::string context);
+
+            ~context_guard();
+
+        private:
+            std::string _prev;
+        };
+
+        static const std::string& current_context();
+
+        /// Total wait time of locks of the current thread, it is counted only if statistics are enabled
+        static uint64_t thread_wait_us();
+
+        /**
+         * Measures one lock: created before the lock, acquired() is called when the lock is taken
+         */
+        class measure final {
+        public:
+            measure(lock_stats& stats, lock_type type, uint64_t wait_micro);
+
+            ~measure();
+
+            void acquired();
+
+        private:
+            lock_stats& _stats;
+            lock_type _type;
+            uint64_t _wait_micro;
+            bool _outermost;
+            fc::time_point _start;
+            fc::time_point _acquired;
+        };
+
+        void enable(bool value) {
+            _enabled = value;
+        }
+
+        bool enabled() const {
+            return _enabled;
+        }
+
+        std::vector<lock_stats_item> get() const;
+
+        void clear();
+
+    private:
+        void add(lock_type type, uint64_t wait_us, uint64_t hold_us, bool timeout, uint64_t wait_micro);
+
+        std::atomic<bool> _enabled{false};
+        mutable std::mutex _mutex;
+        std::map<std::pair<std::string, lock_type>, lock_stats_item> _items;
+    };
+
+} } // golos::chain
+
+FC_REFLECT_ENUM(golos::chain::lock_type, (weak_read)(strong_read)(weak_write)(strong_write))
+
+FC_REFLECT((golos::chain::lock_stats_item),
+    (context)(type)(count)(timeouts)(retries)
+    (total_wait_us)(max_wait_us)(total_hold_us)(max_hold_us)(wait_histogram))
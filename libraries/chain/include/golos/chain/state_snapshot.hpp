@@ -0,0 +1,338 @@
+#pragma once
+
+#include <golos/chain/steem_object_types.hpp>
+
+#include <fc/crypto/sha256.hpp>
+#include <fc/filesystem.hpp>
+#include <fc/io/raw.hpp>
+#include <fc/reflect/reflect.hpp>
+
+#include <boost/interprocess/containers/deque.hpp>
+#include <boost/interprocess/containers/flat_map.hpp>
+#include <boost/interprocess/containers/flat_set.hpp>
+#include <boost/interprocess/containers/string.hpp>
+#include <boost/interprocess/containers/vector.hpp>
+
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace golos { namespace chain {
+
+    class database;
+
+    /* The state snapshot is a file with all objects of chainbase indexes (including plugin indexes)
+     * at some block. A node can be started from it instead of replaying blocks from the beginning.
+     *
+     * +-------+-------------+--------+-----------------+-----------+-----------+-----+
+     * | Magic | Header size | Header | Header checksum | Section 1 | Section 2 | ... |
+     * +-------+-------------+--------+-----------------+-----------+-----------+-----+
+     *
+     * Each section contains objects of one index in order of their ids. The header keeps
+     * the position, size and checksum of each section, so sections are written and read in parallel.
+     */
+
+    struct snapshot_section final {
+        std::string name;
+        uint64_t count = 0;
+        int64_t next_id = 0;
+        uint64_t offset = 0;
+        uint64_t size = 0;
+        fc::sha256 checksum;
+    };
+
+    struct snapshot_header final {
+        uint32_t version = 0;
+        chain_id_type chain_id;
+        uint32_t head_block_num = 0;
+        block_id_type head_block_id;
+        fc::time_point_sec head_block_time;
+        std::vector<snapshot_section> sections;
+    };
+
+    /**
+     * Buffered output of one section, also calculates the checksum of the section
+     */
+    class snapshot_ostream final {
+    public:
+        explicit snapshot_ostream(const fc::path& file);
+
+        ~snapshot_ostream();
+
+        void write(const char* data, std::size_t size);
+
+        void put(char c) {
+            write(&c, 1);
+        }
+
+        void flush();
+
+        uint64_t size() const {
+            return _size;
+        }
+
+        fc::sha256 checksum();
+
+    private:
+        std::ofstream _stream;
+        fc::sha256::encoder _encoder;
+        std::vector<char> _buffer;
+        uint64_t _size = 0;
+    };
+
+    /**
+     * Buffered input of one section, also calculates the checksum of the section
+     */
+    class snapshot_istream final {
+    public:
+        snapshot_istream(const fc::path& file, uint64_t offset, uint64_t size);
+
+        void read(char* data, std::size_t size);
+
+        void get(char& c) {
+            read(&c, 1);
+        }
+
+        uint64_t remaining() const {
+            return _remaining + (_buffer.size() - _pos);
+        }
+
+        fc::sha256 checksum();
+
+    private:
+        void fill();
+
+        std::ifstream _stream;
+        fc::sha256::encoder _encoder;
+        std::vector<char> _buffer;
+        std::size_t _pos = 0;
+        uint64_t _remaining = 0;
+    };
+
+    /**
+     * Functions to write and read objects of one index, see make_snapshot_index()
+     */
+    struct snapshot_index final {
+        std::string name;
+        std::function<uint64_t (const database&, snapshot_ostream&, int64_t& next_id)> write;
+        std::function<void (database&, snapshot_istream&, uint64_t count, int64_t next_id)> read;
+    };
+
+    namespace snapshot {
+
+        namespace bip = boost::interprocess;
+
+        // Objects live in shared memory, so containers in them have allocators and can't be packed with fc::raw.
+        // Reflected objects are visited field by field, shared containers are handled here,
+        // all other types are passed to fc::raw.
+
+        template<typename T, bool = fc::reflector<T>::is_defined::value>
+        struct is_reflected_object: std::false_type {};
+
+        template<typename T>
+        struct is_reflected_object<T, true>: std::integral_constant<bool, !fc::reflector<T>::is_enum::value> {};
+
+        template<typename Stream, typename T>
+        void write(Stream& s, const T& v);
+
+        template<typename Stream, typename A>
+        void write(Stream& s, const bip::basic_string<char, std::char_traits<char>, A>& v);
+
+        template<typename Stream, typename T, typename A>
+        void write(Stream& s, const bip::vector<T, A>& v);
+
+        template<typename Stream, typename T, typename A>
+        void write(Stream& s, const bip::deque<T, A>& v);
+
+        template<typename Stream, typename K, typename V, typename C, typename A>
+        void write(Stream& s, const bip::flat_map<K, V, C, A>& v);
+
+        template<typename Stream, typename K, typename C, typename A>
+        void write(Stream& s, const bip::flat_set<K, C, A>& v);
+
+        template<typename Stream, typename T>
+        void read(Stream& s, T& v);
+
+        template<typename Stream, typename A>
+        void read(Stream& s, bip::basic_string<char, std::char_traits<char>, A>& v);
+
+        template<typename Stream, typename T, typename A>
+        void read(Stream& s, bip::vector<T, A>& v);
+
+        template<typename Stream, typename T, typename A>
+        void read(Stream& s, bip::deque<T, A>& v);
+
+        template<typename Stream, typename K, typename V, typename C, typename A>
+        void read(Stream& s, bip::flat_map<K, V, C, A>& v);
+
+        template<typename Stream, typename K, typename C, typename A>
+        void read(Stream& s, bip::flat_set<K, C, A>& v);
+
+        template<typename Stream, typename Class>
+        struct write_visitor final {
+            write_visitor(Stream& s, const Class& o): s(s), o(o) {
+            }
+
+            template<typename Member, class C, Member (C::*member)>
+            void operator()(const char*) const {
+                write(s, o.*member);
+            }
+
+            Stream& s;
+            const Class& o;
+        };
+
+        template<typename Stream, typename Class>
+        struct read_visitor final {
+            read_visitor(Stream& s, Class& o): s(s), o(o) {
+            }
+
+            template<typename Member, class C, Member (C::*member)>
+            void operator()(const char*) const {
+                read(s, o.*member);
+            }
+
+            Stream& s;
+            Class& o;
+        };
+
+        template<typename Stream, typename T>
+        void write_value(Stream& s, const T& v, std::true_type) {
+            fc::reflector<T>::visit(write_visitor<Stream, T>(s, v));
+        }
+
+        template<typename Stream, typename T>
+        void write_value(Stream& s, const T& v, std::false_type) {
+            fc::raw::pack(s, v);
+        }
+
+        template<typename Stream, typename T>
+        void read_value(Stream& s, T& v, std::true_type) {
+            fc::reflector<T>::visit(read_visitor<Stream, T>(s, v));
+        }
+
+        template<typename Stream, typename T>
+        void read_value(Stream& s, T& v, std::false_type) {
+            fc::raw::unpack(s, v);
+        }
+
+        template<typename Stream, typename T>
+        void write(Stream& s, const T& v) {
+            write_value(s, v, is_reflected_object<T>());
+        }
+
+        template<typename Stream, typename T>
+        void read(Stream& s, T& v) {
+            read_value(s, v, is_reflected_object<T>());
+        }
+
+        template<typename Stream, typename Container>
+        void write_sequence(Stream& s, const Container& v) {
+            fc::raw::pack(s, fc::unsigned_int(v.size()));
+            for (const auto& item: v) {
+                write(s, item);
+            }
+        }
+
+        template<typename Stream, typename A>
+        void write(Stream& s, const bip::basic_string<char, std::char_traits<char>, A>& v) {
+            fc::raw::pack(s, fc::unsigned_int(v.size()));
+            if (!v.empty()) {
+                s.write(v.data(), v.size());
+            }
+        }
+
+        template<typename Stream, typename T, typename A>
+        void write(Stream& s, const bip::vector<T, A>& v) {
+            write_sequence(s, v);
+        }
+
+        template<typename Stream, typename T, typename A>
+        void write(Stream& s, const bip::deque<T, A>& v) {
+            write_sequence(s, v);
+        }
+
+        template<typename Stream, typename K, typename V, typename C, typename A>
+        void write(Stream& s, const bip::flat_map<K, V, C, A>& v) {
+            fc::raw::pack(s, fc::unsigned_int(v.size()));
+            for (const auto& item: v) {
+                write(s, item.first);
+                write(s, item.second);
+            }
+        }
+
+        template<typename Stream, typename K, typename C, typename A>
+        void write(Stream& s, const bip::flat_set<K, C, A>& v) {
+            write_sequence(s, v);
+        }
+
+        template<typename Stream, typename A>
+        void read(Stream& s, bip::basic_string<char, std::char_traits<char>, A>& v) {
+            fc::unsigned_int size;
+            fc::raw::unpack(s, size);
+            v.resize(size.value);
+            if (size.value) {
+                s.read(&v[0], size.value);
+            }
+        }
+
+        template<typename Stream, typename T, typename A>
+        void read(Stream& s, bip::vector<T, A>& v) {
+            fc::unsigned_int size;
+            fc::raw::unpack(s, size);
+            v.clear();
+            v.reserve(size.value);
+            for (uint32_t i = 0; i < size.value; ++i) {
+                T item;
+                read(s, item);
+                v.push_back(std::move(item));
+            }
+        }
+
+        template<typename Stream, typename T, typename A>
+        void read(Stream& s, bip::deque<T, A>& v) {
+            fc::unsigned_int size;
+            fc::raw::unpack(s, size);
+            v.clear();
+            for (uint32_t i = 0; i < size.value; ++i) {
+                T item;
+                read(s, item);
+                v.push_back(std::move(item));
+            }
+        }
+
+        template<typename Stream, typename K, typename V, typename C, typename A>
+        void read(Stream& s, bip::flat_map<K, V, C, A>& v) {
+            fc::unsigned_int size;
+            fc::raw::unpack(s, size);
+            v.clear();
+            v.reserve(size.value);
+            for (uint32_t i = 0; i < size.value; ++i) {
+                std::pair<K, V> item;
+                read(s, item.first);
+                read(s, item.second);
+                v.insert(std::move(item));
+            }
+        }
+
+        template<typename Stream, typename K, typename C, typename A>
+        void read(Stream& s, bip::flat_set<K, C, A>& v) {
+            fc::unsigned_int size;
+            fc::raw::unpack(s, size);
+            v.clear();
+            v.reserve(size.value);
+            for (uint32_t i = 0; i < size.value; ++i) {
+                K item;
+                read(s, item);
+                v.insert(std::move(item));
+            }
+        }
+
+    } // namespace snapshot
+
+} } // golos::chain
+
+FC_REFLECT((golos::chain::snapshot_section), (name)(count)(next_id)(offset)(size)(checksum))
+FC_REFLECT((golos::chain::snapshot_header),
+    (version)(chain_id)(head_block_num)(head_block_id)(head_block_time)(sections))
@@ -0,0 +1,106 @@
+#include <golos/chain/lock_stats.hpp>
+
+#include <algorithm>
+
+namespace golos { namespace chain {
+
+    namespace {
+        thread_local std::string lock_context = "other";
+        thread_local uint32_t lock_depth = 0;
+        thread_local uint64_t lock_wait = 0;
+    }
+
+    const std::vector<uint64_t> lock_stats::wait_buckets = {10, 100, 1000, 10000, 100000, 1000000};
+
+    lock_stats::context_guard::context_guard(std::string context)
+        : _prev(std::move(lock_context)) {
+        lock_context = std::move(context);
+    }
+
+    lock_stats::context_guard::~context_guard() {
+        lock_context = std::move(_prev);
+    }
+
+    const std::string& lock_stats::current_context() {
+        return lock_context;
+    }
+
+    uint64_t lock_stats::thread_wait_us() {
+        return lock_wait;
+    }
+
+    lock_stats::measure::measure(lock_stats& stats, lock_type type, uint64_t wait_micro)
+        : _stats(stats),
+          _type(type),
+          _wait_micro(wait_micro),
+          _outermost(stats.enabled() && lock_depth == 0) {
+        ++lock_depth;
+        if (_outermost) {
+            _start = fc::time_point::now();
+        }
+    }
+
+    void lock_stats::measure::acquired() {
+        if (_outermost) {
+            _acquired = fc::time_point::now();
+        }
+    }
+
+    lock_stats::measure::~measure() {
+        --lock_depth;
+        if (!_outermost) {
+            return;
+        }
+
+        auto now = fc::time_point::now();
+        if (_acquired == fc::time_point()) {
+            lock_wait += (now - _start).count();
+            _stats.add(_type, (now - _start).count(), 0, true, _wait_micro);
+        } else {
+            lock_wait += (_acquired - _start).count();
+            _stats.add(_type, (_acquired - _start).count(), (now - _acquired).count(), false, _wait_micro);
+        }
+    }
+
+    void lock_stats::add(lock_type type, uint64_t wait_us, uint64_t hold_us, bool timeout, uint64_t wait_micro) {
+        auto bucket = std::lower_bound(wait_buckets.begin(), wait_buckets.end(), wait_us) - wait_buckets.begin();
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto& item = _items[std::make_pair(lock_context, type)];
+        if (item.wait_histogram.empty()) {
+            item.context = lock_context;
+            item.type = type;
+            item.wait_histogram.resize(wait_buckets.size() + 1);
+        }
+
+        ++item.count;
+        if (timeout) {
+            ++item.timeouts;
+        }
+        if (wait_micro) {
+            item.retries += wait_us / wait_micro;
+        }
+        item.total_wait_us += wait_us;
+        item.max_wait_us = std::max(item.max_wait_us, wait_us);
+        item.total_hold_us += hold_us;
+        item.max_hold_us = std::max(item.max_hold_us, hold_us);
+        ++item.wait_histogram[bucket];
+    }
+
+    std::vector<lock_stats_item> lock_stats::get() const {
+        std::vector<lock_stats_item> result;
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        result.reserve(_items.size());
+        for (const auto& item: _items) {
+            result.push_back(item.second);
+        }
+        return result;
+    }
+
+    void lock_stats::clear() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _items.clear();
+    }
+
+} } // golos::chain
@@ -1201,6 +1201,9 @@ namespace golos { namespace chain {
                             cvo.last_update = _db.head_block_time();
                             cvo.num_changes = -1;           // mark vote that it's ready to be removed (archived comment)
                         });
+                        _db.modify(comment, [&](comment_object& c) {
+                            c.vote_count++;
+                        });
                     } else {
                         _db.modify(*itr, [&](comment_vote_object& cvo) {
                             cvo.vote_percent = o.weight;
@@ -1328,6 +1331,7 @@ namespace golos { namespace chain {
                         } else {
                             c.net_votes--;
                         }
+                        c.vote_count++;
                         if (!_db.has_hardfork(STEEMIT_HARDFORK_0_6__114) && c.net_rshares == -c.abs_rshares)
                             GOLOS_ASSERT(c.net_votes < 0, golos::internal_error, "Comment has negative network votes?");
                     });
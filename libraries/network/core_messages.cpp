@@ -46,6 +46,8 @@ namespace golos {
         const core_message_type_enum check_firewall_reply_message::type = core_message_type_enum::check_firewall_reply_message_type;
         const core_message_type_enum get_current_connections_request_message::type = core_message_type_enum::get_current_connections_request_message_type;
         const core_message_type_enum get_current_connections_reply_message::type = core_message_type_enum::get_current_connections_reply_message_type;
+        const core_message_type_enum fetch_block_range_message::type = core_message_type_enum::fetch_block_range_message_type;
+        const core_message_type_enum block_range_message::type = core_message_type_enum::block_range_message_type;
 
     }
 } // golos::network
@@ -68,6 +68,12 @@
  */
 #define GRAPHENE_NET_MESSAGE_CACHE_DURATION_IN_BLOCKS        5
 
+/**
+ * The message cache is also limited by the size of messages, the oldest
+ * messages are dropped when it is exceeded.
+ */
+#define GRAPHENE_NET_MESSAGE_CACHE_MAX_SIZE_IN_BYTES         (64 * 1024 * 1024)
+
 /**
  * We prevent a peer from offering us a list of blocks which, if we fetched them
  * all, would result in a blockchain that extended into the future.
@@ -81,6 +87,26 @@
 
 #define GRAPHENE_NET_MAX_BLOCKS_PER_PEER_DURING_SYNCING      200
 
+/**
+ * The number of sync blocks requested from a peer in one batch is adapted to the
+ * measured throughput of the peer, so that a batch takes about this time.  It starts
+ * from the minimum and is limited by maximum_blocks_per_peer_during_syncing.
+ */
+#define GRAPHENE_NET_SYNC_BATCH_TARGET_SECONDS               2
+#define GRAPHENE_NET_MIN_BLOCKS_PER_PEER_DURING_SYNCING      20
+
+/**
+ * Version of fetch_block_range_message/block_range_message, a node sends it in the user_data
+ * of hello_message.  Sync blocks are fetched by ranges only from peers which announce it.
+ */
+#define GRAPHENE_NET_BLOCK_RANGE_VERSION                     1
+
+/**
+ * Maximum size of packed blocks in one block_range_message before compression,
+ * a range always contains at least one block.
+ */
+#define GRAPHENE_NET_MAX_BLOCK_RANGE_SIZE                    (1024 * 1024)
+
 /**
  * During normal operation, how many items will be fetched from each
  * peer at a time.  This will only come into play when the network
@@ -89,6 +89,8 @@ namespace golos {
             check_firewall_reply_message_type = 5015,
             get_current_connections_request_message_type = 5016,
             get_current_connections_reply_message_type = 5017,
+            fetch_block_range_message_type = 5018,
+            block_range_message_type = 5019,
             core_message_type_last = 5099
         };
 
@@ -202,6 +204,49 @@ namespace golos {
             }
         };
 
+        /**
+         * Request of contiguous blocks during sync, it is sent only to peers which announce
+         * block_range_version in the user_data of hello_message.
+         */
+        struct fetch_block_range_message {
+            static const core_message_type_enum type;
+
+            uint32_t first_block_num;
+            uint32_t block_count;
+            bool compress;
+
+            fetch_block_range_message() {
+            }
+
+            fetch_block_range_message(uint32_t first_block_num, uint32_t block_count, bool compress) :
+                    first_block_num(first_block_num),
+                    block_count(block_count),
+                    compress(compress) {
+            }
+        };
+
+        /**
+         * Reply to fetch_block_range_message. It can contain fewer blocks than requested
+         * (limited by GRAPHENE_NET_MAX_BLOCK_RANGE_SIZE), none if the peer doesn't have the first block.
+         */
+        struct block_range_message {
+            static const core_message_type_enum type;
+
+            uint32_t first_block_num;
+            uint32_t block_count;
+            uint32_t uncompressed_size; ///< zero if data isn't compressed
+            std::vector<char> data;     ///< packed signed_blocks, one after another
+
+            block_range_message() {
+            }
+
+            block_range_message(uint32_t first_block_num, uint32_t block_count) :
+                    first_block_num(first_block_num),
+                    block_count(block_count),
+                    uncompressed_size(0) {
+            }
+        };
+
         struct hello_message {
             static const core_message_type_enum type;
 
@@ -444,6 +489,8 @@ FC_REFLECT_ENUM(golos::network::core_message_type_enum,
                 (check_firewall_reply_message_type)
                 (get_current_connections_request_message_type)
                 (get_current_connections_reply_message_type)
+                (fetch_block_range_message_type)
+                (block_range_message_type)
                 (core_message_type_last))
 
 FC_REFLECT((golos::network::trx_message), (trx))
@@ -461,6 +508,13 @@ FC_REFLECT((golos::network::fetch_blockchain_item_ids_message), (item_type)
 FC_REFLECT((golos::network::fetch_items_message), (item_type)
         (items_to_fetch))
 FC_REFLECT((golos::network::item_not_available_message), (requested_item))
+FC_REFLECT((golos::network::fetch_block_range_message), (first_block_num)
+        (block_count)
+        (compress))
+FC_REFLECT((golos::network::block_range_message), (first_block_num)
+        (block_count)
+        (uncompressed_size)
+        (data))
 FC_REFLECT((golos::network::hello_message), (user_agent)
         (core_protocol_version)
         (inbound_address)
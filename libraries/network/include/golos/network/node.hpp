@@ -113,6 +113,16 @@ namespace golos {
              */
             virtual message get_item(const item_id &id) = 0;
 
+            /**
+             *  Appends packed blocks starting from first_block_num to result, one after another,
+             *  while the size of result is less than max_size (at least one block is appended).
+             *
+             *  @param last_block_id set to the id of the last appended block
+             *  @return the number of appended blocks, it is less than count if we don't have more blocks
+             */
+            virtual uint32_t get_packed_blocks(uint32_t first_block_num, uint32_t count, uint32_t max_size,
+                    std::vector<char> &result, item_hash_t &last_block_id) = 0;
+
             /**
              * Returns a synopsis of the blockchain used for syncing.
              * This consists of a list of selected item hashes from our current preferred
@@ -299,6 +309,13 @@ namespace golos {
 
             fc::variant_object get_call_statistics() const;
 
+#ifdef ENABLE_P2P_DEBUGGING_API
+            /**
+             * Returns the size of the cache of recently broadcasted messages and its hits and misses
+             */
+            fc::variant_object get_message_cache_statistics() const;
+#endif // ENABLE_P2P_DEBUGGING_API
+
         private:
             std::unique_ptr<detail::node_impl, detail::node_impl_deleter> my;
         };
@@ -215,6 +215,7 @@ namespace golos {
             fc::optional<std::string> platform;
             fc::optional<uint32_t> bitness;
             fc::optional<golos::protocol::chain_id_type> chain_id;
+            fc::optional<uint32_t> block_range_version;
 
             // for inbound connections, these fields record what the peer sent us in
             // its hello message.  For outbound, they record what we sent the peer
@@ -239,6 +240,11 @@ namespace golos {
             item_hash_t last_block_delegate_has_seen; /// the hash of the last block  this peer has told us about that the peer knows
             fc::time_point_sec last_block_time_delegate_has_seen;
             bool inhibit_fetching_sync_blocks;
+            uint32_t sync_window; /// number of blocks to request from this peer in one batch, adapted to its throughput
+            uint32_t sync_batch_size; /// number of blocks requested in the current batch
+            fc::time_point sync_batch_start_time;
+            double sync_blocks_per_second; /// moving average of the throughput of sync batches
+            fc::optional<fetch_block_range_message> block_range_requested_from_peer; /// the range of sync blocks we're waiting for from this peer
             /// @}
 
             /// non-synchronization state data
@@ -27,6 +27,7 @@
 #include <unordered_set>
 #include <list>
 #include <forward_list>
+#include <iterator>
 #include <iostream>
 #include <boost/tuple/tuple.hpp>
 #include <boost/circular_buffer.hpp>
@@ -65,6 +66,8 @@
 #include <golos/network/peer_connection.hpp>
 #include <golos/network/exceptions.hpp>
 
+#include <zlib.h>
+
 #include <fc/git_revision.hpp>
 
 //#define ENABLE_DEBUG_ULOGS
@@ -122,7 +125,7 @@ namespace golos {
 
                 struct message_info {
                     message_hash_type message_hash;
-                    message message_body;
+                    std::shared_ptr<const message> message_body; // serialized once, lookups share it
                     uint32_t block_clock_when_received;
 
                     // for network performance stats
@@ -135,30 +138,53 @@ namespace golos {
                             const message_propagation_data &propagation_data,
                             fc::uint160_t message_contents_hash) :
                             message_hash(message_hash),
-                            message_body(message_body),
+                            message_body(std::make_shared<const message>(message_body)),
                             block_clock_when_received(block_clock_when_received),
                             propagation_data(propagation_data),
                             message_contents_hash(message_contents_hash) {
                     }
+
+                    size_t size_in_bytes() const {
+                        return sizeof(message_info) + sizeof(message) + message_body->data.size();
+                    }
                 };
 
+                // messages are received in the order of the block clock, so the oldest ones are at the front
                 typedef boost::multi_index_container
                         <message_info,
-                                bmi::indexed_by<bmi::ordered_unique<bmi::tag<message_hash_index>,
-                                        bmi::member<message_info, message_hash_type, &message_info::message_hash>>,
-                                        bmi::ordered_non_unique<bmi::tag<message_contents_hash_index>,
-                                                bmi::member<message_info, fc::uint160_t, &message_info::message_contents_hash>>,
-                                        bmi::ordered_non_unique<bmi::tag<block_clock_index>,
-                                                bmi::member<message_info, uint32_t, &message_info::block_clock_when_received>>>
+                                bmi::indexed_by<bmi::hashed_unique<bmi::tag<message_hash_index>,
+                                        bmi::member<message_info, message_hash_type, &message_info::message_hash>,
+                                        std::hash<message_hash_type>>,
+                                        bmi::hashed_non_unique<bmi::tag<message_contents_hash_index>,
+                                                bmi::member<message_info, fc::uint160_t, &message_info::message_contents_hash>,
+                                                std::hash<fc::uint160_t>>,
+                                        bmi::sequenced<bmi::tag<block_clock_index>>>
                         > message_cache_container;
 
                 message_cache_container _message_cache;
 
                 uint32_t block_clock;
 
+                size_t _size_in_bytes;
+                size_t _max_size_in_bytes;
+
+#ifdef ENABLE_P2P_DEBUGGING_API
+                uint64_t _hits;
+                uint64_t _misses;
+#endif // ENABLE_P2P_DEBUGGING_API
+
+                void erase_oldest_message();
+
             public:
                 blockchain_tied_message_cache() :
-                        block_clock(0) {
+                        block_clock(0),
+                        _size_in_bytes(0),
+                        _max_size_in_bytes(GRAPHENE_NET_MESSAGE_CACHE_MAX_SIZE_IN_BYTES)
+#ifdef ENABLE_P2P_DEBUGGING_API
+                        , _hits(0),
+                        _misses(0)
+#endif // ENABLE_P2P_DEBUGGING_API
+                {
                 }
 
                 void block_accepted();
@@ -166,21 +192,51 @@ namespace golos {
                 void cache_message(const message &message_to_cache, const message_hash_type &hash_of_message_to_cache,
                         const message_propagation_data &propagation_data, const fc::uint160_t &message_content_hash);
 
-                message get_message(const message_hash_type &hash_of_message_to_lookup);
+                /// Lookups of inventory and fetch requests, they are counted in hits and misses.
+                /// @return nullptr if the message isn't in the cache
+                std::shared_ptr<const message> find_message(const message_hash_type &hash_of_message_to_lookup,
+                        fc::uint160_t *message_contents_hash = nullptr);
+
+                /// Lookup of a message of type by its contents (block id or transaction id), it isn't counted.
+                /// @return nullptr if the message isn't in the cache
+                std::shared_ptr<const message> find_message_by_contents(uint32_t message_type,
+                        const fc::uint160_t &message_contents_hash) const;
 
                 message_propagation_data get_message_propagation_data(const fc::uint160_t &hash_of_message_contents_to_lookup) const;
 
+                void set_max_size_in_bytes(size_t max_size_in_bytes);
+
+                size_t get_max_size_in_bytes() const {
+                    return _max_size_in_bytes;
+                }
+
                 size_t size() const {
                     return _message_cache.size();
                 }
+
+                size_t size_in_bytes() const {
+                    return _size_in_bytes;
+                }
+
+#ifdef ENABLE_P2P_DEBUGGING_API
+                fc::variant_object get_statistics() const;
+#endif // ENABLE_P2P_DEBUGGING_API
             };
 
+            void blockchain_tied_message_cache::erase_oldest_message() {
+                auto &index = _message_cache.get<block_clock_index>();
+                _size_in_bytes -= index.front().size_in_bytes();
+                index.pop_front();
+            }
+
             void blockchain_tied_message_cache::block_accepted() {
                 ++block_clock;
                 if (block_clock > cache_duration_in_blocks) {
-                    _message_cache.get<block_clock_index>().erase(_message_cache.get<block_clock_index>().begin(),
-                            _message_cache.get<block_clock_index>().lower_bound(
-                                    block_clock - cache_duration_in_blocks));
+                    auto &index = _message_cache.get<block_clock_index>();
+                    while (!index.empty() &&
+                           index.front().block_clock_when_received < block_clock - cache_duration_in_blocks) {
+                        erase_oldest_message();
+                    }
                 }
             }
 
@@ -188,20 +244,50 @@ namespace golos {
                     const message_hash_type &hash_of_message_to_cache,
                     const message_propagation_data &propagation_data,
                     const fc::uint160_t &message_content_hash) {
-                _message_cache.insert(message_info(hash_of_message_to_cache,
+                if (_message_cache.get<message_hash_index>().count(hash_of_message_to_cache)) {
+                    return;
+                }
+                auto result = _message_cache.insert(message_info(hash_of_message_to_cache,
                         message_to_cache,
                         block_clock,
                         propagation_data,
                         message_content_hash));
+                _size_in_bytes += result.first->size_in_bytes();
+
+                // the new message is kept even if it alone exceeds the limit
+                while (_size_in_bytes > _max_size_in_bytes && _message_cache.size() > 1) {
+                    erase_oldest_message();
+                }
             }
 
-            message blockchain_tied_message_cache::get_message(const message_hash_type &hash_of_message_to_lookup) {
-                message_cache_container::index<message_hash_index>::type::const_iterator iter =
-                        _message_cache.get<message_hash_index>().find(hash_of_message_to_lookup);
-                if (iter != _message_cache.get<message_hash_index>().end()) {
-                    return iter->message_body;
+            std::shared_ptr<const message> blockchain_tied_message_cache::find_message(
+                    const message_hash_type &hash_of_message_to_lookup, fc::uint160_t *message_contents_hash) {
+                auto &index = _message_cache.get<message_hash_index>();
+                auto iter = index.find(hash_of_message_to_lookup);
+                if (iter == index.end()) {
+#ifdef ENABLE_P2P_DEBUGGING_API
+                    ++_misses;
+#endif // ENABLE_P2P_DEBUGGING_API
+                    return nullptr;
                 }
-                FC_THROW_EXCEPTION(fc::key_not_found_exception, "Requested message not in cache");
+#ifdef ENABLE_P2P_DEBUGGING_API
+                ++_hits;
+#endif // ENABLE_P2P_DEBUGGING_API
+                if (message_contents_hash != nullptr) {
+                    *message_contents_hash = iter->message_contents_hash;
+                }
+                return iter->message_body;
+            }
+
+            std::shared_ptr<const message> blockchain_tied_message_cache::find_message_by_contents(
+                    uint32_t message_type, const fc::uint160_t &message_contents_hash) const {
+                auto range = _message_cache.get<message_contents_hash_index>().equal_range(message_contents_hash);
+                for (auto iter = range.first; iter != range.second; ++iter) {
+                    if (iter->message_body->msg_type == message_type) {
+                        return iter->message_body;
+                    }
+                }
+                return nullptr;
             }
 
             message_propagation_data blockchain_tied_message_cache::get_message_propagation_data(const fc::uint160_t &hash_of_message_contents_to_lookup) const {
@@ -216,6 +302,25 @@ namespace golos {
                 FC_THROW_EXCEPTION(fc::key_not_found_exception, "Requested message not in cache");
             }
 
+            void blockchain_tied_message_cache::set_max_size_in_bytes(size_t max_size_in_bytes) {
+                _max_size_in_bytes = max_size_in_bytes;
+                while (_size_in_bytes > _max_size_in_bytes && _message_cache.size() > 1) {
+                    erase_oldest_message();
+                }
+            }
+
+#ifdef ENABLE_P2P_DEBUGGING_API
+            fc::variant_object blockchain_tied_message_cache::get_statistics() const {
+                fc::mutable_variant_object result;
+                result["size"] = uint64_t(_message_cache.size());
+                result["size_in_bytes"] = uint64_t(_size_in_bytes);
+                result["max_size_in_bytes"] = uint64_t(_max_size_in_bytes);
+                result["hits"] = _hits;
+                result["misses"] = _misses;
+                return result;
+            }
+#endif // ENABLE_P2P_DEBUGGING_API
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////
 
             // This specifies configuration info for the local node.  It's stored as JSON
@@ -292,6 +397,7 @@ namespace golos {
                                    (handle_transaction) \
                                    (get_block_ids) \
                                    (get_item) \
+                                   (get_packed_blocks) \
                                    (get_blockchain_synopsis) \
                                    (sync_status) \
                                    (connection_count_changed) \
@@ -399,6 +505,9 @@ namespace golos {
 
                 message get_item(const item_id &id) override;
 
+                uint32_t get_packed_blocks(uint32_t first_block_num, uint32_t count, uint32_t max_size,
+                        std::vector<char> &result, item_hash_t &last_block_id) override;
+
                 std::vector<item_hash_t> get_blockchain_synopsis(const item_hash_t &reference_point,
                         uint32_t number_of_blocks_after_reference_point) override;
 
@@ -592,6 +701,16 @@ namespace golos {
                 unsigned _maximum_number_of_sync_blocks_to_prefetch;
                 unsigned _maximum_blocks_per_peer_during_syncing;
 
+                /// threads which unpack received blocks and recover signature keys of their transactions,
+                /// so the p2p thread only hands decoded blocks to the delegate in order
+                std::vector<std::shared_ptr<fc::thread>> _block_decode_threads;
+                uint32_t _next_block_decode_thread = 0;
+                bool _decode_signature_keys = false;
+
+                /// sync blocks are fetched by block_range_message from peers which announce block_range_version
+                bool _use_block_ranges = true;
+                bool _compress_block_ranges = false;
+
                 std::list<fc::future<void>> _handle_message_calls_in_progress;
                 std::set<message_hash_type> _message_ids_currently_being_processed;
 
@@ -611,10 +730,24 @@ namespace golos {
 
                 void request_sync_items_from_peer(const peer_connection_ptr &peer, const std::vector<item_hash_t> &items_to_request);
 
+                void request_sync_block_range_from_peer(const peer_connection_ptr &peer, uint32_t first_block_num, uint32_t block_count);
+
                 void fetch_sync_items_loop();
 
                 void trigger_fetch_sync_items_loop();
 
+                void update_sync_window(peer_connection *peer);
+
+                golos::network::block_message decode_block_message(const message &message_to_decode);
+
+                std::vector<golos::network::block_message> decode_block_range_message(const block_range_message &message_to_decode);
+
+                std::vector<char> compress_block_range(const std::vector<char> &data);
+
+                fc::thread *next_block_decode_thread();
+
+                void set_block_decode_threads(uint32_t thread_count);
+
                 bool is_item_in_any_peers_inventory(const item_id &item) const;
 
                 void fetch_items_loop();
@@ -689,6 +822,12 @@ namespace golos {
                 void on_item_not_available_message(peer_connection *originating_peer,
                         const item_not_available_message &item_not_available_message_received);
 
+                void on_fetch_block_range_message(peer_connection *originating_peer,
+                        const fetch_block_range_message &fetch_block_range_message_received);
+
+                void on_block_range_message(peer_connection *originating_peer,
+                        const block_range_message &block_range_message_received);
+
                 void on_item_ids_inventory_message(peer_connection *originating_peer,
                         const item_ids_inventory_message &item_ids_inventory_message_received);
 
@@ -725,6 +864,10 @@ namespace golos {
 
                 void process_block_during_sync(peer_connection *originating_peer, const golos::network::block_message &block_message, const message_hash_type &message_hash);
 
+                void process_requested_sync_block(peer_connection *originating_peer, const golos::network::block_message &block_message, const message_hash_type &message_hash);
+
+                void continue_fetching_sync_items_from_peer(peer_connection *peer);
+
                 void process_block_during_normal_operation(peer_connection *originating_peer, const golos::network::block_message &block_message, const message_hash_type &message_hash);
 
                 void process_block_message(peer_connection *originating_peer, const message &message_to_process, const message_hash_type &message_hash);
@@ -825,6 +968,10 @@ namespace golos {
 
                 fc::variant_object get_call_statistics() const;
 
+#ifdef ENABLE_P2P_DEBUGGING_API
+                fc::variant_object get_message_cache_statistics() const;
+#endif // ENABLE_P2P_DEBUGGING_API
+
                 message get_message_for_item(const item_id &item) override;
 
                 fc::variant_object network_get_info() const;
@@ -1082,12 +1229,38 @@ namespace golos {
                 VERIFY_CORRECT_THREAD();
                 dlog("requesting ${item_count} item(s) ${items_to_request} from peer ${endpoint}",
                         ("item_count", items_to_request.size())("items_to_request", items_to_request)("endpoint", peer->get_remote_endpoint()));
+                if (peer->sync_items_requested_from_peer.empty()) {
+                    peer->sync_batch_start_time = fc::time_point::now();
+                    peer->sync_batch_size = 0;
+                }
+                peer->sync_batch_size += items_to_request.size();
                 for (const item_hash_t &item_to_request : items_to_request) {
                     _active_sync_requests.insert(active_sync_requests_map::value_type(item_to_request, fc::time_point::now()));
                     peer->last_sync_item_received_time = fc::time_point::now();
                     peer->sync_items_requested_from_peer.insert(item_to_request);
                 }
-                peer->send_message(fetch_items_message(golos::network::block_message_type, items_to_request));
+
+                // sync ids are contiguous unless some of them are already requested from other peers
+                bool request_range = _use_block_ranges && peer->block_range_version.valid() &&
+                                     *peer->block_range_version >= GRAPHENE_NET_BLOCK_RANGE_VERSION;
+                uint32_t first_block_num = golos::protocol::block_header::num_from_id(items_to_request.front());
+                for (uint32_t i = 0; request_range && i < items_to_request.size(); ++i) {
+                    request_range = golos::protocol::block_header::num_from_id(items_to_request[i]) == first_block_num + i;
+                }
+
+                if (request_range) {
+                    request_sync_block_range_from_peer(peer, first_block_num, items_to_request.size());
+                } else {
+                    peer->send_message(fetch_items_message(golos::network::block_message_type, items_to_request));
+                }
+            }
+
+            void node_impl::request_sync_block_range_from_peer(const peer_connection_ptr &peer, uint32_t first_block_num, uint32_t block_count) {
+                VERIFY_CORRECT_THREAD();
+                dlog("requesting ${count} block(s) from #${first} from peer ${endpoint}",
+                        ("count", block_count)("first", first_block_num)("endpoint", peer->get_remote_endpoint()));
+                peer->block_range_requested_from_peer = fetch_block_range_message(first_block_num, block_count, _compress_block_ranges);
+                peer->send_message(*peer->block_range_requested_from_peer);
             }
 
             void node_impl::fetch_sync_items_loop() {
@@ -1128,7 +1301,7 @@ namespace golos {
                                                 sync_item_requests_to_send[peer].push_back(item_to_potentially_request);
                                                 sync_items_to_request.insert(item_to_potentially_request);
                                                 if (sync_item_requests_to_send[peer].size() >=
-                                                    _maximum_blocks_per_peer_during_syncing) {
+                                                    std::min(peer->sync_window, _maximum_blocks_per_peer_during_syncing)) {
                                                         break;
                                                 }
                                             }
@@ -1155,6 +1328,177 @@ namespace golos {
                 } // while( !canceled )
             }
 
+            void node_impl::update_sync_window(peer_connection *peer) {
+                VERIFY_CORRECT_THREAD();
+                auto elapsed = fc::time_point::now() - peer->sync_batch_start_time;
+                if (peer->sync_batch_size == 0 || elapsed.count() <= 0) {
+                    return;
+                }
+
+                double blocks_per_second = peer->sync_batch_size * 1000000.0 / elapsed.count();
+                if (peer->sync_blocks_per_second > 0) {
+                    peer->sync_blocks_per_second = 0.7 * peer->sync_blocks_per_second + 0.3 * blocks_per_second;
+                } else {
+                    peer->sync_blocks_per_second = blocks_per_second;
+                }
+
+                // a batch, which is limited by the round-trip time, gives a rate higher than its size
+                //   per target time, so the window grows until the peer's bandwidth limits it
+                auto window = uint64_t(peer->sync_blocks_per_second * GRAPHENE_NET_SYNC_BATCH_TARGET_SECONDS);
+                window = std::max<uint64_t>(window, GRAPHENE_NET_MIN_BLOCKS_PER_PEER_DURING_SYNCING);
+                window = std::min<uint64_t>(window, _maximum_blocks_per_peer_during_syncing);
+                peer->sync_window = uint32_t(window);
+                peer->sync_batch_size = 0;
+
+                dlog("sync throughput of peer ${endpoint} is ${rate} blocks/s, requesting ${window} blocks in a batch",
+                        ("endpoint", peer->get_remote_endpoint())("rate", peer->sync_blocks_per_second)("window", window));
+            }
+
+            namespace {
+
+                void precompute_signature_keys(const golos::protocol::signed_block &block) {
+                    for (const auto &trx : block.transactions) {
+                        try {
+                            // keys are cached in the transaction and reused on applying of the block
+                            trx.precompute_signature_keys(STEEMIT_CHAIN_ID);
+                        } catch (...) {
+                            // the error will be thrown again on applying of the transaction
+                        }
+                    }
+                }
+
+                std::vector<char> uncompress_block_range(const std::vector<char> &data, uint32_t uncompressed_size) {
+                    // a range contains at least one block, which can be as large as a message
+                    FC_ASSERT(uncompressed_size <= std::max<uint32_t>(GRAPHENE_NET_MAX_BLOCK_RANGE_SIZE, MAX_MESSAGE_SIZE),
+                            "Too large block range", ("uncompressed_size", uncompressed_size));
+
+                    std::vector<char> result(uncompressed_size);
+                    uLongf size = uncompressed_size;
+                    auto status = uncompress(
+                        reinterpret_cast<Bytef*>(result.data()), &size,
+                        reinterpret_cast<const Bytef*>(data.data()), data.size());
+                    FC_ASSERT(status == Z_OK && size == uncompressed_size, "Can't decompress block range",
+                            ("status", status)("size", size)("uncompressed_size", uncompressed_size));
+                    return result;
+                }
+
+            } // namespace
+
+            fc::thread *node_impl::next_block_decode_thread() {
+                VERIFY_CORRECT_THREAD();
+                if (_block_decode_threads.empty()) {
+                    return nullptr;
+                }
+                return _block_decode_threads[_next_block_decode_thread++ % _block_decode_threads.size()].get();
+            }
+
+            golos::network::block_message node_impl::decode_block_message(const message &message_to_decode) {
+                VERIFY_CORRECT_THREAD();
+                auto thread = next_block_decode_thread();
+                if (thread == nullptr) {
+                    return message_to_decode.as<golos::network::block_message>();
+                }
+
+                bool decode_signature_keys = _decode_signature_keys;
+                // the p2p thread isn't blocked, it handles other messages while the block is decoded
+                return thread->async([&message_to_decode, decode_signature_keys]() {
+                    auto result = message_to_decode.as<golos::network::block_message>();
+                    if (decode_signature_keys) {
+                        precompute_signature_keys(result.block);
+                    }
+                    return result;
+                }, "decode_block_message").wait();
+            }
+
+            std::vector<golos::network::block_message> node_impl::decode_block_range_message(const block_range_message &message_to_decode) {
+                VERIFY_CORRECT_THREAD();
+                auto unpack = [&message_to_decode]() {
+                    std::vector<char> uncompressed;
+                    if (message_to_decode.uncompressed_size != 0) {
+                        uncompressed = uncompress_block_range(message_to_decode.data, message_to_decode.uncompressed_size);
+                    }
+                    const auto &data = message_to_decode.uncompressed_size != 0 ? uncompressed : message_to_decode.data;
+
+                    std::vector<golos::protocol::signed_block> result(message_to_decode.block_count);
+                    fc::datastream<const char *> ds(data.data(), data.size());
+                    for (auto &block : result) {
+                        fc::raw::unpack(ds, block);
+                    }
+                    FC_ASSERT(ds.remaining() == 0, "Unexpected data after blocks of range", ("remaining", ds.remaining()));
+                    return result;
+                };
+
+                auto thread = next_block_decode_thread();
+                if (thread == nullptr) {
+                    auto blocks = unpack();
+                    return std::vector<golos::network::block_message>(blocks.begin(), blocks.end());
+                }
+
+                // boundaries of blocks are known only after unpacking, so the range is unpacked by one thread,
+                //   then block ids and signature keys are computed by all threads, each one gets a part of the range
+                auto blocks = thread->async(unpack, "decode_block_range_message").wait();
+
+                bool decode_signature_keys = _decode_signature_keys;
+                auto part_size = (blocks.size() + _block_decode_threads.size() - 1) / _block_decode_threads.size();
+                std::vector<fc::future<std::vector<golos::network::block_message>>> parts;
+                for (std::size_t begin = 0; begin < blocks.size(); begin += part_size) {
+                    auto end = std::min(begin + part_size, blocks.size());
+                    parts.push_back(next_block_decode_thread()->async([&blocks, begin, end, decode_signature_keys]() {
+                        std::vector<golos::network::block_message> result;
+                        result.reserve(end - begin);
+                        for (auto i = begin; i < end; ++i) {
+                            if (decode_signature_keys) {
+                                precompute_signature_keys(blocks[i]);
+                            }
+                            result.emplace_back(blocks[i]);
+                        }
+                        return result;
+                    }, "decode_block_range_part"));
+                }
+
+                std::vector<golos::network::block_message> result;
+                result.reserve(blocks.size());
+                for (auto &part : parts) {
+                    auto part_blocks = part.wait();
+                    std::move(part_blocks.begin(), part_blocks.end(), std::back_inserter(result));
+                }
+                return result;
+            }
+
+            std::vector<char> node_impl::compress_block_range(const std::vector<char> &data) {
+                VERIFY_CORRECT_THREAD();
+                auto compress = [&data]() {
+                    uLongf size = compressBound(data.size());
+                    std::vector<char> result(size);
+                    auto status = compress2(
+                        reinterpret_cast<Bytef*>(result.data()), &size,
+                        reinterpret_cast<const Bytef*>(data.data()), data.size(), Z_BEST_SPEED);
+                    FC_ASSERT(status == Z_OK, "Can't compress block range", ("status", status));
+                    result.resize(size);
+                    return result;
+                };
+
+                auto thread = next_block_decode_thread();
+                if (thread == nullptr) {
+                    return compress();
+                }
+                return thread->async(compress, "compress_block_range").wait();
+            }
+
+            void node_impl::set_block_decode_threads(uint32_t thread_count) {
+                VERIFY_CORRECT_THREAD();
+                if (thread_count == _block_decode_threads.size()) {
+                    return;
+                }
+                for (auto &thread : _block_decode_threads) {
+                    thread->quit();
+                }
+                _block_decode_threads.clear();
+                for (uint32_t i = 0; i < thread_count; ++i) {
+                    _block_decode_threads.push_back(std::make_shared<fc::thread>("p2p_decode_" + std::to_string(i)));
+                }
+            }
+
             void node_impl::trigger_fetch_sync_items_loop() {
                 VERIFY_CORRECT_THREAD();
                 dlog("Triggering fetch sync items loop now");
@@ -1916,6 +2260,12 @@ namespace golos {
                     case core_message_type_enum::item_not_available_message_type:
                         on_item_not_available_message(originating_peer, received_message.as<item_not_available_message>());
                         break;
+                    case core_message_type_enum::fetch_block_range_message_type:
+                        on_fetch_block_range_message(originating_peer, received_message.as<fetch_block_range_message>());
+                        break;
+                    case core_message_type_enum::block_range_message_type:
+                        on_block_range_message(originating_peer, received_message.as<block_range_message>());
+                        break;
                     case core_message_type_enum::item_ids_inventory_message_type:
                         on_item_ids_inventory_message(originating_peer, received_message.as<item_ids_inventory_message>());
                         break;
@@ -1990,6 +2340,7 @@ namespace golos {
                 }
 
                 user_data["chain_id"] = STEEMIT_CHAIN_ID;
+                user_data["block_range_version"] = GRAPHENE_NET_BLOCK_RANGE_VERSION;
 
                 return user_data;
             }
@@ -2024,6 +2375,9 @@ namespace golos {
                 if (user_data.contains("chain_id")) {
                     originating_peer->chain_id = user_data["chain_id"].as<golos::protocol::chain_id_type>();
                 }
+                if (user_data.contains("block_range_version")) {
+                    originating_peer->block_range_version = user_data["block_range_version"].as<uint32_t>();
+                }
             }
 
             void node_impl::on_hello_message(peer_connection *originating_peer, const hello_message &hello_message_received) {
@@ -2814,10 +3168,10 @@ namespace golos {
             }
 
             message node_impl::get_message_for_item(const item_id &item) {
-                try {
-                    return _message_cache.get_message(item.item_hash);
-                }
-                catch (fc::key_not_found_exception &) {
+                // queued items are identified by their contents (block id or transaction id), not by message hash
+                auto cached_message = _message_cache.find_message_by_contents(item.item_type, item.item_hash);
+                if (cached_message) {
+                    return *cached_message;
                 }
                 try {
                     return _delegate->get_item(item);
@@ -2834,25 +3188,27 @@ namespace golos {
                                 ("type", fetch_items_message_received.item_type)
                                 ("endpoint", originating_peer->get_remote_endpoint()));
 
-                fc::optional<message> last_block_message_sent;
+                fc::optional<item_hash_t> last_block_id_sent;
 
-                std::list<message> reply_messages;
+                // blocks are queued by ids and read again when they are sent, so only their ids are kept
+                std::list<std::pair<item_hash_t, message>> reply_messages;
                 for (const item_hash_t &item_hash : fetch_items_message_received.items_to_fetch) {
-                    try {
-                        message requested_message = _message_cache.get_message(item_hash);
+                    fc::uint160_t message_contents_hash;
+                    auto cached_message = _message_cache.find_message(item_hash, &message_contents_hash);
+                    if (cached_message) {
                         dlog("received item request for item ${id} from peer ${endpoint}, returning the item from my message cache",
                                 ("endpoint", originating_peer->get_remote_endpoint())
-                                        ("id", requested_message.id()));
-                        reply_messages.push_back(requested_message);
-                        if (fetch_items_message_received.item_type ==
-                            block_message_type) {
-                                last_block_message_sent = requested_message;
+                                        ("id", item_hash));
+                        if (cached_message->msg_type == block_message_type) {
+                            // the contents hash of a cached block is its id
+                            reply_messages.emplace_back(message_contents_hash, message());
+                            last_block_id_sent = message_contents_hash;
+                        } else {
+                            reply_messages.emplace_back(item_hash_t(), *cached_message);
                         }
                         continue;
                     }
-                    catch (fc::key_not_found_exception &) {
-                        // it wasn't in our local cache, that's ok ask the client
-                    }
+                    // it wasn't in our local cache, that's ok ask the client
 
                     item_id item_to_fetch(fetch_items_message_received.item_type, item_hash);
                     try {
@@ -2861,32 +3217,33 @@ namespace golos {
                                 ("id", requested_message.id())
                                         ("size", requested_message.size)
                                         ("endpoint", originating_peer->get_remote_endpoint()));
-                        reply_messages.push_back(requested_message);
-                        if (fetch_items_message_received.item_type ==
-                            block_message_type) {
-                                last_block_message_sent = requested_message;
+                        if (requested_message.msg_type == block_message_type) {
+                            auto block_id = requested_message.as<golos::network::block_message>().block_id;
+                            reply_messages.emplace_back(block_id, message());
+                            last_block_id_sent = block_id;
+                        } else {
+                            reply_messages.emplace_back(item_hash_t(), std::move(requested_message));
                         }
                         continue;
                     }
                     catch (fc::key_not_found_exception &) {
-                        reply_messages.push_back(item_not_available_message(item_to_fetch));
+                        reply_messages.emplace_back(item_hash_t(), item_not_available_message(item_to_fetch));
                         dlog("received item request from peer ${endpoint} but we don't have it",
                                 ("endpoint", originating_peer->get_remote_endpoint()));
                     }
                 }
 
                 // if we sent them a block, update our record of the last block they've seen accordingly
-                if (last_block_message_sent) {
-                    golos::network::block_message block = last_block_message_sent->as<golos::network::block_message>();
-                    originating_peer->last_block_delegate_has_seen = block.block_id;
-                    originating_peer->last_block_time_delegate_has_seen = _delegate->get_block_time(block.block_id);
+                if (last_block_id_sent) {
+                    originating_peer->last_block_delegate_has_seen = *last_block_id_sent;
+                    originating_peer->last_block_time_delegate_has_seen = _delegate->get_block_time(*last_block_id_sent);
                 }
 
-                for (const message &reply : reply_messages) {
-                    if (reply.msg_type == block_message_type) {
-                        originating_peer->send_item(item_id(block_message_type, reply.as<golos::network::block_message>().block_id));
+                for (const auto &reply : reply_messages) {
+                    if (reply.first != item_hash_t()) {
+                        originating_peer->send_item(item_id(block_message_type, reply.first));
                     } else {
-                        originating_peer->send_message(reply);
+                        originating_peer->send_message(reply.second);
                     }
                 }
             }
@@ -2927,6 +3284,113 @@ namespace golos {
                 dlog("Peer doesn't have an item we're looking for, which is fine because we weren't looking for it");
             }
 
+            void node_impl::on_fetch_block_range_message(peer_connection *originating_peer,
+                    const fetch_block_range_message &fetch_block_range_message_received) {
+                VERIFY_CORRECT_THREAD();
+                dlog("received request of ${count} block(s) from #${first} from peer ${endpoint}",
+                        ("count", fetch_block_range_message_received.block_count)
+                                ("first", fetch_block_range_message_received.first_block_num)
+                                ("endpoint", originating_peer->get_remote_endpoint()));
+
+                peer_connection_ptr originating_peer_ptr = originating_peer->shared_from_this();
+                block_range_message reply(fetch_block_range_message_received.first_block_num, 0);
+                item_hash_t last_block_id;
+                try {
+                    if (fetch_block_range_message_received.block_count > 0) {
+                        reply.block_count = _delegate->get_packed_blocks(
+                                fetch_block_range_message_received.first_block_num,
+                                fetch_block_range_message_received.block_count,
+                                GRAPHENE_NET_MAX_BLOCK_RANGE_SIZE, reply.data, last_block_id);
+                    }
+                } catch (const fc::exception &e) {
+                    wlog("unable to read blocks requested by peer ${endpoint}: ${e}",
+                            ("endpoint", originating_peer->get_remote_endpoint())("e", e.to_detail_string()));
+                    reply.block_count = 0;
+                    reply.data.clear();
+                }
+
+                if (reply.block_count > 0) {
+                    // if we sent them blocks, update our record of the last block they've seen accordingly
+                    originating_peer->last_block_delegate_has_seen = last_block_id;
+                    originating_peer->last_block_time_delegate_has_seen = _delegate->get_block_time(last_block_id);
+
+                    if (fetch_block_range_message_received.compress) {
+                        reply.uncompressed_size = reply.data.size();
+                        reply.data = compress_block_range(reply.data);
+                    }
+                }
+
+                originating_peer->send_message(reply);
+            }
+
+            void node_impl::on_block_range_message(peer_connection *originating_peer,
+                    const block_range_message &block_range_message_received) {
+                VERIFY_CORRECT_THREAD();
+                peer_connection_ptr originating_peer_ptr = originating_peer->shared_from_this();
+                const auto &requested_range = originating_peer->block_range_requested_from_peer;
+                if (!requested_range ||
+                    requested_range->first_block_num != block_range_message_received.first_block_num ||
+                    requested_range->block_count < block_range_message_received.block_count) {
+                    wlog("received ${count} block(s) from #${first} I didn't ask for from peer ${endpoint}, disconnecting from peer",
+                            ("count", block_range_message_received.block_count)
+                                    ("first", block_range_message_received.first_block_num)
+                                    ("endpoint", originating_peer->get_remote_endpoint()));
+                    fc::exception detailed_error(FC_LOG_MESSAGE(error, "You sent me blocks that I didn't ask for",
+                            ("first_block_num", block_range_message_received.first_block_num)
+                                    ("block_count", block_range_message_received.block_count)));
+                    disconnect_from_peer(originating_peer, "You sent me blocks that I didn't ask for", true, detailed_error);
+                    return;
+                }
+                originating_peer->block_range_requested_from_peer.reset();
+
+                std::vector<golos::network::block_message> blocks;
+                try {
+                    blocks = decode_block_range_message(block_range_message_received);
+                } catch (const fc::exception &e) {
+                    wlog("received invalid range of blocks from peer ${endpoint}: ${e}, disconnecting from peer",
+                            ("endpoint", originating_peer->get_remote_endpoint())("e", e.to_detail_string()));
+                    disconnect_from_peer(originating_peer, "You sent me an invalid range of blocks", true, e);
+                    return;
+                }
+                dlog("received ${count} block(s) from #${first} from peer ${endpoint}",
+                        ("count", blocks.size())("first", block_range_message_received.first_block_num)
+                                ("endpoint", originating_peer->get_remote_endpoint()));
+
+                uint32_t blocks_received = 0;
+                for (const auto &block : blocks) {
+                    if (originating_peer->sync_items_requested_from_peer.find(block.block_id) ==
+                        originating_peer->sync_items_requested_from_peer.end()) {
+                        // the peer has switched to another fork since it sent us the ids
+                        break;
+                    }
+                    process_requested_sync_block(originating_peer, block, message_hash_type());
+                    ++blocks_received;
+                }
+
+                if (!originating_peer->sync_items_requested_from_peer.empty()) {
+                    std::vector<item_hash_t> items_to_request(
+                            originating_peer->sync_items_requested_from_peer.begin(),
+                            originating_peer->sync_items_requested_from_peer.end());
+                    std::sort(items_to_request.begin(), items_to_request.end(),
+                            [](const item_hash_t &a, const item_hash_t &b) {
+                                return golos::protocol::block_header::num_from_id(a) < golos::protocol::block_header::num_from_id(b);
+                            });
+
+                    if (blocks_received > 0 && blocks_received == blocks.size()) {
+                        // the reply was limited by size, request the rest of the range
+                        request_sync_block_range_from_peer(originating_peer_ptr,
+                                block_range_message_received.first_block_num + blocks_received,
+                                items_to_request.size());
+                    } else {
+                        // request the rest by ids, the peer replies with item_not_available_message
+                        //   for blocks which aren't on its chain
+                        originating_peer->send_message(fetch_items_message(golos::network::block_message_type, items_to_request));
+                    }
+                } else if (originating_peer->idle()) {
+                    continue_fetching_sync_items_from_peer(originating_peer);
+                }
+            }
+
             void node_impl::on_item_ids_inventory_message(peer_connection *originating_peer, const item_ids_inventory_message &item_ids_inventory_message_received) {
                 VERIFY_CORRECT_THREAD();
 
@@ -3420,6 +3884,30 @@ namespace golos {
                 trigger_process_backlog_of_sync_blocks();
             }
 
+            void node_impl::process_requested_sync_block(peer_connection *originating_peer,
+                    const golos::network::block_message &block_message_to_process, const message_hash_type &message_hash) {
+                VERIFY_CORRECT_THREAD();
+                originating_peer->sync_items_requested_from_peer.erase(block_message_to_process.block_id);
+                originating_peer->last_sync_item_received_time = fc::time_point::now();
+                if (originating_peer->sync_items_requested_from_peer.empty()) {
+                    update_sync_window(originating_peer);
+                }
+                _active_sync_requests.erase(block_message_to_process.block_id);
+                process_block_during_sync(originating_peer, block_message_to_process, message_hash);
+            }
+
+            void node_impl::continue_fetching_sync_items_from_peer(peer_connection *peer) {
+                VERIFY_CORRECT_THREAD();
+                // we have finished fetching a batch of items, so we either need to grab another batch of items
+                // or we need to get another list of item ids.
+                if (peer->number_of_unfetched_item_ids > 0 &&
+                    peer->ids_of_items_to_get.size() < GRAPHENE_NET_MIN_BLOCK_IDS_TO_PREFETCH) {
+                        fetch_next_batch_of_item_ids_from_peer(peer);
+                } else {
+                        trigger_fetch_sync_items_loop();
+                }
+            }
+
             void node_impl::process_block_during_normal_operation(peer_connection *originating_peer,
                     const golos::network::block_message &block_message_to_process,
                     const message_hash_type &message_hash) {
@@ -3583,7 +4071,8 @@ namespace golos {
                 // (it's possible that we request an item during normal operation and then get kicked into sync
                 // mode before we receive and process the item.  In that case, we should process the item as a normal
                 // item to avoid confusing the sync code)
-                golos::network::block_message block_message_to_process(message_to_process.as<golos::network::block_message>());
+                peer_connection_ptr originating_peer_ptr = originating_peer->shared_from_this();
+                golos::network::block_message block_message_to_process(decode_block_message(message_to_process));
                 auto item_iter = originating_peer->items_requested_from_peer.find(item_id(golos::network::block_message_type, message_hash));
                 if (item_iter !=
                     originating_peer->items_requested_from_peer.end()) {
@@ -3595,24 +4084,11 @@ namespace golos {
                     return;
                 } else {
                     // not during normal operation.  see if we requested it during sync
-                    auto sync_item_iter = originating_peer->sync_items_requested_from_peer.find(block_message_to_process.block_id);
-                    if (sync_item_iter !=
+                    if (originating_peer->sync_items_requested_from_peer.find(block_message_to_process.block_id) !=
                         originating_peer->sync_items_requested_from_peer.end()) {
-                        originating_peer->sync_items_requested_from_peer.erase(sync_item_iter);
-                        originating_peer->last_sync_item_received_time = fc::time_point::now();
-                        _active_sync_requests.erase(block_message_to_process.block_id);
-                        process_block_during_sync(originating_peer, block_message_to_process, message_hash);
+                        process_requested_sync_block(originating_peer, block_message_to_process, message_hash);
                         if (originating_peer->idle()) {
-                            // we have finished fetching a batch of items, so we either need to grab another batch of items
-                            // or we need to get another list of item ids.
-                            if (originating_peer->number_of_unfetched_item_ids >
-                                0 &&
-                                originating_peer->ids_of_items_to_get.size() <
-                                GRAPHENE_NET_MIN_BLOCK_IDS_TO_PREFETCH) {
-                                    fetch_next_batch_of_item_ids_from_peer(originating_peer);
-                            } else {
-                                    trigger_fetch_sync_items_loop();
-                            }
+                            continue_fetching_sync_items_from_peer(originating_peer);
                         }
                         return;
                     }
@@ -4220,6 +4696,9 @@ namespace golos {
                 catch (...) {
                     wlog("Exception thrown while terminating Dump node status task, ignoring");
                 }
+
+                set_block_decode_threads(0);
+                dlog("Block decode threads terminated");
             } // node_impl::close()
 
             void node_impl::accept_connection_task(peer_connection_ptr new_peer) {
@@ -4737,7 +5216,7 @@ namespace golos {
                 ilog("node._new_received_sync_items size: ${size}", ("size", _new_received_sync_items.size()));
                 ilog("node._items_to_fetch size: ${size}", ("size", _items_to_fetch.size()));
                 ilog("node._new_inventory size: ${size}", ("size", _new_inventory.size()));
-                ilog("node._message_cache size: ${size}", ("size", _message_cache.size()));
+                ilog("node._message_cache size: ${size} (${bytes} bytes)", ("size", _message_cache.size())("bytes", _message_cache.size_in_bytes()));
                 for (const peer_connection_ptr &peer : _active_connections) {
                     ilog("  peer ${endpoint}", ("endpoint", peer->get_remote_endpoint()));
                     ilog("    peer.ids_of_items_to_get size: ${size}", ("size", peer->ids_of_items_to_get.size()));
@@ -4978,6 +5457,21 @@ namespace golos {
                 if (params.contains("maximum_blocks_per_peer_during_syncing")) {
                     _maximum_blocks_per_peer_during_syncing = params["maximum_blocks_per_peer_during_syncing"].as<uint32_t>();
                 }
+                if (params.contains("block_decode_threads")) {
+                    set_block_decode_threads(params["block_decode_threads"].as<uint32_t>());
+                }
+                if (params.contains("decode_signature_keys")) {
+                    _decode_signature_keys = params["decode_signature_keys"].as<bool>();
+                }
+                if (params.contains("use_block_ranges")) {
+                    _use_block_ranges = params["use_block_ranges"].as<bool>();
+                }
+                if (params.contains("compress_block_ranges")) {
+                    _compress_block_ranges = params["compress_block_ranges"].as<bool>();
+                }
+                if (params.contains("message_cache_max_size")) {
+                    _message_cache.set_max_size_in_bytes(params["message_cache_max_size"].as<uint64_t>());
+                }
 
                 _desired_number_of_connections = std::min(_desired_number_of_connections, _maximum_number_of_connections);
 
@@ -4998,6 +5492,11 @@ namespace golos {
                 result["maximum_number_of_blocks_to_handle_at_one_time"] = _maximum_number_of_blocks_to_handle_at_one_time;
                 result["maximum_number_of_sync_blocks_to_prefetch"] = _maximum_number_of_sync_blocks_to_prefetch;
                 result["maximum_blocks_per_peer_during_syncing"] = _maximum_blocks_per_peer_during_syncing;
+                result["block_decode_threads"] = uint32_t(_block_decode_threads.size());
+                result["decode_signature_keys"] = _decode_signature_keys;
+                result["use_block_ranges"] = _use_block_ranges;
+                result["compress_block_ranges"] = _compress_block_ranges;
+                result["message_cache_max_size"] = uint64_t(_message_cache.get_max_size_in_bytes());
                 return result;
             }
 
@@ -5057,6 +5556,13 @@ namespace golos {
                 return _delegate->get_call_statistics();
             }
 
+#ifdef ENABLE_P2P_DEBUGGING_API
+            fc::variant_object node_impl::get_message_cache_statistics() const {
+                VERIFY_CORRECT_THREAD();
+                return _message_cache.get_statistics();
+            }
+#endif // ENABLE_P2P_DEBUGGING_API
+
             fc::variant_object node_impl::network_get_info() const {
                 VERIFY_CORRECT_THREAD();
                 fc::mutable_variant_object info;
@@ -5235,6 +5741,12 @@ namespace golos {
             INVOKE_IN_IMPL(get_call_statistics);
         }
 
+#ifdef ENABLE_P2P_DEBUGGING_API
+        fc::variant_object node::get_message_cache_statistics() const {
+            INVOKE_IN_IMPL(get_message_cache_statistics);
+        }
+#endif // ENABLE_P2P_DEBUGGING_API
+
         fc::variant_object node::network_get_info() const {
             INVOKE_IN_IMPL(network_get_info);
         }
@@ -5426,6 +5938,11 @@ namespace golos {
                 INVOKE_AND_COLLECT_STATISTICS(get_item, id);
             }
 
+            uint32_t statistics_gathering_node_delegate_wrapper::get_packed_blocks(uint32_t first_block_num, uint32_t count,
+                    uint32_t max_size, std::vector<char> &result, item_hash_t &last_block_id) {
+                INVOKE_AND_COLLECT_STATISTICS(get_packed_blocks, first_block_num, count, max_size, result, last_block_id);
+            }
+
             std::vector<item_hash_t> statistics_gathering_node_delegate_wrapper::get_blockchain_synopsis(const item_hash_t &reference_point, uint32_t number_of_blocks_after_reference_point) {
                 INVOKE_AND_COLLECT_STATISTICS(get_blockchain_synopsis, reference_point, number_of_blocks_after_reference_point);
             }
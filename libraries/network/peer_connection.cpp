@@ -80,6 +80,9 @@ namespace golos {
                 peer_needs_sync_items_from_us(true),
                 we_need_sync_items_from_peer(true),
                 inhibit_fetching_sync_blocks(false),
+                sync_window(GRAPHENE_NET_MIN_BLOCKS_PER_PEER_DURING_SYNCING),
+                sync_batch_size(0),
+                sync_blocks_per_second(0),
                 transaction_fetching_inhibited_until(fc::time_point::min()),
                 last_known_fork_block_number(0),
                 firewall_check_state(nullptr)
@@ -361,6 +361,7 @@ namespace golos {
             wrong_position_marker_was_read,
             append_index_file_at_wrong_position,
             reading_data_beyond_end_of_file,
+            decompression_failed,
         };
     };
 
@@ -606,4 +607,5 @@ FC_REFLECT_ENUM(golos::database_corrupted::error_types,
         (wrong_position_marker_was_read)
         (append_index_file_at_wrong_position)
         (reading_data_beyond_end_of_file)
+        (decompression_failed)
 );
@@ -89,6 +89,14 @@ namespace golos { namespace protocol {
 
             flat_set<public_key_type> get_signature_keys(const chain_id_type &chain_id) const;
 
+            /**
+             * Recovers public keys from signatures and caches them in the transaction,
+             *   so next calls of get_signature_keys() and verify_authority() skip the ECC recovery.
+             * The cache is ignored if the transaction or its signatures were changed after the call.
+             * Does nothing if keys are already cached for the current transaction.
+             */
+            void precompute_signature_keys(const chain_id_type &chain_id) const;
+
             vector<signature_type> signatures;
 
             digest_type merkle_digest() const;
@@ -97,6 +105,11 @@ namespace golos { namespace protocol {
                 operations.clear();
                 signatures.clear();
             }
+
+        private:
+            struct signature_keys_cache;
+
+            mutable std::shared_ptr<const signature_keys_cache> _signature_keys_cache;
         };
 
         void verify_authority(const vector<operation> &ops, const flat_set<public_key_type> &sigs,
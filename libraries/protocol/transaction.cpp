@@ -235,17 +235,50 @@ namespace golos {
         } FC_CAPTURE_AND_RETHROW((ops)(sigs)) }
 
 
+        struct signed_transaction::signature_keys_cache final {
+            digest_type digest;
+            vector<signature_type> signatures;
+            flat_set<public_key_type> keys;
+        };
+
+        static flat_set<public_key_type> recover_signature_keys(
+            const vector<signature_type> &signatures, const digest_type &d
+        ) {
+            flat_set<public_key_type> result;
+            for (const auto &sig : signatures) {
+                GOLOS_ASSERT(
+                    result.insert(fc::ecc::public_key(sig, d)).second,
+                    tx_duplicate_sig,
+                    "Duplicate Signature detected");
+            }
+            return result;
+        }
+
         flat_set<public_key_type> signed_transaction::get_signature_keys(const chain_id_type &chain_id) const {
             try {
                 auto d = sig_digest(chain_id);
-                flat_set<public_key_type> result;
-                for (const auto &sig : signatures) {
-                    GOLOS_ASSERT(
-                        result.insert(fc::ecc::public_key(sig, d)).second,
-                        tx_duplicate_sig,
-                        "Duplicate Signature detected");
+                auto cache = _signature_keys_cache;
+                if (cache && cache->digest == d && cache->signatures == signatures) {
+                    return cache->keys;
                 }
-                return result;
+                return recover_signature_keys(signatures, d);
+            } FC_CAPTURE_AND_RETHROW()
+        }
+
+        void signed_transaction::precompute_signature_keys(const chain_id_type &chain_id) const {
+            try {
+                auto d = sig_digest(chain_id);
+                auto current = _signature_keys_cache;
+                if (current && current->digest == d && current->signatures == signatures) {
+                    // keys were already recovered, for example by the p2p node
+                    return;
+                }
+
+                auto cache = std::make_shared<signature_keys_cache>();
+                cache->digest = d;
+                cache->signatures = signatures;
+                cache->keys = recover_signature_keys(signatures, cache->digest);
+                _signature_keys_cache = std::move(cache);
             } FC_CAPTURE_AND_RETHROW()
         }
 
@@ -0,0 +1,347 @@
+#include <golos/plugins/account_history/cold_store.hpp>
+
+#include <fc/io/raw.hpp>
+#include <fc/log/logger.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <mutex>
+
+
+namespace golos { namespace plugins { namespace account_history {
+
+    namespace bfs = boost::filesystem;
+
+    namespace detail {
+
+        struct cold_account_head final {
+            uint64_t pos = cold_store::npos;
+            uint32_t sequence = 0;
+            uint32_t count = 0;
+            uint64_t checkpoint = cold_store::npos;
+        };
+
+        inline uint64_t make_pos(uint32_t segment, uint32_t offset) {
+            return (uint64_t(segment) << 32) | offset;
+        }
+
+        inline uint32_t pos_segment(uint64_t pos) {
+            return uint32_t(pos >> 32);
+        }
+
+        inline uint32_t pos_offset(uint64_t pos) {
+            return uint32_t(pos);
+        }
+
+    } // detail
+
+} } } // golos::plugins::account_history
+
+FC_REFLECT((golos::plugins::account_history::detail::cold_account_head),
+    (pos)(sequence)(count)(checkpoint))
+
+namespace golos { namespace plugins { namespace account_history {
+
+    using detail::cold_account_head;
+
+    struct cold_store::impl final {
+        bfs::path dir;
+        bool opened = false;
+        uint32_t last_block = 0;
+        uint32_t segment = 0;
+        uint32_t segment_size = 0;
+        mutable bool dirty = false;
+        mutable std::ofstream out;
+        std::map<account_name_type, cold_account_head> heads;
+        mutable std::mutex mutex;
+
+        bfs::path segment_path(uint32_t n) const {
+            char name[32];
+            std::snprintf(name, sizeof(name), "segment-%06u.dat", n);
+            return dir / name;
+        }
+
+        bfs::path heads_path() const {
+            return dir / "heads.dat";
+        }
+
+        void apply_head(const cold_history_record& record, uint64_t pos) {
+            auto& head = heads[record.account];
+            if (head.count % checkpoint_interval == 0) {
+                head.checkpoint = pos;
+            }
+            head.pos = pos;
+            head.sequence = record.sequence;
+            ++head.count;
+        }
+
+        void load_heads(uint64_t& end_pos) {
+            end_pos = 0;
+            if (!bfs::exists(heads_path())) {
+                return;
+            }
+
+            std::ifstream stream(heads_path().string(), std::ios::in|std::ios::binary);
+            std::vector<char> data((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+            try {
+                fc::datastream<const char*> ds(data.data(), data.size());
+                fc::raw::unpack(ds, last_block);
+                fc::raw::unpack(ds, end_pos);
+                fc::raw::unpack(ds, heads);
+            } catch (const fc::exception& e) {
+                wlog("Heads of account history cold store are corrupted, scanning all segments: ${e}",
+                    ("e", e.to_detail_string()));
+                last_block = 0;
+                end_pos = 0;
+                heads.clear();
+            }
+        }
+
+        void save_heads() const {
+            std::vector<char> data;
+            auto end_pos = detail::make_pos(segment, segment_size);
+            auto append = [&](const std::vector<char>& packed) {
+                data.insert(data.end(), packed.begin(), packed.end());
+            };
+            append(fc::raw::pack(last_block));
+            append(fc::raw::pack(end_pos));
+            append(fc::raw::pack(heads));
+
+            auto tmp_path = dir / "heads.dat.tmp";
+            {
+                std::ofstream stream(tmp_path.string(), std::ios::out|std::ios::binary|std::ios::trunc);
+                stream.write(data.data(), data.size());
+            }
+            bfs::rename(tmp_path, heads_path());
+        }
+
+        // reads records written after the save of heads, truncates the incomplete record
+        void scan(uint64_t end_pos) {
+            segment = detail::pos_segment(end_pos);
+            segment_size = detail::pos_offset(end_pos);
+            uint64_t scanned = 0;
+
+            for (auto n = segment; bfs::exists(segment_path(n)); ++n) {
+                auto path = segment_path(n);
+                uint64_t file_size = bfs::file_size(path);
+                uint32_t offset = (n == segment) ? segment_size : 0;
+
+                std::ifstream stream(path.string(), std::ios::in|std::ios::binary);
+                stream.seekg(offset);
+                while (offset < file_size) {
+                    uint32_t size = 0;
+                    std::vector<char> data;
+                    if (offset + sizeof(size) <= file_size) {
+                        stream.read(reinterpret_cast<char*>(&size), sizeof(size));
+                    }
+                    if (size == 0 || offset + sizeof(size) + size > file_size) {
+                        wlog("Truncating incomplete record of account history cold store in ${path} at ${offset}",
+                            ("path", path.string())("offset", offset));
+                        stream.close();
+                        bfs::resize_file(path, offset);
+                        break;
+                    }
+                    data.resize(size);
+                    stream.read(data.data(), size);
+
+                    auto record = fc::raw::unpack<cold_history_record>(data);
+                    apply_head(record, detail::make_pos(n, offset));
+                    last_block = std::max(last_block, record.op.block);
+                    offset += sizeof(size) + size;
+                    ++scanned;
+                }
+                segment = n;
+                segment_size = offset;
+            }
+
+            if (scanned) {
+                ilog("Scanned ${n} records of account history cold store", ("n", scanned));
+            }
+        }
+
+        void open_segment() {
+            out.close();
+            out.open(segment_path(segment).string(), std::ios::out|std::ios::binary|std::ios::app);
+            FC_ASSERT(out.good(), "Can't open segment ${path} of account history cold store",
+                ("path", segment_path(segment).string()));
+        }
+
+        void flush() const {
+            if (dirty) {
+                out.flush();
+                dirty = false;
+            }
+        }
+
+        cold_history_record read_record(std::map<uint32_t, std::ifstream>& streams, uint64_t pos) const {
+            auto n = detail::pos_segment(pos);
+            auto itr = streams.find(n);
+            if (itr == streams.end()) {
+                itr = streams.emplace(n, std::ifstream(segment_path(n).string(), std::ios::in|std::ios::binary)).first;
+            }
+            auto& stream = itr->second;
+
+            uint32_t size = 0;
+            stream.seekg(detail::pos_offset(pos));
+            stream.read(reinterpret_cast<char*>(&size), sizeof(size));
+            std::vector<char> data(size);
+            stream.read(data.data(), size);
+            FC_ASSERT(stream.good(), "Can't read record of account history cold store",
+                ("segment", n)("offset", detail::pos_offset(pos)));
+            return fc::raw::unpack<cold_history_record>(data);
+        }
+    };
+
+    cold_store::cold_store(): _impl(new impl()) {
+    }
+
+    cold_store::~cold_store() {
+        close();
+    }
+
+    void cold_store::open(const bfs::path& dir) {
+        std::lock_guard<std::mutex> lock(_impl->mutex);
+        FC_ASSERT(!_impl->opened, "Account history cold store is already opened");
+
+        _impl->dir = dir;
+        bfs::create_directories(dir);
+
+        uint64_t end_pos = 0;
+        _impl->load_heads(end_pos);
+        _impl->scan(end_pos);
+        _impl->open_segment();
+        _impl->opened = true;
+
+        ilog("Account history cold store opened in ${dir}: ${n} accounts, last block ${b}",
+            ("dir", dir.string())("n", _impl->heads.size())("b", _impl->last_block));
+    }
+
+    void cold_store::close() {
+        std::lock_guard<std::mutex> lock(_impl->mutex);
+        if (!_impl->opened) {
+            return;
+        }
+        _impl->flush();
+        _impl->out.close();
+        _impl->save_heads();
+        _impl->heads.clear();
+        _impl->opened = false;
+    }
+
+    bool cold_store::is_open() const {
+        return _impl->opened;
+    }
+
+    uint32_t cold_store::last_block() const {
+        std::lock_guard<std::mutex> lock(_impl->mutex);
+        return _impl->last_block;
+    }
+
+    void cold_store::set_last_block(uint32_t block) {
+        std::lock_guard<std::mutex> lock(_impl->mutex);
+        _impl->last_block = std::max(_impl->last_block, block);
+    }
+
+    fc::optional<uint32_t> cold_store::head_sequence(const account_name_type& account) const {
+        std::lock_guard<std::mutex> lock(_impl->mutex);
+        auto itr = _impl->heads.find(account);
+        if (itr == _impl->heads.end()) {
+            return {};
+        }
+        return itr->second.sequence;
+    }
+
+    bool cold_store::append(cold_history_record record) {
+        std::lock_guard<std::mutex> lock(_impl->mutex);
+        FC_ASSERT(_impl->opened, "Account history cold store isn't opened");
+
+        auto itr = _impl->heads.find(record.account);
+        if (itr != _impl->heads.end()) {
+            // can be after the pop of block, which restored the moved operations in shared memory
+            if (record.sequence <= itr->second.sequence) {
+                return false;
+            }
+            record.prev = itr->second.pos;
+            record.skip = itr->second.checkpoint;
+        } else {
+            record.prev = npos;
+            record.skip = npos;
+        }
+
+        auto data = fc::raw::pack(record);
+        auto size = static_cast<uint32_t>(data.size());
+        if (_impl->segment_size > 0 && uint64_t(_impl->segment_size) + sizeof(size) + size > max_segment_size) {
+            _impl->out.flush();
+            ++_impl->segment;
+            _impl->segment_size = 0;
+            _impl->open_segment();
+        }
+
+        auto pos = detail::make_pos(_impl->segment, _impl->segment_size);
+        _impl->out.write(reinterpret_cast<const char*>(&size), sizeof(size));
+        _impl->out.write(data.data(), size);
+        FC_ASSERT(_impl->out.good(), "Can't write to account history cold store");
+        _impl->segment_size += sizeof(size) + size;
+        _impl->dirty = true;
+
+        _impl->apply_head(record, pos);
+        return true;
+    }
+
+    void cold_store::flush() {
+        std::lock_guard<std::mutex> lock(_impl->mutex);
+        _impl->flush();
+    }
+
+    std::vector<cold_history_record> cold_store::read(
+        const account_name_type& account, uint32_t from, uint32_t limit, const filter_type& filter
+    ) const {
+        std::vector<cold_history_record> result;
+
+        std::lock_guard<std::mutex> lock(_impl->mutex);
+        auto itr = _impl->heads.find(account);
+        if (!_impl->opened || itr == _impl->heads.end() || limit == 0) {
+            return result;
+        }
+        _impl->flush();
+
+        std::map<uint32_t, std::ifstream> streams;
+        auto record = _impl->read_record(streams, itr->second.pos);
+
+        if (record.sequence > from) {
+            // jump over checkpoints to the nearest one, which is still not less than from
+            while (record.skip != npos) {
+                auto checkpoint = _impl->read_record(streams, record.skip);
+                if (checkpoint.sequence < from) {
+                    break;
+                }
+                record = std::move(checkpoint);
+            }
+            while (record.sequence > from && record.prev != npos) {
+                record = _impl->read_record(streams, record.prev);
+            }
+            if (record.sequence > from) {
+                return result;
+            }
+        }
+
+        while (true) {
+            auto prev = record.prev;
+            if (!filter || filter(record)) {
+                result.push_back(std::move(record));
+                if (result.size() >= limit) {
+                    break;
+                }
+            }
+            if (prev == npos) {
+                break;
+            }
+            record = _impl->read_record(streams, prev);
+        }
+        return result;
+    }
+
+} } } // golos::plugins::account_history
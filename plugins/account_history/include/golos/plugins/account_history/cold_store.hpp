@@ -0,0 +1,87 @@
+#pragma once
+
+#include <golos/plugins/account_history/history_object.hpp>
+#include <golos/plugins/operation_history/applied_operation.hpp>
+
+#include <boost/filesystem/path.hpp>
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+
+namespace golos { namespace plugins { namespace account_history {
+
+    /**
+     * Operation of account moved from shared memory to the cold store
+     */
+    struct cold_history_record final {
+        account_name_type account;
+        uint32_t sequence = 0;
+        uint8_t op_tag = 0;
+        operation_direction dir = operation_direction::any;
+        uint64_t prev = 0;  ///< position of the previous record of the account
+        uint64_t skip = 0;  ///< position of the previous checkpoint record of the account
+        operation_history::applied_operation op;
+    };
+
+    /**
+     * Append-only store of account operations on disk.
+     *
+     * Records are written to segment files. Each record points to the previous record of its account,
+     * and every checkpoint_interval'th record of the account is a checkpoint which also points
+     * to the previous checkpoint, so the search of sequence doesn't read all records of the account.
+     * Heads of accounts are kept in memory and saved on close, records written after the save
+     * are scanned on open.
+     */
+    class cold_store final {
+    public:
+        static constexpr uint64_t npos = uint64_t(-1);
+        static constexpr uint32_t checkpoint_interval = 256;
+        static constexpr uint32_t max_segment_size = 1u << 30;
+
+        using filter_type = std::function<bool (const cold_history_record&)>;
+
+        cold_store();
+
+        ~cold_store();
+
+        void open(const boost::filesystem::path& dir);
+
+        void close();
+
+        bool is_open() const;
+
+        /// The last block which operations are moved to the store
+        uint32_t last_block() const;
+
+        void set_last_block(uint32_t block);
+
+        /// The sequence of the last operation of account in the store
+        fc::optional<uint32_t> head_sequence(const account_name_type& account) const;
+
+        /**
+         * Appends the record, prev and skip are filled by the store.
+         * @return false if the store already has the record with this or greater sequence of the account
+         */
+        bool append(cold_history_record record);
+
+        void flush();
+
+        /**
+         * Reads up to limit records of account with sequence <= from, from the newest to the oldest.
+         * Records which don't pass the filter are skipped.
+         */
+        std::vector<cold_history_record> read(
+            const account_name_type& account, uint32_t from, uint32_t limit, const filter_type& filter = filter_type()
+        ) const;
+
+    private:
+        struct impl;
+        std::unique_ptr<impl> _impl;
+    };
+
+} } } // golos::plugins::account_history
+
+FC_REFLECT((golos::plugins::account_history::cold_history_record),
+    (account)(sequence)(op_tag)(dir)(prev)(skip)(op))
@@ -29,7 +29,8 @@
 namespace golos { namespace plugins { namespace account_history {
 
     enum account_object_types {
-        account_history_object_type = (ACCOUNT_HISTORY_SPACE_ID << 8)
+        account_history_object_type = (ACCOUNT_HISTORY_SPACE_ID << 8),
+        account_history_summary_object_type = (ACCOUNT_HISTORY_SPACE_ID << 8) + 1
     };
 
     enum operation_direction : uint8_t {
@@ -102,6 +103,56 @@ static_assert(protocol::operation::count() >= 0 && protocol::operation::count()
                 composite_key_compare<std::less<account_name_type>, std::greater<uint32_t>>>>,
         allocator<account_history_object>>;
 
+    /**
+     * Number of operations of account by their types and directions.
+     * Operations moved to the cold store are still counted, operations erased by history-blocks aren't.
+     */
+    class account_history_summary_object final:
+        public object<account_history_summary_object_type, account_history_summary_object> {
+    public:
+        template <typename Constructor, typename Allocator>
+        account_history_summary_object(Constructor&& c, allocator <Allocator> a) {
+            c(*this);
+        }
+
+        id_type id;
+
+        account_name_type account;
+        uint8_t op_tag;
+        operation_direction dir;
+        uint32_t count = 0;
+    };
+
+    using account_history_summary_id_type = object_id<account_history_summary_object>;
+
+    struct by_account_operation;
+    using account_history_summary_index = multi_index_container<
+        account_history_summary_object,
+        indexed_by<
+            ordered_unique<
+                tag<by_id>,
+                member<account_history_summary_object, account_history_summary_id_type, &account_history_summary_object::id>>,
+            ordered_unique<
+                tag<by_account_operation>,
+                composite_key<account_history_summary_object,
+                    member<account_history_summary_object, account_name_type, &account_history_summary_object::account>,
+                    member<account_history_summary_object, uint8_t, &account_history_summary_object::op_tag>,
+                    member<account_history_summary_object, operation_direction, &account_history_summary_object::dir>>,
+                composite_key_compare<std::less<account_name_type>, std::less<uint8_t>, std::less<uint8_t>>>>,
+        allocator<account_history_summary_object>>;
+
+    struct account_history_summary_item final {
+        std::string op;
+        operation_direction direction = operation_direction::any;
+        uint32_t count = 0;
+    };
+
+    struct account_history_summary final {
+        account_name_type account;
+        uint32_t total = 0;
+        std::vector<account_history_summary_item> operations;
+    };
+
 } } } // golos::plugins::account_history
 
 FC_REFLECT_ENUM(golos::plugins::account_history::operation_direction, (any)(sender)(receiver)(dual))
@@ -112,3 +163,17 @@ FC_REFLECT((golos::plugins::account_history::account_history_query),
 CHAINBASE_SET_INDEX_TYPE(
     golos::plugins::account_history::account_history_object,
     golos::plugins::account_history::account_history_index)
+
+FC_REFLECT((golos::plugins::account_history::account_history_object),
+    (id)(account)(block)(sequence)(op_tag)(dir)(op))
+
+CHAINBASE_SET_INDEX_TYPE(
+    golos::plugins::account_history::account_history_summary_object,
+    golos::plugins::account_history::account_history_summary_index)
+
+FC_REFLECT((golos::plugins::account_history::account_history_summary_object),
+    (id)(account)(op_tag)(dir)(count))
+
+FC_REFLECT((golos::plugins::account_history::account_history_summary_item), (op)(direction)(count))
+
+FC_REFLECT((golos::plugins::account_history::account_history_summary), (account)(total)(operations))
@@ -43,6 +43,7 @@ namespace golos { namespace plugins { namespace account_history {
     using history_operations = std::map<uint32_t, applied_operation>;
 
     DEFINE_API_ARGS(get_account_history, msg_pack, history_operations)
+    DEFINE_API_ARGS(get_account_history_summary, msg_pack, account_history_summary)
 
    /**
     *  This plugin is designed to track a range of operations by account so that one node
@@ -87,6 +88,14 @@ namespace golos { namespace plugins { namespace account_history {
              *    }
              */
             (get_account_history)
+
+            /**
+             *  Returns numbers of operations of account by operation types and directions,
+             *  without reading of the history.
+             *
+             *  @param account - name of account
+             */
+            (get_account_history_summary)
         )
 
     private:
@@ -3,10 +3,12 @@
 #include <golos/protocol/exceptions.hpp>
 #include <golos/plugins/account_history/plugin.hpp>
 #include <golos/plugins/account_history/history_object.hpp>
+#include <golos/plugins/account_history/cold_store.hpp>
 #include <golos/plugins/operation_history/history_object.hpp>
 #include <golos/plugins/json_rpc/api_helper.hpp>
 
 #include <boost/algorithm/string.hpp>
+#include <boost/filesystem.hpp>
 #include <queue>
 
 #define ACCOUNT_HISTORY_MAX_LIMIT 10000
@@ -19,6 +21,7 @@ namespace golos { namespace plugins { namespace account_history {
 using namespace golos::protocol;
 using namespace golos::chain;
 namespace bpo = boost::program_options;
+namespace bfs = boost::filesystem;
 using impacted_accounts = fc::flat_map<golos::chain::account_name_type, operation_direction>;
 
 struct operation_visitor_filter;
@@ -47,10 +50,12 @@ if (options.count(name)) { \
     struct operation_visitor final {
         operation_visitor(
             golos::chain::database& db,
+            const cold_store& cold,
             const golos::chain::operation_notification& op_note,
             std::string op_account,
             operation_direction dir)
             : db(db),
+              cold(cold),
               note(op_note),
               account(op_account),
               dir(dir) {
@@ -59,6 +64,7 @@ if (options.count(name)) { \
         using result_type = void;
 
         golos::chain::database& db;
+        const cold_store& cold;
         const golos::chain::operation_notification& note;
         std::string account;
         operation_direction dir;
@@ -71,6 +77,12 @@ if (options.count(name)) { \
             uint32_t sequence = 0;
             if (itr != idx.end() && itr->account == account) {
                 sequence = itr->sequence + 1;
+            } else {
+                // all operations of account can be moved to the cold store
+                auto cold_sequence = cold.head_sequence(account);
+                if (cold_sequence) {
+                    sequence = *cold_sequence + 1;
+                }
             }
 
             db.create<account_history_object>([&](account_history_object& history) {
@@ -100,17 +112,81 @@ if (options.count(name)) { \
                 while (it != idx.end() && it->block <= need_block) {
                     auto next_it = it;
                     ++next_it;
+                    update_summary(it->account, it->op_tag, it->dir, -1);
                     db.remove(*it);
                     it = next_it;
                 }
             }
         }
 
+        void update_summary(const account_name_type& account, uint8_t op_tag, operation_direction dir, int32_t delta) {
+            const auto& idx = db.get_index<account_history_summary_index>().indices().get<by_account_operation>();
+            auto itr = idx.find(std::make_tuple(account, op_tag, dir));
+            if (itr == idx.end()) {
+                if (delta > 0) {
+                    db.create<account_history_summary_object>([&](account_history_summary_object& summary) {
+                        summary.account = account;
+                        summary.op_tag = op_tag;
+                        summary.dir = dir;
+                        summary.count = delta;
+                    });
+                }
+            } else if (int64_t(itr->count) + delta <= 0) {
+                db.remove(*itr);
+            } else {
+                db.modify(*itr, [&](account_history_summary_object& summary) {
+                    summary.count += delta;
+                });
+            }
+        }
+
+        void move_to_cold() {
+            uint32_t head_block = db.head_block_num();
+            if (cold_blocks > head_block) {
+                return;
+            }
+
+            // only irreversible blocks, because the cold store can't be reverted on the pop of block
+            uint32_t need_block = std::min(head_block - cold_blocks, db.last_non_undoable_block_num());
+            if (need_block <= cold.last_block()) {
+                return;
+            }
+
+            const auto& idx = db.get_index<account_history_index>().indices().get<by_location>();
+            auto it = idx.begin();
+            while (it != idx.end() && it->block <= need_block) {
+                auto next_it = it;
+                ++next_it;
+
+                const auto* op = db.find(it->op);
+                if (op != nullptr) {
+                    cold_history_record record;
+                    record.account = it->account;
+                    record.sequence = it->sequence;
+                    record.op_tag = it->op_tag;
+                    record.dir = it->dir;
+                    record.op = operation_history::applied_operation(*op);
+                    cold.append(std::move(record));
+                } else {
+                    wlog("Operation ${s} of ${a} is removed before moving to the cold store",
+                        ("s", it->sequence)("a", it->account));
+                }
+                db.remove(*it);
+                it = next_it;
+            }
+
+            cold.set_last_block(need_block);
+            cold.flush();
+        }
+
         void on_operation(const golos::chain::operation_notification& note) {
             if (!note.stored_in_db) {
                 return;
             }
 
+            // replaying of blocks, which operations are already in the cold store, only restores the summary
+            bool in_cold = cold.is_open() && note.block <= cold.last_block();
+
             impacted_accounts impacted;
             operation_get_impacted_accounts(note.op, impacted);
 
@@ -119,7 +195,10 @@ if (options.count(name)) { \
                 if (!tracked_accounts.size() ||
                     (itr != tracked_accounts.end() && itr->first <= item.first && item.first <= itr->second)
                 ) {
-                    note.op.visit(operation_visitor(db, note, item.first, item.second));
+                    if (!in_cold) {
+                        note.op.visit(operation_visitor(db, cold, note, item.first, item.second));
+                    }
+                    update_summary(item.first, note.op.which(), item.second, 1);
                 }
             }
         }
@@ -130,13 +209,37 @@ if (options.count(name)) { \
             history_operations result;
             const auto& idx = db.get_index<account_history_index>().indices().get<by_account>();
             auto itr = idx.lower_bound(std::make_tuple(account, from));
-            auto end = idx.upper_bound(std::make_tuple(account, std::max(int64_t(0), int64_t(itr->sequence) - limit)));
-            for (; itr != end; ++itr) {
-                result[itr->sequence] = db.get(itr->op);
+            if (itr != idx.end() && itr->account == account) {
+                auto end = idx.upper_bound(std::make_tuple(account, std::max(int64_t(0), int64_t(itr->sequence) - limit)));
+                for (; itr != end; ++itr) {
+                    result[itr->sequence] = db.get(itr->op);
+                }
             }
+            fetch_cold(account, from, limit, result);
             return result;
         }
 
+        // adds older operations from the cold store if shared memory has not enough of them
+        void fetch_cold(
+            const string& account, uint32_t from, uint32_t limit, history_operations& result,
+            const cold_store::filter_type& filter = cold_store::filter_type()
+        ) {
+            if (!cold.is_open() || result.size() > limit) {
+                return;
+            }
+            if (!result.empty()) {
+                if (result.begin()->first == 0) {
+                    return;
+                }
+                from = std::min(from, result.begin()->first - 1);
+            }
+
+            auto records = cold.read(account, from, limit + 1 - result.size(), filter);
+            for (auto& r: records) {
+                result.emplace(r.sequence, std::move(r.op));
+            }
+        }
+
         using op_tag_type = int;
         using op_tags = fc::flat_set<op_tag_type>;
         using op_names = fc::flat_set<std::string>;
@@ -211,17 +314,21 @@ if (options.count(name)) { \
             const auto& idx = db.get_index<account_history_index>().indices().get<by_operation>();
             const auto& end = idx.end();
 
-            auto put_itr = [&](op_tag_type o, operation_direction d, bool force = false) {
+            auto put_itr = [&](op_tag_type o, operation_direction d) {
+                bool force = d == operation_direction::dual && (dir == sender || dir == receiver);
                 if (force || operation_direction::any == dir || d == dir) {
                     auto i = sequenced_itr(idx, account, uint8_t(o), d, from);
                     if (i.itr != end && i.itr->op_tag == o && i.itr->dir == d)
                         itrs.push(i);
                 }
             };
-            for (const auto o: select_ops) {
-                put_itr(o, operation_direction::sender);
-                put_itr(o, operation_direction::receiver);
-                put_itr(o, operation_direction::dual, dir == sender || dir == receiver);
+            // only pairs of operation and direction, which the account has, are merged
+            const auto& summary_idx = db.get_index<account_history_summary_index>().indices().get<by_account_operation>();
+            auto summary_itr = summary_idx.lower_bound(std::make_tuple(account_name_type(account)));
+            for (; summary_itr != summary_idx.end() && summary_itr->account == account; ++summary_itr) {
+                if (select_ops.count(summary_itr->op_tag)) {
+                    put_itr(summary_itr->op_tag, summary_itr->dir);
+                }
             }
 
             history_operations result;
@@ -235,14 +342,39 @@ if (options.count(name)) { \
                 if (next.itr != end && next.itr->op_tag == o && next.itr->dir == d)
                     itrs.push(next);
             }
+
+            fetch_cold(account, from, limit, result, [&](const cold_history_record& r) {
+                bool dir_matches = operation_direction::any == dir || r.dir == dir ||
+                    (r.dir == operation_direction::dual && (dir == sender || dir == receiver));
+                return dir_matches && select_ops.count(r.op_tag);
+            });
+            return result;
+        }
+
+        account_history_summary get_account_history_summary(const account_name_type& account) {
+            account_history_summary result;
+            result.account = account;
+
+            const auto& idx = db.get_index<account_history_summary_index>().indices().get<by_account_operation>();
+            for (auto itr = idx.lower_bound(std::make_tuple(account)); itr != idx.end() && itr->account == account; ++itr) {
+                account_history_summary_item item;
+                item.op = op_tag2name.at(itr->op_tag);
+                item.direction = itr->dir;
+                item.count = itr->count;
+                result.total += item.count;
+                result.operations.push_back(std::move(item));
+            }
             return result;
         }
 
         op_tag_type virtual_op_tag = -1;                        // all operations >= this value are virtual
         fc::flat_map<std::string, op_tag_type> op_name2tag;
+        std::vector<std::string> op_tag2name;
         fc::flat_map<std::string, std::string> tracked_accounts;
         golos::chain::database& db;
         uint32_t history_blocks = UINT32_MAX;
+        uint32_t cold_blocks = UINT32_MAX;
+        cold_store cold;
     };
 
     DEFINE_API(plugin, get_account_history) {
@@ -257,6 +389,15 @@ if (options.count(name)) { \
         });
     }
 
+    DEFINE_API(plugin, get_account_history_summary) {
+        PLUGIN_API_VALIDATE_ARGS(
+            (account_name_type, account)
+        );
+        return pimpl->db.with_weak_read_lock([&]() {
+            return pimpl->get_account_history_summary(account);
+        });
+    }
+
     struct get_impacted_account_visitor final {
         impacted_accounts& impacted;
 
@@ -524,6 +665,17 @@ if (options.count(name)) { \
             bpo::value<std::vector<std::string>>()->composing(),
             "Defines a individual account to track (in addition to ranges). "
             "Can be specified multiple times"
+        )
+        (
+            "history-cold-blocks",
+            bpo::value<uint32_t>(),
+            "Defines depth of history of accounts in shared memory, "
+            "older operations are moved to the cold store on disk (should be less than history-blocks)"
+        )
+        (
+            "history-cold-dir",
+            bpo::value<bfs::path>()->default_value("account_history"),
+            "the location of the cold store of account history (absolute path or relative to application data dir)"
         );
         cfg.add(cli);
     }
@@ -533,22 +685,44 @@ if (options.count(name)) { \
         pimpl = std::make_unique<plugin_impl>();
 
         if (options.count("history-blocks")) {
-            uint32_t history_blocks = options.at("history-blocks").as<uint32_t>();
-            pimpl->history_blocks = history_blocks;
-            pimpl->db.applied_block.connect([&](const signed_block& block){
-                pimpl->erase_old_blocks();
-            });
+            pimpl->history_blocks = options.at("history-blocks").as<uint32_t>();
         } else {
             pimpl->history_blocks = UINT32_MAX;
         }
         ilog("account_history: history-blocks ${s}", ("s", pimpl->history_blocks));
 
+        if (options.count("history-cold-blocks")) {
+            pimpl->cold_blocks = options.at("history-cold-blocks").as<uint32_t>();
+            // operations should be moved before operation_history removes them
+            GOLOS_CHECK_OPTION(pimpl->history_blocks == UINT32_MAX || pimpl->cold_blocks < pimpl->history_blocks,
+                "history-cold-blocks should be less than history-blocks");
+
+            auto cold_dir = options.at("history-cold-dir").as<bfs::path>();
+            if (cold_dir.is_relative()) {
+                cold_dir = appbase::app().data_dir() / cold_dir;
+            }
+            pimpl->cold.open(cold_dir);
+            ilog("account_history: history-cold-blocks ${s}", ("s", pimpl->cold_blocks));
+        }
+
+        if (pimpl->history_blocks != UINT32_MAX || pimpl->cold.is_open()) {
+            pimpl->db.applied_block.connect([&](const signed_block& block){
+                if (pimpl->cold.is_open()) {
+                    pimpl->move_to_cold();
+                }
+                if (pimpl->history_blocks != UINT32_MAX) {
+                    pimpl->erase_old_blocks();
+                }
+            });
+        }
+
         // this is worked, because the appbase initialize required plugins at first
         pimpl->db.pre_apply_operation.connect([&](operation_notification& note) {
             pimpl->on_operation(note);
         });
 
         add_plugin_index<account_history_index>(pimpl->db);
+        add_plugin_index<account_history_summary_index>(pimpl->db);
 
         using pairstring = std::pair<std::string, std::string>;
         fc::flat_map<std::string, std::string> ranges;
@@ -590,6 +764,7 @@ if (options.count(name)) { \
             pimpl->op_name2tag[name] = i;
             name = name.substr(0, name.size() + 1 - sizeof("_operation"));  // support names without "_operation" too
             pimpl->op_name2tag[name] = i;
+            pimpl->op_tag2name.push_back(name);
             if (pimpl->virtual_op_tag == -1 && is_virtual_operation(op)) {
                 pimpl->virtual_op_tag = i;
             }
@@ -614,6 +789,7 @@ if (options.count(name)) { \
     }
 
     void plugin::plugin_shutdown() {
+        pimpl->cold.close();
     }
 
     fc::flat_map<std::string, std::string> plugin::tracked_accounts() const {
@@ -0,0 +1,205 @@
+#include <golos/plugins/chain/block_notify.hpp>
+
+#include <fc/io/raw.hpp>
+#include <fc/log/logger.hpp>
+
+#include <boost/filesystem.hpp>
+
+namespace golos { namespace plugins { namespace chain {
+
+    namespace ba = boost::asio;
+    using local_protocol = ba::local::stream_protocol;
+
+    block_notify_server::block_notify_server(ba::io_service& ios, const std::string& path, uint32_t max_queue_size)
+        : _ios(ios),
+          _path(path),
+          _max_queue_size(max_queue_size),
+          _acceptor(ios) {
+    }
+
+    block_notify_server::~block_notify_server() {
+        stop();
+    }
+
+    void block_notify_server::start() {
+        // socket file is left if the node was killed
+        boost::filesystem::remove(_path);
+
+        local_protocol::endpoint endpoint(_path);
+        _acceptor.open(endpoint.protocol());
+        _acceptor.bind(endpoint);
+        _acceptor.listen();
+
+        ilog("Sending applied blocks to read-only nodes through ${path}", ("path", _path));
+        accept();
+    }
+
+    void block_notify_server::stop() {
+        if (!_acceptor.is_open()) {
+            return;
+        }
+
+        boost::system::error_code ec;
+        _acceptor.close(ec);
+        for (auto& s: _sessions) {
+            s->socket.close(ec);
+        }
+        _sessions.clear();
+        boost::filesystem::remove(_path, ec);
+    }
+
+    void block_notify_server::accept() {
+        auto s = std::make_shared<session>(_ios);
+        _acceptor.async_accept(s->socket, [this, s](const boost::system::error_code& ec) {
+            if (ec == ba::error::operation_aborted) {
+                return;
+            }
+            if (ec) {
+                wlog("Can't accept read-only node: ${e}", ("e", ec.message()));
+            } else {
+                ilog("Read-only node connected");
+                _sessions.insert(s);
+            }
+            accept();
+        });
+    }
+
+    void block_notify_server::notify(const protocol::signed_block& block) {
+        auto size = static_cast<uint32_t>(fc::raw::pack_size(block));
+        auto data = std::make_shared<std::vector<char>>(sizeof(size) + size);
+        fc::datastream<char*> ds(data->data(), data->size());
+        fc::raw::pack(ds, size);
+        fc::raw::pack(ds, block);
+
+        message_ptr message = std::move(data);
+        _ios.post([this, message]() {
+            // copy, because close() removes sessions
+            auto sessions = _sessions;
+            for (auto& s: sessions) {
+                if (s->queue.size() >= _max_queue_size) {
+                    wlog("Read-only node doesn't read blocks, disconnect it");
+                    close(s);
+                    continue;
+                }
+                s->queue.push_back(message);
+                if (s->queue.size() == 1) {
+                    write(s);
+                }
+            }
+        });
+    }
+
+    void block_notify_server::write(const session_ptr& s) {
+        const auto& message = s->queue.front();
+        ba::async_write(s->socket, ba::buffer(*message), [this, s](const boost::system::error_code& ec, std::size_t) {
+            if (ec) {
+                if (ec != ba::error::operation_aborted) {
+                    ilog("Read-only node disconnected: ${e}", ("e", ec.message()));
+                    close(s);
+                }
+                return;
+            }
+            s->queue.pop_front();
+            if (!s->queue.empty()) {
+                write(s);
+            }
+        });
+    }
+
+    void block_notify_server::close(const session_ptr& s) {
+        boost::system::error_code ec;
+        s->socket.close(ec);
+        s->queue.clear();
+        _sessions.erase(s);
+    }
+
+    block_notify_client::block_notify_client(ba::io_service& ios, const std::string& path, handler_type handler)
+        : _ios(ios),
+          _path(path),
+          _handler(std::move(handler)),
+          _socket(ios),
+          _timer(ios) {
+    }
+
+    block_notify_client::~block_notify_client() {
+        stop();
+    }
+
+    void block_notify_client::start() {
+        _stopped = false;
+        connect();
+    }
+
+    void block_notify_client::stop() {
+        _stopped = true;
+        boost::system::error_code ec;
+        _timer.cancel(ec);
+        _socket.close(ec);
+    }
+
+    void block_notify_client::connect() {
+        _socket.async_connect(local_protocol::endpoint(_path), [this](const boost::system::error_code& ec) {
+            if (_stopped) {
+                return;
+            }
+            if (ec) {
+                wlog("Can't connect to primary node through ${path}: ${e}", ("path", _path)("e", ec.message()));
+                reconnect();
+                return;
+            }
+            ilog("Connected to primary node through ${path}", ("path", _path));
+            read_size();
+        });
+    }
+
+    void block_notify_client::reconnect() {
+        boost::system::error_code ec;
+        _socket.close(ec);
+        _timer.expires_from_now(boost::posix_time::seconds(1));
+        _timer.async_wait([this](const boost::system::error_code& ec) {
+            if (!ec && !_stopped) {
+                connect();
+            }
+        });
+    }
+
+    void block_notify_client::read_size() {
+        ba::async_read(_socket, ba::buffer(&_size, sizeof(_size)), [this](const boost::system::error_code& ec, std::size_t) {
+            if (_stopped) {
+                return;
+            }
+            if (ec) {
+                wlog("Disconnected from primary node: ${e}", ("e", ec.message()));
+                reconnect();
+                return;
+            }
+            if (_size > STEEMIT_MAX_BLOCK_SIZE) {
+                wlog("Primary node sent too big block (${s} bytes)", ("s", _size));
+                reconnect();
+                return;
+            }
+            _buffer.resize(_size);
+            read_block();
+        });
+    }
+
+    void block_notify_client::read_block() {
+        ba::async_read(_socket, ba::buffer(_buffer), [this](const boost::system::error_code& ec, std::size_t) {
+            if (_stopped) {
+                return;
+            }
+            if (ec) {
+                wlog("Disconnected from primary node: ${e}", ("e", ec.message()));
+                reconnect();
+                return;
+            }
+            try {
+                _handler(fc::raw::unpack<protocol::signed_block>(_buffer));
+            } catch (const fc::exception& e) {
+                wlog("Error on processing block from primary node: ${e}", ("e", e.to_detail_string()));
+            }
+            read_size();
+        });
+    }
+
+} } } // golos::plugins::chain
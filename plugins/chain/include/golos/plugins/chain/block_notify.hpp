@@ -0,0 +1,95 @@
+#pragma once
+
+#include <golos/protocol/block.hpp>
+
+#include <boost/asio.hpp>
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace golos { namespace plugins { namespace chain {
+
+    /**
+     * Sends applied blocks of the node to read-only nodes on the same host through a local socket.
+     * Each message is the size of the packed block (uint32_t) followed by the packed block.
+     *
+     * All work is done in the io_service, so notify() can be called from any thread.
+     */
+    class block_notify_server final {
+    public:
+        block_notify_server(boost::asio::io_service& ios, const std::string& path, uint32_t max_queue_size);
+
+        ~block_notify_server();
+
+        void start();
+
+        void stop();
+
+        void notify(const protocol::signed_block& block);
+
+    private:
+        using message_ptr = std::shared_ptr<const std::vector<char>>;
+
+        struct session final {
+            explicit session(boost::asio::io_service& ios): socket(ios) {
+            }
+
+            boost::asio::local::stream_protocol::socket socket;
+            std::deque<message_ptr> queue;
+        };
+
+        using session_ptr = std::shared_ptr<session>;
+
+        void accept();
+
+        void write(const session_ptr& s);
+
+        void close(const session_ptr& s);
+
+        boost::asio::io_service& _ios;
+        const std::string _path;
+        const uint32_t _max_queue_size;
+        boost::asio::local::stream_protocol::acceptor _acceptor;
+        std::set<session_ptr> _sessions;
+    };
+
+    /**
+     * Receives applied blocks from block_notify_server of the primary node,
+     * reconnects if the primary node is restarted.
+     */
+    class block_notify_client final {
+    public:
+        using handler_type = std::function<void (const protocol::signed_block&)>;
+
+        block_notify_client(boost::asio::io_service& ios, const std::string& path, handler_type handler);
+
+        ~block_notify_client();
+
+        void start();
+
+        void stop();
+
+    private:
+        void connect();
+
+        void reconnect();
+
+        void read_size();
+
+        void read_block();
+
+        boost::asio::io_service& _ios;
+        const std::string _path;
+        handler_type _handler;
+        boost::asio::local::stream_protocol::socket _socket;
+        boost::asio::deadline_timer _timer;
+        uint32_t _size = 0;
+        std::vector<char> _buffer;
+        bool _stopped = false;
+    };
+
+} } } // golos::plugins::chain
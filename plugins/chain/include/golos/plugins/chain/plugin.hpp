@@ -47,6 +47,13 @@ namespace golos { namespace plugins { namespace chain {
 
                 void check_time_in_block(const protocol::signed_block &block);
 
+                // The node opens shared memory of other (primary) node in read-only mode and only serves API
+                bool read_only() const;
+
+                // Signal about applied blocks for API plugins:
+                // applied_block of database or followed_block on read-only node
+                boost::signals2::signal<void(const protocol::signed_block &)> &block_applied_signal();
+
                 template<typename MultiIndexType>
                 bool has_index() const {
                     return db().has_index<MultiIndexType>();
@@ -87,6 +94,10 @@ namespace golos { namespace plugins { namespace chain {
                 // This is to synchronize plugins that have the chain plugin as an optional dependency.
                 boost::signals2::signal<void()> on_sync;
 
+                // Emitted on read-only node when the primary node applies a block.
+                // applied_block of database isn't emitted on read-only node, because plugins write to state on it.
+                boost::signals2::signal<void(const protocol::signed_block &)> followed_block;
+
             private:
                 class impl;
                 std::unique_ptr<impl> my;
@@ -1,4 +1,5 @@
 #include <golos/plugins/chain/plugin.hpp>
+#include <golos/plugins/chain/block_notify.hpp>
 #include <golos/chain/database_exceptions.hpp>
 #include <golos/chain/comment_object.hpp>
 #include <golos/protocol/protocol.hpp>
@@ -7,8 +8,11 @@
 #include <fc/io/json.hpp>
 #include <fc/string.hpp>
 
+#include <boost/thread/thread.hpp>
+
 #include <iostream>
 #include <future>
+#include <mutex>
 
 namespace golos { namespace plugins { namespace chain {
 
@@ -26,7 +30,14 @@ namespace golos { namespace plugins { namespace chain {
         bool force_replay = false;
         bool resync = false;
         bool readonly = false;
+        bfs::path block_notify_socket;
+        uint32_t block_notify_queue_size = 1000;
+        bfs::path primary_notify_socket;
+        uint64_t opened_shared_memory_size = 0;
+        std::unique_ptr<block_notify_server> notify_server;
+        std::unique_ptr<block_notify_client> notify_client;
         bool check_locks = false;
+        bool lock_stats = false;
         bool validate_invariants = false;
         uint32_t flush_interval = 0;
         flat_map<uint32_t, block_id_type> loaded_checkpoints;
@@ -48,10 +59,24 @@ namespace golos { namespace plugins { namespace chain {
 
         uint32_t block_num_check_free_size = 0;
 
+        uint32_t replay_threads = 0;
+        uint32_t replay_queue_size = 1000;
+
+        bfs::path snapshot_load_file;
+        bfs::path snapshot_write_file;
+        uint32_t snapshot_write_block_num = 0;
+        uint32_t snapshot_threads = 4;
+
         bool skip_virtual_ops = false;
 
         golos::chain::database db;
 
+        uint32_t signature_recovery_threads = 0;
+        boost::asio::io_service signature_recovery_ios;
+        std::unique_ptr<boost::asio::io_service::work> signature_recovery_work;
+        boost::thread_group signature_recovery_pool;
+        std::mutex signature_recovery_mutex; // tasks aren't posted after the stop
+
         bool single_write_thread = false;
 
         golos::chain::database::store_metadata_modes store_account_metadata;
@@ -72,6 +97,10 @@ namespace golos { namespace plugins { namespace chain {
             return appbase::app().get_io_service();
         }
 
+        void start_signature_recovery();
+        void stop_signature_recovery();
+        void recover_block_signatures(const protocol::signed_block& block);
+
         void check_time_in_block(const protocol::signed_block& block);
         bool accept_block(const protocol::signed_block& block, bool currently_syncing, uint32_t skip);
         void accept_transaction(const protocol::signed_transaction& trx);
@@ -79,6 +108,8 @@ namespace golos { namespace plugins { namespace chain {
         void replay_db(const bfs::path& data_dir, bool force_replay);
 
         void on_block (const protocol::signed_block& b);
+        void open_read_only(const bfs::path& data_dir);
+        void on_followed_block(plugin& self, const protocol::signed_block& b);
     };
 
 
@@ -93,10 +124,40 @@ namespace golos { namespace plugins { namespace chain {
         while (itr != idx.end() && itr->num_changes == -1 && (del_any || now - itr->last_update > fc::seconds(ttl))) {
             const auto& vote = *itr;
             ++itr;
+            const auto* comment = db.find(vote.comment);
+            if (comment != nullptr) {
+                db.modify(*comment, [&](golos::chain::comment_object& c) {
+                    c.vote_count--;
+                });
+            }
             db.remove(vote);
         }
     }
 
+    void plugin::impl::open_read_only(const bfs::path& data_dir) {
+        auto shared_memory_file = shared_memory_dir / "shared_memory.bin";
+        GOLOS_CHECK_VALUE(bfs::exists(shared_memory_file),
+            "Read-only node requires shared memory of primary node",
+            ("path", shared_memory_file.string()));
+
+        ilog("Opening shared memory from ${path} in read-only mode", ("path", shared_memory_dir.generic_string()));
+        db.open(data_dir, shared_memory_dir, STEEMIT_INIT_SUPPLY, 0, chainbase::database::read_only);
+        opened_shared_memory_size = bfs::file_size(shared_memory_file);
+    }
+
+    void plugin::impl::on_followed_block(plugin& self, const protocol::signed_block& b) {
+        // primary node remaps the file on resizing, the mapping of this node doesn't see new pages
+        auto size = bfs::file_size(shared_memory_dir / "shared_memory.bin");
+        if (size != opened_shared_memory_size) {
+            elog("Shared memory was resized by primary node from ${o} to ${n} bytes, restart read-only node",
+                ("o", opened_shared_memory_size)("n", size));
+            appbase::app().quit();
+            return;
+        }
+
+        self.followed_block(b);
+    }
+
     void plugin::impl::check_time_in_block(const protocol::signed_block& block) {
         time_point_sec now = fc::time_point::now();
 
@@ -108,14 +169,81 @@ namespace golos { namespace plugins { namespace chain {
                 ("max_accept_time", max_accept_time));
     }
 
+    void plugin::impl::start_signature_recovery() {
+        if (!signature_recovery_threads) {
+            return;
+        }
+
+        ilog("Starting ${n} threads for recovering of signatures", ("n", signature_recovery_threads));
+        signature_recovery_work = std::make_unique<boost::asio::io_service::work>(signature_recovery_ios);
+        for (uint32_t i = 0; i < signature_recovery_threads; ++i) {
+            signature_recovery_pool.create_thread([this]() {
+                signature_recovery_ios.run();
+            });
+        }
+    }
+
+    void plugin::impl::stop_signature_recovery() {
+        {
+            std::lock_guard<std::mutex> lock(signature_recovery_mutex);
+            if (!signature_recovery_work) {
+                return;
+            }
+            signature_recovery_work.reset();
+        }
+        // ios isn't stopped: threads run already posted tasks, which set promises of waiters, and exit
+        signature_recovery_pool.join_all();
+    }
+
+    void plugin::impl::recover_block_signatures(const protocol::signed_block& block) {
+        const auto& trxs = block.transactions;
+        if (trxs.empty()) {
+            return;
+        }
+
+        auto chunks = std::min<size_t>(signature_recovery_threads, trxs.size());
+        std::vector<std::promise<void>> promises(chunks);
+
+        std::unique_lock<std::mutex> lock(signature_recovery_mutex);
+        if (!signature_recovery_work) {
+            return;
+        }
+        for (size_t c = 0; c < chunks; ++c) {
+            signature_recovery_ios.post([&, c]() {
+                for (size_t i = c; i < trxs.size(); i += chunks) {
+                    try {
+                        trxs[i].precompute_signature_keys(STEEMIT_CHAIN_ID);
+                    } catch (...) {
+                        // the error will be thrown again on applying of the transaction
+                    }
+                }
+                promises[c].set_value();
+            });
+        }
+        lock.unlock();
+
+        for (auto& promise: promises) {
+            promise.get_future().wait();
+        }
+    }
+
     bool plugin::impl::accept_block(const protocol::signed_block& block, bool currently_syncing, uint32_t skip) {
+        FC_ASSERT(!readonly, "Read-only node can't accept blocks");
+
         if (currently_syncing && block.block_num() % 10000 == 0) {
             ilog("Syncing Blockchain --- Got block: #${n} time: ${t} producer: ${p}",
                 ("t", block.timestamp)("n", block.block_num())("p", block.witness));
         }
 
+        golos::chain::lock_stats::context_guard lock_context("push_block");
+
         check_time_in_block(block);
 
+        // recover keys before taking of the write lock, they are cached in transactions
+        if (!(skip & (golos::chain::database::skip_transaction_signatures | golos::chain::database::skip_authority_check))) {
+            recover_block_signatures(block);
+        }
+
         skip = db.validate_block(block, skip);
 
         if (single_write_thread) {
@@ -161,6 +289,9 @@ namespace golos { namespace plugins { namespace chain {
     };
 
     void plugin::impl::accept_transaction(const protocol::signed_transaction& trx) {
+        FC_ASSERT(!readonly, "Read-only node can't accept transactions");
+
+        golos::chain::lock_stats::context_guard lock_context("push_transaction");
         uint32_t skip = db.validate_transaction(trx, db.skip_apply_transaction);
 
         if (single_write_thread) {
@@ -212,6 +343,44 @@ namespace golos { namespace plugins { namespace chain {
             ) (
                 "block-num-check-free-size", bpo::value<uint32_t>()->default_value(1000),
                 "Check free space in shared memory each N blocks. Default: 1000 (each 3000 seconds)."
+            ) (
+                "signature-recovery-threads", bpo::value<uint32_t>()->default_value(0),
+                "Number of threads which recover public keys from transaction signatures of a block "
+                "before applying it. Makes p2p-force-validate cheaper. Default: 0 (keys are recovered on applying)."
+            ) (
+                "replay-threads", bpo::value<uint32_t>()->default_value(0),
+                "Number of threads which read and unpack blocks from block log ahead of applying on replay. "
+                "Default: 0 (blocks are read in the applying thread)."
+            ) (
+                "replay-queue-size", bpo::value<uint32_t>()->default_value(1000),
+                "Maximum number of blocks read ahead of applying on replay (see replay-threads). Default: 1000"
+            ) (
+                "snapshot-load", bpo::value<bfs::path>(),
+                "State snapshot to start from if there is no shared memory file yet (absolute path or relative "
+                "to application data dir). Blocks after the snapshot are replayed from block log."
+            ) (
+                "snapshot-write-at-block", bpo::value<uint32_t>()->default_value(0),
+                "Write state snapshot after applying the block with this number, the block should be irreversible "
+                "(e.g. written on replay). Default: 0 (don't write)"
+            ) (
+                "snapshot-write-file", bpo::value<bfs::path>()->default_value("snapshot.bin"),
+                "File to write state snapshot (absolute path or relative to application data dir)"
+            ) (
+                "snapshot-threads", bpo::value<uint32_t>()->default_value(4),
+                "Number of threads which write and load indexes of state snapshot. Default: 4"
+            ) (
+                "read-only", bpo::value<bool>()->default_value(false),
+                "Open shared memory of other (primary) node in read-only mode and only serve API. "
+                "Set shared-file-dir to the directory of primary node. Default: false"
+            ) (
+                "primary-notify-socket", bpo::value<bfs::path>(),
+                "Local socket of primary node (see block-notify-socket) to receive applied blocks on read-only node"
+            ) (
+                "block-notify-socket", bpo::value<bfs::path>(),
+                "Local socket to send applied blocks to read-only nodes (absolute path or relative to application data dir)"
+            ) (
+                "block-notify-queue-size", bpo::value<uint32_t>()->default_value(1000),
+                "Maximum number of blocks queued for read-only node, it is disconnected on overflow. Default: 1000"
             ) (
                 "checkpoint", bpo::value<std::vector<std::string>>()->composing(),
                 "Pairs of [BLOCK_NUM,BLOCK_ID] that should be enforced as checkpoints."
@@ -230,6 +399,9 @@ namespace golos { namespace plugins { namespace chain {
             ) (
                 "max-write-wait-retries", bpo::value<uint32_t>(),
                 "maximum number of retries to get write lock"
+            ) (
+                "lock-stats", bpo::value<bool>()->default_value(false),
+                "Collect wait and hold times of database locks by API methods (see get_lock_stats). Default: false"
             ) (
                 "single-write-thread", bpo::value<bool>()->default_value(false),
                 "push blocks and transactions from one thread"
@@ -311,6 +483,7 @@ namespace golos { namespace plugins { namespace chain {
         }
 
         my->single_write_thread = options.at("single-write-thread").as<bool>();
+        my->lock_stats = options.at("lock-stats").as<bool>();
 
         my->enable_plugins_on_push_transaction = options.at("enable-plugins-on-push-transaction").as<bool>();
 
@@ -325,6 +498,39 @@ namespace golos { namespace plugins { namespace chain {
             my->block_num_check_free_size = options.at("block-num-check-free-size").as<uint32_t>();
         }
 
+        my->signature_recovery_threads = options.at("signature-recovery-threads").as<uint32_t>();
+
+        my->replay_threads = options.at("replay-threads").as<uint32_t>();
+        my->replay_queue_size = options.at("replay-queue-size").as<uint32_t>();
+
+        if (options.count("snapshot-load")) {
+            my->snapshot_load_file = options.at("snapshot-load").as<bfs::path>();
+            if (my->snapshot_load_file.is_relative()) {
+                my->snapshot_load_file = appbase::app().data_dir() / my->snapshot_load_file;
+            }
+        }
+        my->snapshot_write_block_num = options.at("snapshot-write-at-block").as<uint32_t>();
+        my->snapshot_write_file = options.at("snapshot-write-file").as<bfs::path>();
+        if (my->snapshot_write_file.is_relative()) {
+            my->snapshot_write_file = appbase::app().data_dir() / my->snapshot_write_file;
+        }
+        my->snapshot_threads = options.at("snapshot-threads").as<uint32_t>();
+
+        auto data_path = [](bfs::path path) {
+            if (path.is_relative()) {
+                path = appbase::app().data_dir() / path;
+            }
+            return path;
+        };
+        my->readonly = options.at("read-only").as<bool>();
+        if (options.count("primary-notify-socket")) {
+            my->primary_notify_socket = data_path(options.at("primary-notify-socket").as<bfs::path>());
+        }
+        if (options.count("block-notify-socket")) {
+            my->block_notify_socket = data_path(options.at("block-notify-socket").as<bfs::path>());
+        }
+        my->block_notify_queue_size = options.at("block-notify-queue-size").as<uint32_t>();
+
         my->replay = options.at("replay-blockchain").as<bool>();
         my->replay_if_corrupted = options.at("replay-if-corrupted").as<bool>();
         my->force_replay = options.at("force-replay-blockchain").as<bool>();
@@ -373,7 +579,7 @@ namespace golos { namespace plugins { namespace chain {
 
         auto data_dir = appbase::app().data_dir() / "blockchain";
 
-        if (my->resync) {
+        if (my->resync && !my->readonly) {
             wlog("resync requested: deleting block log and shared memory");
             my->db.wipe(data_dir, my->shared_memory_dir, true);
         }
@@ -381,6 +587,7 @@ namespace golos { namespace plugins { namespace chain {
         my->db.set_flush_interval(my->flush_interval);
         my->db.add_checkpoints(my->loaded_checkpoints);
         my->db.set_require_locking(my->check_locks);
+        my->db.get_lock_stats().enable(my->lock_stats);
 
         my->db.set_read_wait_micro(my->read_wait_micro);
         my->db.set_max_read_wait_retries(my->max_read_wait_retries);
@@ -401,12 +608,69 @@ namespace golos { namespace plugins { namespace chain {
             my->db.set_skip_virtual_ops();
         }
 
+        auto& response_cache = appbase::app().get_plugin<json_rpc::plugin>().get_response_cache();
+        if (response_cache.enabled()) {
+            // cached results of API methods are valid till the next block
+            block_applied_signal().connect([&response_cache](const protocol::signed_block&) {
+                response_cache.on_block();
+            });
+        }
+
         if (my->block_num_check_free_size) {
             my->db.set_block_num_check_free_size(my->block_num_check_free_size);
         }
 
+        my->db.set_replay_threads(my->replay_threads);
+        my->db.set_replay_queue_size(my->replay_queue_size);
+
+        my->db.set_snapshot_threads(my->snapshot_threads);
+        if (!my->snapshot_load_file.empty()) {
+            if (bfs::exists(my->shared_memory_dir / "shared_memory.bin")) {
+                ilog("Shared memory already exists, skip loading of snapshot ${file}",
+                    ("file", my->snapshot_load_file.string()));
+            } else {
+                my->db.set_snapshot_file(my->snapshot_load_file);
+            }
+        }
+
+        if (my->snapshot_write_block_num) {
+            // connected after plugins, so their indexes are already updated by the block
+            my->db.applied_block.connect([this](const protocol::signed_block& b) {
+                if (b.block_num() != my->snapshot_write_block_num) {
+                    return;
+                }
+                // state of a reversible block can be undone, so the snapshot is written only
+                // for blocks which are already in block log (replay) or irreversible
+                auto log_head = my->db.get_block_log().head();
+                auto log_head_num = log_head ? log_head->block_num() : 0;
+                if (b.block_num() > std::max(log_head_num, my->db.last_non_undoable_block_num())) {
+                    wlog("Block ${n} isn't irreversible yet, skip writing of state snapshot",
+                        ("n", b.block_num()));
+                    return;
+                }
+                my->db.write_snapshot(my->snapshot_write_file);
+            });
+        }
+
         my->db.enable_plugins_on_push_transaction(my->enable_plugins_on_push_transaction);
 
+        if (my->readonly) {
+            my->open_read_only(data_dir);
+
+            if (!my->primary_notify_socket.empty()) {
+                my->notify_client = std::make_unique<block_notify_client>(
+                    my->io_service(), my->primary_notify_socket.string(),
+                    [this](const protocol::signed_block& b) {
+                        my->on_followed_block(*this, b);
+                    });
+                my->notify_client->start();
+            }
+
+            ilog("Started read-only node on blockchain with ${n} blocks", ("n", my->db.head_block_num()));
+            on_sync();
+            return;
+        }
+
         try {
             ilog("Opening shared memory from ${path}", ("path", my->shared_memory_dir.generic_string()));
             my->db.open(data_dir, my->shared_memory_dir, STEEMIT_INIT_SUPPLY, my->shared_memory_size, chainbase::database::read_write/*, my->validate_invariants*/);
@@ -447,11 +711,30 @@ namespace golos { namespace plugins { namespace chain {
             }
         }
 
+        my->start_signature_recovery();
+
+        if (!my->block_notify_socket.empty()) {
+            my->notify_server = std::make_unique<block_notify_server>(
+                my->io_service(), my->block_notify_socket.string(), my->block_notify_queue_size);
+            my->notify_server->start();
+            my->db.applied_block.connect([this](const protocol::signed_block& b) {
+                my->notify_server->notify(b);
+            });
+        }
+
         ilog("Started on blockchain with ${n} blocks", ("n", my->db.head_block_num()));
         on_sync();
     }
 
     void plugin::plugin_shutdown() {
+        if (my->notify_client) {
+            my->notify_client->stop();
+        }
+        if (my->notify_server) {
+            my->notify_server->stop();
+        }
+        my->stop_signature_recovery();
+
         ilog("closing chain database");
         my->db.close();
         ilog("database closed successfully");
@@ -465,6 +748,17 @@ namespace golos { namespace plugins { namespace chain {
         my->accept_transaction(trx);
     }
 
+    bool plugin::read_only() const {
+        return my->readonly;
+    }
+
+    boost::signals2::signal<void(const protocol::signed_block&)>& plugin::block_applied_signal() {
+        if (my->readonly) {
+            return followed_block;
+        }
+        return my->db.applied_block;
+    }
+
     bool plugin::block_is_on_preferred_chain(const protocol::block_id_type& block_id) {
         // If it's not known, it's not preferred.
         if (!db().is_known_block(block_id)) {
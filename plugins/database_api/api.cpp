@@ -273,7 +273,8 @@ void plugin::api_impl::set_block_applied_callback(block_applied_callback callbac
     auto info_ptr = std::make_shared<block_applied_callback_info>();
     active_block_applied_callback.push_back(info_ptr);
     info_ptr->it = std::prev(active_block_applied_callback.end());
-    info_ptr->connect(database().applied_block, free_block_applied_callback, callback);
+    info_ptr->connect(
+        appbase::app().get_plugin<chain::plugin>().block_applied_signal(), free_block_applied_callback, callback);
 }
 
 void plugin::api_impl::set_pending_tx_callback(pending_tx_callback callback) {
@@ -902,12 +903,62 @@ DEFINE_API(plugin, get_proposed_transactions) {
     });
 }
 
+DEFINE_API(plugin, get_lock_stats) {
+    PLUGIN_API_VALIDATE_ARGS(
+        (bool, clear, false)
+    );
+
+    auto& stats = my->database().get_lock_stats();
+    GOLOS_ASSERT(stats.enabled(), golos::unsupported_api_method,
+        "Lock statistics are disabled, set lock-stats = true in config.ini");
+
+    auto result = stats.get();
+    if (clear) {
+        stats.clear();
+    }
+    return result;
+}
+
+DEFINE_API(plugin, get_rpc_cache_stats) {
+    PLUGIN_API_VALIDATE_ARGS();
+
+    auto& cache = appbase::app().get_plugin<json_rpc::plugin>().get_response_cache();
+    GOLOS_ASSERT(cache.enabled(), golos::unsupported_api_method,
+        "Cache of API results is disabled, set rpc-cache-method in config.ini");
+
+    return cache.get_stats();
+}
+
+DEFINE_API(plugin, get_pending_transactions_stats) {
+    PLUGIN_API_VALIDATE_ARGS();
+
+    return my->database().with_weak_read_lock([&]() {
+        return my->database().get_pending_transactions_stats();
+    });
+}
+
+DEFINE_API(plugin, get_rpc_stats) {
+    PLUGIN_API_VALIDATE_ARGS(
+        (bool, clear, false)
+    );
+
+    auto& stats = appbase::app().get_plugin<json_rpc::plugin>().get_rpc_stats();
+    GOLOS_ASSERT(stats.enabled(), golos::unsupported_api_method,
+        "API call statistics are disabled, set rpc-stats = true in config.ini");
+
+    auto result = stats.get();
+    if (clear) {
+        stats.clear();
+    }
+    return result;
+}
+
 void plugin::plugin_initialize(const boost::program_options::variables_map& options) {
     ilog("database_api plugin: plugin_initialize() begin");
     my = std::make_unique<api_impl>();
     JSON_RPC_REGISTER_API(plugin_name)
     auto& db = my->database();
-    db.applied_block.connect([&](const signed_block&) {
+    appbase::app().get_plugin<chain::plugin>().block_applied_signal().connect([&](const signed_block&) {
         my->clear_outdated_callbacks(true);
     });
     db.on_pending_transaction.connect([&](const signed_transaction& tx) {
@@ -20,6 +20,9 @@
 
 #include "forward.hpp"
 
+// get_block: transactions of a block are written to JSON one by one
+JSON_RPC_STREAM_OBJECT(golos::protocol::signed_block)
+
 namespace golos { namespace plugins { namespace database_api {
 
 using namespace golos::chain;
@@ -127,6 +130,10 @@ DEFINE_API_ARGS(verify_authority,                 msg_pack, bool)
 DEFINE_API_ARGS(verify_account_authority,         msg_pack, bool)
 DEFINE_API_ARGS(get_database_info,                msg_pack, database_info)
 DEFINE_API_ARGS(get_proposed_transactions,        msg_pack, std::vector<proposal_api_object>)
+DEFINE_API_ARGS(get_lock_stats,                   msg_pack, std::vector<golos::chain::lock_stats_item>)
+DEFINE_API_ARGS(get_rpc_stats,                    msg_pack, std::vector<golos::plugins::json_rpc::rpc_stats_item>)
+DEFINE_API_ARGS(get_rpc_cache_stats,              msg_pack, golos::plugins::json_rpc::response_cache_stats)
+DEFINE_API_ARGS(get_pending_transactions_stats,   msg_pack, golos::chain::pending_transactions_stats)
 
 
 /**
@@ -314,6 +321,28 @@ public:
         (get_database_info)
 
         (get_proposed_transactions)
+
+        /**
+         * @brief Wait and hold times of database locks by API methods and block applying (see lock-stats option)
+         * @param clear reset statistics after returning
+         */
+        (get_lock_stats)
+
+        /**
+         * @brief Latencies, sizes and lock waits of API calls by methods (see rpc-stats option)
+         * @param clear reset statistics after returning
+         */
+        (get_rpc_stats)
+
+        /**
+         * @brief Size and hits of the cache of API results by methods (see rpc-cache-method option)
+         */
+        (get_rpc_cache_stats)
+
+        /**
+         * @brief Counts and time of re-applying of pending transactions after blocks
+         */
+        (get_pending_transactions_stats)
     )
 
 private:
@@ -162,6 +162,10 @@ namespace golos {
 
                     save_blog_stats(db(), o.account, c.author, 1);
 
+                    if (!_plugin->store_feed()) {
+                        return;
+                    }
+
                     const auto& feed_idx = db().get_index<feed_index>().indices().get<by_feed>();
                     const auto& comment_idx = db().get_index<feed_index>().indices().get<by_comment>();
                     const auto& idx = db().get_index<follow_index>().indices().get<by_following_follower>();
@@ -229,6 +233,10 @@ namespace golos {
 
                     // Removing info about reblog from feed_objects for followers of reblogger
 
+                    if (!_plugin->store_feed()) {
+                        return;
+                    }
+
                     const auto& comment_idx = db().get_index<feed_index>().indices().get<by_comment>();
                     const auto& idx = db().get_index<follow_index>().indices().get<by_following_follower>();
                     
@@ -79,6 +79,9 @@ namespace golos { namespace plugins { namespace follow {
 
         uint32_t max_feed_size();
 
+        /// false in pull mode, when feeds are assembled from blogs on query
+        bool store_feed();
+
         void plugin_startup() override;
 
         void plugin_shutdown() override {}
@@ -14,6 +14,13 @@
 #include <golos/chain/index.hpp>
 #include <golos/api/discussion_helper.hpp>
 
+#include <algorithm>
+#include <list>
+#include <map>
+#include <mutex>
+#include <queue>
+#include <set>
+
 namespace golos {
 
 template<>
@@ -173,40 +180,43 @@ namespace golos {
                             return;
                         }
 
-                        const auto& idx = db.get_index<follow_index>().indices().get<by_following_follower>();
-                        const auto& comment_idx = db.get_index<feed_index>().indices().get<by_comment>();
-                        auto itr = idx.find(op.author);
-
-                        const auto& feed_idx = db.get_index<feed_index>().indices().get<by_feed>();
-
-                        while (itr != idx.end() && itr->following == op.author) {
-                            if (itr->what & (1 << blog)) {
-                                uint32_t next_id = 0;
-                                auto last_feed = feed_idx.lower_bound(itr->follower);
+                        // in pull mode feeds are assembled from blogs on query (see get_feed)
+                        if (_plugin.store_feed()) {
+                            const auto& idx = db.get_index<follow_index>().indices().get<by_following_follower>();
+                            const auto& comment_idx = db.get_index<feed_index>().indices().get<by_comment>();
+                            auto itr = idx.find(op.author);
 
-                                if (last_feed != feed_idx.end() && last_feed->account == itr->follower) {
-                                    next_id = last_feed->account_feed_id + 1;
-                                }
+                            const auto& feed_idx = db.get_index<feed_index>().indices().get<by_feed>();
 
-                                if (comment_idx.find(boost::make_tuple(c.id, itr->follower)) == comment_idx.end()) {
-                                    db.create<feed_object>([&](feed_object& f) {
-                                        f.account = itr->follower;
-                                        f.comment = c.id;
-                                        f.account_feed_id = next_id;
-                                    });
+                            while (itr != idx.end() && itr->following == op.author) {
+                                if (itr->what & (1 << blog)) {
+                                    uint32_t next_id = 0;
+                                    auto last_feed = feed_idx.lower_bound(itr->follower);
 
-                                    const auto& old_feed_idx = db.get_index<feed_index>().indices().get<by_old_feed>();
-                                    auto old_feed = old_feed_idx.lower_bound(itr->follower);
+                                    if (last_feed != feed_idx.end() && last_feed->account == itr->follower) {
+                                        next_id = last_feed->account_feed_id + 1;
+                                    }
 
-                                    while (old_feed->account == itr->follower &&
-                                           next_id - old_feed->account_feed_id > _plugin.max_feed_size()) {
-                                        db.remove(*old_feed);
-                                        old_feed = old_feed_idx.lower_bound(itr->follower);
+                                    if (comment_idx.find(boost::make_tuple(c.id, itr->follower)) == comment_idx.end()) {
+                                        db.create<feed_object>([&](feed_object& f) {
+                                            f.account = itr->follower;
+                                            f.comment = c.id;
+                                            f.account_feed_id = next_id;
+                                        });
+
+                                        const auto& old_feed_idx = db.get_index<feed_index>().indices().get<by_old_feed>();
+                                        auto old_feed = old_feed_idx.lower_bound(itr->follower);
+
+                                        while (old_feed->account == itr->follower &&
+                                               next_id - old_feed->account_feed_id > _plugin.max_feed_size()) {
+                                            db.remove(*old_feed);
+                                            old_feed = old_feed_idx.lower_bound(itr->follower);
+                                        }
                                     }
                                 }
-                            }
 
-                            ++itr;
+                                ++itr;
+                            }
                         }
 
                         const auto& blog_idx = db.get_index<blog_index>().indices().get<by_blog>();
@@ -293,6 +303,44 @@ namespace golos {
                 }
             }
 
+            /**
+             * Feed entry assembled from blogs of followed accounts in pull mode
+             */
+            struct pull_feed_item final {
+                comment_object::id_type comment;
+                uint32_t entry_id = 0;
+                std::vector<account_name_type> reblogged_by;
+                time_point_sec first_reblogged_on;
+            };
+
+            using pull_feed_ptr = std::shared_ptr<const std::vector<pull_feed_item>>;
+
+            template<typename Entry>
+            void fill_pull_feed_entry(const golos::chain::database& db, const pull_feed_item& item, Entry& entry) {
+                entry.entry_id = item.entry_id;
+                if (item.reblogged_by.empty()) {
+                    return;
+                }
+
+                const auto& blog_idx = db.get_index<blog_index>().indices().get<by_comment>();
+                entry.reblog_by.reserve(item.reblogged_by.size());
+                entry.reblog_entries.reserve(item.reblogged_by.size());
+                for (const auto& a : item.reblogged_by) {
+                    auto blog_itr = blog_idx.find(std::make_tuple(item.comment, a));
+                    if (blog_itr == blog_idx.end()) {
+                        continue;
+                    }
+                    entry.reblog_by.push_back(a);
+                    entry.reblog_entries.emplace_back(
+                        a,
+                        to_string(blog_itr->reblog_title),
+                        to_string(blog_itr->reblog_body),
+                        to_string(blog_itr->reblog_json_metadata)
+                    );
+                }
+                entry.reblog_on = item.first_reblogged_on;
+            }
+
             struct plugin::impl final {
             public:
                 impl() : database_(appbase::app().get_plugin<chain::plugin>().db()) {
@@ -389,10 +437,30 @@ namespace golos {
 
                 blog_authors_r get_blog_authors(account_name_type );
 
+                pull_feed_ptr get_pull_feed(account_name_type account, uint32_t entry_id, uint32_t limit);
+
+                pull_feed_ptr assemble_pull_feed(account_name_type account, uint32_t entry_id, uint32_t limit);
+
                 golos::chain::database& database_;
 
                 uint32_t max_feed_size_ = 500;
 
+                bool pull_feed_ = false;
+
+                // Assembled feeds are cached until the next block
+                using feed_cache_key = std::tuple<account_name_type, uint32_t, uint32_t>;
+
+                struct feed_cache_value final {
+                    uint32_t block_num;
+                    pull_feed_ptr feed;
+                    std::list<feed_cache_key>::iterator lru;
+                };
+
+                uint32_t feed_cache_size_ = 0;
+                std::mutex feed_cache_mutex_;
+                std::list<feed_cache_key> feed_cache_lru_;
+                std::map<feed_cache_key, feed_cache_value> feed_cache_;
+
                 std::shared_ptr<generic_custom_operation_interpreter<
                         follow::follow_plugin_operation>> _custom_operation_interpreter;
 
@@ -407,7 +475,12 @@ namespace golos {
                                                     boost::program_options::options_description& cfg) {
                 cli.add_options()
                     ("follow-max-feed-size", boost::program_options::value<uint32_t>()->default_value(500),
-                        "Set the maximum size of cached feed for an account");
+                        "Set the maximum size of cached feed for an account")
+                    ("follow-feed-mode", boost::program_options::value<std::string>()->default_value("push"),
+                        "push - store feed of each follower on posting, "
+                        "pull - assemble feed from blogs of followed accounts on query (requires replay on changing)")
+                    ("follow-feed-cache-size", boost::program_options::value<uint32_t>()->default_value(0),
+                        "Number of feeds assembled in pull mode, which are cached until the next block. Default: 0 (disabled)");
                 cfg.add(cli);
             }
 
@@ -436,6 +509,12 @@ namespace golos {
                         pimpl->max_feed_size_ = feed_size;
                     }
 
+                    auto feed_mode = options.at("follow-feed-mode").as<std::string>();
+                    GOLOS_CHECK_OPTION(feed_mode == "push" || feed_mode == "pull",
+                        "follow-feed-mode should be push or pull");
+                    pimpl->pull_feed_ = (feed_mode == "pull");
+                    pimpl->feed_cache_size_ = options.at("follow-feed-cache-size").as<uint32_t>();
+
                     JSON_RPC_REGISTER_API ( name() ) ;
                 } FC_CAPTURE_AND_RETHROW()
             }
@@ -447,6 +526,10 @@ namespace golos {
                 return pimpl->max_feed_size_;
             }
 
+            bool plugin::store_feed() {
+                return !pimpl->pull_feed_;
+            }
+
             plugin::~plugin() {
 
             }
@@ -517,6 +600,139 @@ namespace golos {
                 return result;
             }
 
+            pull_feed_ptr plugin::impl::assemble_pull_feed(
+                    account_name_type account,
+                    uint32_t entry_id,
+                    uint32_t limit) {
+                const auto& db = database();
+                const auto& follow_idx = db.get_index<follow_index>().indices().get<by_follower_following>();
+                const auto& blog_idx = db.get_index<blog_index>().indices().get<by_blog>();
+                using blog_iterator = decltype(blog_idx.begin());
+
+                // entry_id of a pulled entry is id of its blog_object + 1, ids grow with the time of posting
+                //  and reblogging, so it is a unique cursor, and the page starts from it (inclusive) as in push mode
+                auto blog_entry_id = [](const blog_object& b) {
+                    return static_cast<uint32_t>(b.id._id + 1);
+                };
+
+                // blog entries are ordered by time, so blogs of followed accounts are merged by their heads
+                struct blog_head {
+                    uint32_t entry_id;
+                    blog_iterator itr;
+
+                    bool operator<(const blog_head& h) const {
+                        return entry_id < h.entry_id;
+                    }
+                };
+                std::priority_queue<blog_head> heads;
+
+                // posts with newer entries were already returned on previous pages
+                std::set<comment_object::id_type> newer;
+
+                auto push_head = [&](blog_iterator itr, const account_name_type& blogger) {
+                    for (; itr != blog_idx.end() && itr->account == blogger; ++itr) {
+                        auto id = blog_entry_id(*itr);
+                        if (id <= entry_id) {
+                            heads.push({id, itr});
+                            return;
+                        }
+                        newer.insert(itr->comment);
+                    }
+                };
+
+                std::set<account_name_type> followed;
+                auto follow_itr = follow_idx.lower_bound(account);
+                for (; follow_itr != follow_idx.end() && follow_itr->follower == account; ++follow_itr) {
+                    if (follow_itr->what & (1 << blog)) {
+                        followed.insert(follow_itr->following);
+                        push_head(blog_idx.lower_bound(follow_itr->following), follow_itr->following);
+                    }
+                }
+
+                auto result = std::make_shared<std::vector<pull_feed_item>>();
+                std::set<comment_object::id_type> positions;
+
+                while (!heads.empty()) {
+                    auto head = heads.top();
+                    heads.pop();
+
+                    const auto& b = *head.itr;
+                    if (!newer.count(b.comment) && !positions.count(b.comment)) {
+                        if (result->size() >= limit) {
+                            break;
+                        }
+                        positions.insert(b.comment);
+                        result->emplace_back();
+                        result->back().comment = b.comment;
+                        result->back().entry_id = head.entry_id;
+                    }
+
+                    push_head(std::next(head.itr), b.account);
+                }
+
+                // older reblogs of a post can be behind entries of posts which didn't get to the page,
+                //  so all reblogs of followed accounts are read by the post, from older to newer
+                const auto& comment_blog_idx = db.get_index<blog_index>().indices().get<by_comment>();
+                std::vector<std::pair<uint32_t, const blog_object*>> reblogs;
+                for (auto& item : *result) {
+                    reblogs.clear();
+                    auto itr = comment_blog_idx.lower_bound(item.comment);
+                    for (; itr != comment_blog_idx.end() && itr->comment == item.comment; ++itr) {
+                        if (itr->reblogged_on != time_point_sec() && followed.count(itr->account)) {
+                            reblogs.emplace_back(blog_entry_id(*itr), &*itr);
+                        }
+                    }
+                    if (reblogs.empty()) {
+                        continue;
+                    }
+                    std::sort(reblogs.begin(), reblogs.end());
+                    item.reblogged_by.reserve(reblogs.size());
+                    for (const auto& reblog : reblogs) {
+                        item.reblogged_by.push_back(reblog.second->account);
+                    }
+                    item.first_reblogged_on = reblogs.front().second->reblogged_on;
+                }
+                return result;
+            }
+
+            pull_feed_ptr plugin::impl::get_pull_feed(
+                    account_name_type account,
+                    uint32_t entry_id,
+                    uint32_t limit) {
+                if (!feed_cache_size_) {
+                    return assemble_pull_feed(account, entry_id, limit);
+                }
+
+                auto key = std::make_tuple(account, entry_id, limit);
+                auto block_num = database().head_block_num();
+                {
+                    std::lock_guard<std::mutex> lock(feed_cache_mutex_);
+                    auto itr = feed_cache_.find(key);
+                    if (itr != feed_cache_.end() && itr->second.block_num == block_num) {
+                        feed_cache_lru_.splice(feed_cache_lru_.begin(), feed_cache_lru_, itr->second.lru);
+                        return itr->second.feed;
+                    }
+                }
+
+                auto feed = assemble_pull_feed(account, entry_id, limit);
+
+                std::lock_guard<std::mutex> lock(feed_cache_mutex_);
+                auto itr = feed_cache_.find(key);
+                if (itr != feed_cache_.end()) {
+                    itr->second.block_num = block_num;
+                    itr->second.feed = feed;
+                    feed_cache_lru_.splice(feed_cache_lru_.begin(), feed_cache_lru_, itr->second.lru);
+                } else {
+                    feed_cache_lru_.push_front(key);
+                    feed_cache_.emplace(key, feed_cache_value{block_num, feed, feed_cache_lru_.begin()});
+                    if (feed_cache_.size() > feed_cache_size_) {
+                        feed_cache_.erase(feed_cache_lru_.back());
+                        feed_cache_lru_.pop_back();
+                    }
+                }
+                return feed;
+            }
+
             std::vector<feed_entry> plugin::impl::get_feed_entries(
                     account_name_type account,
                     uint32_t entry_id,
@@ -531,6 +747,22 @@ namespace golos {
                 result.reserve(limit);
 
                 const auto& db = database();
+
+                if (pull_feed_) {
+                    for (const auto& item : *get_pull_feed(account, entry_id, limit)) {
+                        const auto* comment = db.find<comment_object>(item.comment);
+                        if (comment == nullptr) {
+                            continue;
+                        }
+                        feed_entry entry;
+                        entry.author = comment->author;
+                        entry.permlink = to_string(comment->permlink);
+                        fill_pull_feed_entry(db, item, entry);
+                        result.push_back(std::move(entry));
+                    }
+                    return result;
+                }
+
                 const auto& feed_idx = db.get_index<feed_index>().indices().get<by_feed>();
                 auto itr = feed_idx.lower_bound(boost::make_tuple(account, entry_id));
 
@@ -578,6 +810,21 @@ namespace golos {
                 result.reserve(limit);
 
                 const auto& db = database();
+
+                if (pull_feed_) {
+                    for (const auto& item : *get_pull_feed(account, entry_id, limit)) {
+                        const auto* comment = db.find<comment_object>(item.comment);
+                        if (comment == nullptr) {
+                            continue;
+                        }
+                        comment_feed_entry entry;
+                        entry.comment = helper->create_comment_api_object(*comment);
+                        fill_pull_feed_entry(db, item, entry);
+                        result.push_back(std::move(entry));
+                    }
+                    return result;
+                }
+
                 const auto& feed_idx = db.get_index<feed_index>().indices().get<by_feed>();
                 auto itr = feed_idx.lower_bound(boost::make_tuple(account, entry_id));
 
@@ -0,0 +1,239 @@
+#pragma once
+
+#include <fc/io/json.hpp>
+#include <fc/optional.hpp>
+#include <fc/reflect/reflect.hpp>
+#include <fc/reflect/variant.hpp>
+#include <fc/variant.hpp>
+
+#include <boost/container/flat_map.hpp>
+#include <boost/container/flat_set.hpp>
+
+#include <deque>
+#include <map>
+#include <set>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * Streaming serializer of API results.
+ *
+ * fc::json::to_string(fc::variant(value)) builds the whole variant tree of a result before
+ * the first byte of JSON is written, so large results (blocks, history pages) live in memory twice.
+ * write_json() walks containers and opted-in reflected objects and appends their JSON
+ * to the output buffer, only leaves are converted through fc::variant one by one.
+ * The output is the same as the output of fc::json::to_string(fc::variant(value)).
+ *
+ * Containers of class types are streamed (containers of scalars can have special
+ * conversion, for example std::vector<char> is a hex string). Reflected objects are streamed
+ * only after JSON_RPC_STREAM_OBJECT(type), because a type can have its own to_variant().
+ */
+
+namespace golos { namespace plugins { namespace json_rpc {
+
+    template <typename T>
+    struct is_json_stream_object: std::false_type {
+    };
+
+    /// True if write_json() doesn't convert the value to fc::variant as a whole
+    template <typename T>
+    struct is_json_streamable: is_json_stream_object<T> {
+    };
+
+    template <typename T, typename A>
+    struct is_json_streamable<std::vector<T, A>>: std::is_class<T> {
+    };
+
+    template <typename T, typename A>
+    struct is_json_streamable<std::deque<T, A>>: std::is_class<T> {
+    };
+
+    template <typename T, typename C, typename A>
+    struct is_json_streamable<std::set<T, C, A>>: std::is_class<T> {
+    };
+
+    template <typename T, typename C, typename A>
+    struct is_json_streamable<boost::container::flat_set<T, C, A>>: std::is_class<T> {
+    };
+
+    template <typename K, typename T, typename C, typename A>
+    struct is_json_streamable<std::map<K, T, C, A>>: std::true_type {
+    };
+
+    template <typename K, typename T, typename C, typename A>
+    struct is_json_streamable<boost::container::flat_map<K, T, C, A>>: std::true_type {
+    };
+
+    template <typename T>
+    struct is_json_streamable<fc::optional<T>>: is_json_streamable<T> {
+    };
+
+    template <typename T>
+    void write_json(std::string& out, const T& value);
+
+    namespace detail {
+
+        template <typename T, bool Object = is_json_stream_object<T>::value>
+        struct json_stream_writer {
+            static void write(std::string& out, const T& value) {
+                out += fc::json::to_string(fc::variant(value));
+            }
+        };
+
+        template <typename Range>
+        void write_json_array(std::string& out, const Range& range) {
+            out += '[';
+            bool first = true;
+            for (const auto& item: range) {
+                if (!first) {
+                    out += ',';
+                }
+                first = false;
+                write_json(out, item);
+            }
+            out += ']';
+        }
+
+        // fc converts maps to arrays of [key, value] pairs
+        template <typename Map>
+        void write_json_map(std::string& out, const Map& map) {
+            out += '[';
+            bool first = true;
+            for (const auto& item: map) {
+                if (!first) {
+                    out += ',';
+                }
+                first = false;
+                out += '[';
+                write_json(out, item.first);
+                out += ',';
+                write_json(out, item.second);
+                out += ']';
+            }
+            out += ']';
+        }
+
+        template <typename T>
+        class json_stream_visitor final {
+        public:
+            json_stream_visitor(std::string& out, const T& value)
+                : out_(out),
+                  value_(value) {
+            }
+
+            template <typename Member, class Class, Member (Class::*member)>
+            void operator()(const char* name) const {
+                add(name, value_.*member);
+            }
+
+        private:
+            // the same as fc::to_variant_visitor, which skips empty optional members
+            template <typename M>
+            void add(const char* name, const fc::optional<M>& value) const {
+                if (value.valid()) {
+                    add(name, *value);
+                }
+            }
+
+            template <typename M>
+            void add(const char* name, const M& value) const {
+                if (!first_) {
+                    out_ += ',';
+                }
+                first_ = false;
+                out_ += '"';
+                out_ += name;
+                out_ += "\":";
+                write_json(out_, value);
+            }
+
+            std::string& out_;
+            const T& value_;
+            mutable bool first_ = true;
+        };
+
+        template <typename T>
+        struct json_stream_writer<T, true> {
+            static void write(std::string& out, const T& value) {
+                out += '{';
+                fc::reflector<T>::visit(json_stream_visitor<T>(out, value));
+                out += '}';
+            }
+        };
+
+        template <typename T, typename A>
+        struct json_stream_writer<std::vector<T, A>, false> {
+            static void write(std::string& out, const std::vector<T, A>& value) {
+                if (std::is_class<T>::value) {
+                    write_json_array(out, value);
+                } else {
+                    out += fc::json::to_string(fc::variant(value));
+                }
+            }
+        };
+
+        template <typename T, typename A>
+        struct json_stream_writer<std::deque<T, A>, false> {
+            static void write(std::string& out, const std::deque<T, A>& value) {
+                write_json_array(out, value);
+            }
+        };
+
+        template <typename T, typename C, typename A>
+        struct json_stream_writer<std::set<T, C, A>, false> {
+            static void write(std::string& out, const std::set<T, C, A>& value) {
+                write_json_array(out, value);
+            }
+        };
+
+        template <typename T, typename C, typename A>
+        struct json_stream_writer<boost::container::flat_set<T, C, A>, false> {
+            static void write(std::string& out, const boost::container::flat_set<T, C, A>& value) {
+                write_json_array(out, value);
+            }
+        };
+
+        template <typename K, typename T, typename C, typename A>
+        struct json_stream_writer<std::map<K, T, C, A>, false> {
+            static void write(std::string& out, const std::map<K, T, C, A>& value) {
+                write_json_map(out, value);
+            }
+        };
+
+        template <typename K, typename T, typename C, typename A>
+        struct json_stream_writer<boost::container::flat_map<K, T, C, A>, false> {
+            static void write(std::string& out, const boost::container::flat_map<K, T, C, A>& value) {
+                write_json_map(out, value);
+            }
+        };
+
+        template <typename T>
+        struct json_stream_writer<fc::optional<T>, false> {
+            static void write(std::string& out, const fc::optional<T>& value) {
+                if (value.valid()) {
+                    write_json(out, *value);
+                } else {
+                    out += "null";
+                }
+            }
+        };
+
+    } // namespace detail
+
+    /// Appends JSON of value to out
+    template <typename T>
+    void write_json(std::string& out, const T& value) {
+        detail::json_stream_writer<T>::write(out, value);
+    }
+
+} } } // golos::plugins::json_rpc
+
+/// Allows write_json() to stream members of the reflected type, must be used in the global namespace
+#define JSON_RPC_STREAM_OBJECT(TYPE) \
+    namespace golos { namespace plugins { namespace json_rpc { \
+        template <> \
+        struct is_json_stream_object<TYPE>: std::true_type { \
+        }; \
+    } } }
@@ -2,6 +2,9 @@
 
 #include <appbase/application.hpp>
 #include <golos/plugins/json_rpc/utility.hpp>
+#include <golos/plugins/json_rpc/rpc_stats.hpp>
+#include <golos/plugins/json_rpc/json_stream.hpp>
+#include <golos/plugins/json_rpc/response_cache.hpp>
 #include <fc/variant.hpp>
 #include <fc/io/json.hpp>
 #include <fc/reflect/variant.hpp>
@@ -56,6 +59,7 @@
 #define SERVER_MISSING_AUTHORITY     (-32004)   // tx_missing_authority
 #define SERVER_INVALID_OPERATION     (-32005)   // tx_invalid_operation (client must check inner exception)
 #define SERVER_INVALID_TRANSACTION   (-32006)   // transaction_exception
+#define SERVER_OVERLOADED            (-32007)   // the queue of webserver is full
 
 namespace golos {
     namespace plugins {
@@ -88,6 +92,7 @@ namespace golos {
             class plugin final : public appbase::plugin<plugin> {
             public:
                 using response_handler_type = std::function<void (const std::string &)>;
+                using task_executor_type = std::function<void (std::function<void ()>)>;
 
                 plugin();
 
@@ -96,8 +101,7 @@ namespace golos {
                 APPBASE_PLUGIN_REQUIRES();
 
                 void set_program_options(boost::program_options::options_description &,
-                                         boost::program_options::options_description &) override {
-                }
+                                         boost::program_options::options_description &) override;
 
                 static const std::string &name() {
                     static std::string name = STEEM_JSON_RPC_PLUGIN_NAME;
@@ -115,6 +119,19 @@ namespace golos {
 
                 void call(const string &body, response_handler_type);
 
+                /**
+                 * Sets the executor for concurrent processing of batch items.
+                 * Items are dispatched independently, responses are assembled in request order.
+                 * If the executor isn't set, items of a batch are processed one by one.
+                 */
+                void set_batch_executor(task_executor_type);
+
+                /// Statistics of API calls by methods, they are collected if rpc-stats is enabled
+                rpc_stats &get_rpc_stats();
+
+                /// Cache of results of API methods listed in rpc-cache-method
+                response_cache &get_response_cache();
+
             private:
                 class impl;
 
@@ -122,6 +139,22 @@ namespace golos {
             };
 
             namespace detail {
+                template <typename Ret>
+                fc::variant api_result(msg_pack &, Ret &&ret, std::false_type) {
+                    return fc::variant(std::forward<Ret>(ret));
+                }
+
+                // large results are written to JSON without building fc::variant of the whole result
+                template <typename Ret>
+                fc::variant api_result(msg_pack &msg, const Ret &ret, std::true_type) {
+                    if (msg.valid()) {
+                        std::string json;
+                        write_json(json, ret);
+                        msg.json_result(std::move(json));
+                    }
+                    return fc::variant();
+                }
+
                 class register_api_method_visitor {
                 public:
                     register_api_method_visitor(const std::string &api_name) : _api_name(api_name),
@@ -133,7 +166,9 @@ namespace golos {
                                     Ret *ret) {
                         _json_rpc_plugin.add_api_method(_api_name, method_name,
                                                         [&plugin, method](msg_pack &args) -> fc::variant {
-                                                            return fc::variant((plugin.*method)(args));
+                                                            return api_result(
+                                                                args, (plugin.*method)(args),
+                                                                is_json_streamable<Ret>());
                                                         });
                         /*api_method_signature{ fc::variant( Args() ), fc::variant( Ret() ) }*/ //);
                     }
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <fc/reflect/reflect.hpp>
+#include <fc/optional.hpp>
+#include <fc/variant.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace golos { namespace plugins { namespace json_rpc {
+
+    struct response_cache_item final {
+        std::string method;
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+    };
+
+    struct response_cache_stats final {
+        uint64_t entries = 0;
+        uint64_t size_bytes = 0;
+        uint64_t max_size_bytes = 0;
+        std::vector<response_cache_item> methods;
+    };
+
+    /**
+     * Cache of serialized results of read-only API methods.
+     *
+     * Results are keyed by the method and its params serialized to JSON. A method is cached
+     * till the next block, or for the fixed time (TTL), if it's set. The least recently used
+     * results are dropped when the size of the cache exceeds the limit.
+     */
+    class response_cache final {
+    public:
+        using milliseconds = std::chrono::milliseconds;
+
+        response_cache();
+
+        ~response_cache();
+
+        /// @param ttl zero - the result is valid till the next block
+        void add_method(const std::string& method, milliseconds ttl);
+
+        void set_max_size(uint64_t bytes);
+
+        bool enabled() const;
+
+        /// @return the key of request, or the empty string if the method isn't cached
+        std::string key(const std::string& method, const fc::optional<std::vector<fc::variant>>& args) const;
+
+        /// Counts hit or miss
+        fc::optional<std::string> get(const std::string& method, const std::string& key);
+
+        /// The number of the state, results of older states aren't stored
+        uint64_t generation() const;
+
+        void put(const std::string& method, const std::string& key, const std::string& json, uint64_t generation);
+
+        /// Drops results which are cached till the next block
+        void on_block();
+
+        response_cache_stats get_stats() const;
+
+    private:
+        struct impl;
+        std::unique_ptr<impl> _impl;
+    };
+
+} } } // golos::plugins::json_rpc
+
+FC_REFLECT((golos::plugins::json_rpc::response_cache_item), (method)(hits)(misses))
+
+FC_REFLECT((golos::plugins::json_rpc::response_cache_stats), (entries)(size_bytes)(max_size_bytes)(methods))
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <fc/reflect/reflect.hpp>
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace golos { namespace plugins { namespace json_rpc {
+
+    /**
+     * Statistics of calls of one API method
+     */
+    struct rpc_stats_item final {
+        std::string method;   ///< api.method, or "invalid" for requests which weren't parsed
+
+        uint64_t count = 0;
+        uint64_t errors = 0;
+
+        uint64_t request_bytes = 0;
+        uint64_t response_bytes = 0;
+
+        uint64_t total_us = 0;      ///< from receiving of request to sending of response
+        uint64_t max_us = 0;
+        uint64_t lock_wait_us = 0;  ///< waits of database locks, requires lock-stats = true
+
+        uint64_t p50_us = 0;  ///< estimated by histogram as the upper bound of bucket
+        uint64_t p99_us = 0;
+
+        /// Number of calls by buckets of time, see rpc_stats::time_buckets
+        std::vector<uint64_t> histogram;
+    };
+
+    /**
+     * Collects latencies and sizes of JSON-RPC calls by API methods
+     */
+    class rpc_stats final {
+    public:
+        /// Upper bounds (microseconds) of buckets of time histogram, the last bucket is unbounded
+        static const std::vector<uint64_t> time_buckets;
+
+        void enable(bool value) {
+            _enabled = value;
+        }
+
+        bool enabled() const {
+            return _enabled;
+        }
+
+        void add(
+            const std::string& method, uint64_t time_us, uint64_t lock_wait_us,
+            uint64_t request_bytes, uint64_t response_bytes, bool error);
+
+        std::vector<rpc_stats_item> get() const;
+
+        void clear();
+
+    private:
+        std::atomic<bool> _enabled{false};
+        mutable std::mutex _mutex;
+        std::map<std::string, rpc_stats_item> _items;
+    };
+
+} } } // golos::plugins::json_rpc
+
+FC_REFLECT((golos::plugins::json_rpc::rpc_stats_item),
+    (method)(count)(errors)(request_bytes)(response_bytes)
+    (total_us)(max_us)(lock_wait_us)(p50_us)(p99_us)(histogram))
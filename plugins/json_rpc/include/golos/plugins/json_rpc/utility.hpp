@@ -76,6 +76,9 @@ namespace golos { namespace plugins { namespace json_rpc {
 
                 fc::optional<fc::variant> result() const;
 
+                // Pass serialized result to remote connection, the msg_pack becomes invalid after it
+                void json_result(std::string json);
+
                 // Pass error to remote connection
                 void error(int32_t code, std::string message, fc::optional<fc::variant> data = fc::optional<fc::variant>());
 
@@ -1,9 +1,15 @@
 #include <golos/plugins/json_rpc/plugin.hpp>
 #include <golos/plugins/json_rpc/utility.hpp>
+#include <golos/plugins/json_rpc/rpc_stats.hpp>
+#include <golos/plugins/json_rpc/response_cache.hpp>
 
 #include <golos/protocol/exceptions.hpp>
+#include <golos/chain/lock_stats.hpp>
 
 #include <boost/algorithm/string.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <atomic>
 
 #include <fc/log/logger_config.hpp>
 #include <fc/exception/exception.hpp>
@@ -31,6 +37,9 @@ namespace golos {
                 fc::optional<fc::variant> result;
                 fc::optional<json_rpc_error> error;
                 fc::variant id;
+
+                // JSON of result written by write_json(), it isn't reflected and replaces result
+                std::string json_result;
             };
 
             struct msg_pack::impl final {
@@ -105,6 +114,19 @@ namespace golos {
                 }
             }
 
+            void msg_pack::json_result(std::string json) {
+                // Pimpl can absent in case if msg_pack delegated its handlers to other msg_pack (see move constructor)
+                FC_ASSERT(valid(), "The msg_pack delegated its handlers");
+                auto tmp = std::move(pimpl);
+                tmp->response.json_result = std::move(json);
+                try {
+                    tmp->handler(tmp->response);
+                } catch (const websocketpp::exception &) {
+                    // Can't send data via socket -
+                    //    don't pass exception to upper level, because it doesn't have handler for exception
+                }
+            }
+
             fc::optional<fc::variant> msg_pack::result() const {
                 // Pimpl can absent in case if msg_pack delegated its handlers to other msg_pack (see move constructor)
                 if (valid()) {
@@ -216,7 +238,106 @@ namespace golos {
                     return ret;
                 }
 
-                void rpc_jsonrpc(const fc::variant &data, msg_pack &msg) {
+                /**
+                 * Measures one call: logs the elapsed time and slow calls with their params, adds statistics.
+                 * It is shared with the response handler, because asynchronous methods respond later.
+                 */
+                class rpc_call final {
+                public:
+                    rpc_call(impl& self, const fc::variant& data, uint64_t request_bytes)
+                        : self_(self),
+                          data_(data),
+                          request_bytes_(request_bytes),
+                          lock_wait_(golos::chain::lock_stats::thread_wait_us()) {
+
+                        dlog("data: ${data}", ("data", fc::json::to_string(data_)));
+                    }
+
+                    ~rpc_call() {
+                        auto time = (fc::time_point::now() - start_).count();
+                        if (error_.empty()) {
+                            dlog(
+                                "elapsed: ${time} sec, data: ${data}",
+                                ("data", fc::json::to_string(data_))
+                                ("time", double(time) / 1000000.0));
+                        } else {
+                            dlog(
+                                "elapsed: ${time} sec, error: '${error}', data: ${data}",
+                                ("data", fc::json::to_string(data_))
+                                ("error", error_)
+                                ("time", double(time) / 1000000.0));
+                        }
+
+                        if (self_._slow_call_us && uint64_t(time) >= self_._slow_call_us) {
+                            wlog(
+                                "Slow call of ${method}: ${time} sec, lock wait: ${wait} sec, params: ${data}",
+                                ("method", method_)
+                                ("time", double(time) / 1000000.0)
+                                ("wait", double(lock_wait_) / 1000000.0)
+                                ("data", fc::json::to_string(data_)));
+                        }
+
+                        if (self_._stats.enabled()) {
+                            self_._stats.add(
+                                method_.empty() ? "invalid" : method_, time, lock_wait_,
+                                request_bytes_, response_bytes_, failed_ || !error_.empty());
+                        }
+                    }
+
+                    void method(std::string value) {
+                        method_ = std::move(value);
+                    }
+
+                    void error(std::string value) {
+                        error_ = std::move(value);
+                    }
+
+                    // called in the thread of call after the synchronous part of method
+                    void executed() {
+                        lock_wait_ = golos::chain::lock_stats::thread_wait_us() - lock_wait_;
+                    }
+
+                    void response(uint64_t bytes, bool failed) {
+                        response_bytes_ = bytes;
+                        failed_ = failed;
+                    }
+
+                    // the result isn't found in the cache and should be stored
+                    void cache_miss(std::string key, uint64_t generation) {
+                        cache_key_ = std::move(key);
+                        cache_generation_ = generation;
+                    }
+
+                    // the response is sent before the call is destroyed
+                    void cache_result(json_rpc_response& response) {
+                        if (cache_key_.empty() || response.error.valid()) {
+                            return;
+                        }
+                        if (response.json_result.empty()) {
+                            if (!response.result.valid()) {
+                                return;
+                            }
+                            response.json_result = fc::json::to_string(*response.result);
+                            response.result.reset();
+                        }
+                        self_._cache.put(method_, cache_key_, response.json_result, cache_generation_);
+                    }
+
+                private:
+                    impl& self_;
+                    fc::time_point start_ = fc::time_point::now();
+                    fc::variant data_;
+                    std::string method_;
+                    std::string error_;
+                    uint64_t request_bytes_ = 0;
+                    uint64_t response_bytes_ = 0;
+                    uint64_t lock_wait_ = 0;
+                    bool failed_ = false;
+                    std::string cache_key_;
+                    uint64_t cache_generation_ = 0;
+                };
+
+                void rpc_jsonrpc(const fc::variant &data, msg_pack &msg, rpc_call &current) {
                     fc::variant_object request;
 
                     try {
@@ -244,7 +365,21 @@ namespace golos {
                         return;
                     }
 
+                    auto method = msg.plugin + "." + msg.method;
+                    current.method(method);
+
+                    auto cache_key = _cache.key(method, msg.args);
+                    if (!cache_key.empty()) {
+                        auto generation = _cache.generation();
+                        auto cached = _cache.get(method, cache_key);
+                        if (cached.valid()) {
+                            return msg.json_result(std::move(*cached));
+                        }
+                        current.cache_miss(std::move(cache_key), generation);
+                    }
+
                     try {
+                        golos::chain::lock_stats::context_guard lock_context(method);
                         auto result = (*call)(msg);
                         if (msg.valid()) {
                             msg.result(std::move(result));
@@ -272,81 +407,123 @@ namespace golos {
                     }
                 }
 
-                struct dump_rpc_time {
-                    dump_rpc_time(const fc::variant& data)
-                        : data_(data) {
+                void rpc(const fc::variant& data, msg_pack& msg, rpc_call& call) {
+                    try {
+                        rpc_jsonrpc(data, msg, call);
 
-                        dlog("data: ${data}", ("data", fc::json::to_string(data_)));
+                    } catch (const fc::exception& e) {
+                        msg.error(JSON_RPC_INTERNAL_ERROR, std::string("Internal error: ") + e.to_string(), e);
+                        call.error("invalid request");
+                    } catch (const std::exception& e) {
+                        msg.error(JSON_RPC_INTERNAL_ERROR, std::string("Internal error: ") + e.what());
+                        call.error(e.what());
+                    } catch (...) {
+                        msg.error(JSON_RPC_INTERNAL_ERROR, "Unknown error - parsing rpc message failed");
+                        call.error("unknown");
                     }
 
-                    ~dump_rpc_time() {
-                        if (error_.empty()) {
-                            dlog(
-                                "elapsed: ${time} sec, data: ${data}",
-                                ("data", fc::json::to_string(data_))
-                                ("time", double((fc::time_point::now() - start_).count()) / 1000000.0));
-                        } else {
-                            dlog(
-                                "elapsed: ${time} sec, error: '${error}', data: ${data}",
-                                ("data", fc::json::to_string(data_))
-                                ("error", error_)
-                                ("time", double((fc::time_point::now() - start_).count()) / 1000000.0));
-                        }
+                    if (!msg.method.empty()) {
+                        call.method(msg.plugin + "." + msg.method);
                     }
+                }
 
-                    void error(std::string value) {
-                        error_ = std::move(value);
+                void rpc(const fc::variant& data, uint64_t request_bytes, response_handler_type handler) {
+                    if (!request_bytes && _stats.enabled()) {
+                        request_bytes = fc::json::to_string(data).size();
                     }
 
-                private:
-                    fc::time_point start_ = fc::time_point::now();
-                    std::string error_;
-                    const fc::variant& data_;
-                };
+                    auto call = std::make_shared<rpc_call>(*this, data, request_bytes);
 
-                void rpc(const fc::variant& data, msg_pack& msg) {
-                    dump_rpc_time dump(data);
+                    msg_pack msg([call, handler = std::move(handler)](json_rpc_response &response){
+                        call->cache_result(response);
+                        auto result = to_json(response);
+                        call->response(result.size(), response.error.valid());
+                        handler(std::move(result));
+                    });
 
-                    try {
-                        rpc_jsonrpc(data, msg);
+                    rpc(data, msg, *call);
+                    call->executed();
+                }
 
-                    } catch (const fc::exception& e) {
-                        msg.error(JSON_RPC_INTERNAL_ERROR, std::string("Internal error: ") + e.to_string(), e);
-                        dump.error("invalid request");
-                    } catch (const std::exception& e) {
-                        msg.error(JSON_RPC_INTERNAL_ERROR, std::string("Internal error: ") + e.what());
-                        dump.error(e.what());
-                    } catch (...) {
-                        msg.error(JSON_RPC_INTERNAL_ERROR, "Unknown error - parsing rpc message failed");
-                        dump.error("unknown");
+                static std::string to_json(json_rpc_response& response) {
+                    if (response.json_result.empty()) {
+                        return fc::json::to_string(response);
                     }
+
+                    // the same order of fields as in the reflection of json_rpc_response
+                    auto jsonrpc = fc::json::to_string(fc::variant(response.jsonrpc));
+                    auto id = fc::json::to_string(response.id);
+                    std::string result;
+                    result.reserve(response.json_result.size() + jsonrpc.size() + id.size() + 32);
+                    result += "{\"jsonrpc\":";
+                    result += jsonrpc;
+                    result += ",\"result\":";
+                    result += response.json_result;
+                    result += ",\"id\":";
+                    result += id;
+                    result += '}';
+                    response.json_result.clear();
+                    response.json_result.shrink_to_fit();
+                    return result;
+                }
+
+                static std::string join_responses(const vector<std::string>& responses) {
+                    return "[" + boost::algorithm::join(responses, ",") + "]";
                 }
 
                 void rpc(vector<fc::variant> messages, response_handler_type response_handler) {
-                    auto responses = std::make_shared<vector<json_rpc_response>>();
+                    auto responses = std::make_shared<vector<std::string>>();
 
                     responses->reserve(messages.size());
 
                     std::function<void()> next_handler = [response_handler, responses]{
-                        response_handler(fc::json::to_string(*responses.get()));
+                        response_handler(join_responses(*responses.get()));
                     };
 
                     for (auto it = messages.rbegin(); messages.rend() != it; ++it) {
                         auto v = *it;
 
                         next_handler = [next_handler, responses, v, this]{
-                            msg_pack msg([next_handler, responses](json_rpc_response &response){
+                            this->rpc(v, 0, [next_handler, responses](const std::string &response){
                                 responses->push_back(response);
                                 next_handler();
                             });
-
-                            this->rpc(v, msg);
                         };
                     }
 
                     next_handler();
                 }
 
+                void rpc_concurrent(vector<fc::variant> messages, response_handler_type response_handler) {
+                    struct batch_state final {
+                        vector<std::string> responses;
+                        std::atomic<size_t> left;
+                        response_handler_type response_handler;
+                    };
+
+                    auto state = std::make_shared<batch_state>();
+                    state->responses.resize(messages.size());
+                    state->left = messages.size();
+                    state->response_handler = std::move(response_handler);
+
+                    auto make_task = [state, this](size_t i, fc::variant v) {
+                        return [state, i, v = std::move(v), this]{
+                            this->rpc(v, 0, [state, i](const std::string &response){
+                                state->responses[i] = response;
+                                if (--state->left == 0) {
+                                    state->response_handler(join_responses(state->responses));
+                                }
+                            });
+                        };
+                    };
+
+                    // the first item is processed in the current thread
+                    for (size_t i = 1; i < messages.size(); ++i) {
+                        _batch_executor(make_task(i, std::move(messages[i])));
+                    }
+                    make_task(0, std::move(messages[0]))();
+                }
+
                 void call(const string &message, response_handler_type response_handler) {
                     auto send_error = [response_handler](int32_t code, const std::string& msg, fc::optional<fc::variant> d = fc::optional<fc::variant>()) {
                         json_rpc_response response;
@@ -369,13 +546,13 @@ namespace golos {
                             if(messages.size() == 0) {
                                 return send_error(JSON_RPC_INVALID_REQUEST, "Array of requests must be non-empty");
                             }
-                            rpc(messages, response_handler);
+                            if (_batch_executor && messages.size() > 1) {
+                                rpc_concurrent(std::move(messages), response_handler);
+                            } else {
+                                rpc(messages, response_handler);
+                            }
                         } else {
-                            msg_pack msg([response_handler](json_rpc_response &response){
-                                    response_handler(fc::json::to_string(response));
-                                    });
-
-                            rpc(v, msg);
+                            rpc(v, message.size(), response_handler);
                         }
                     } catch (const fc::exception &e) {
                         return send_error(JSON_RPC_INTERNAL_ERROR, e.to_string(), e);
@@ -403,6 +580,10 @@ namespace golos {
                     return _method_reindex[method_name];                        
                 }
 
+                plugin::task_executor_type _batch_executor;
+                rpc_stats _stats;
+                response_cache _cache;
+                uint64_t _slow_call_us = 0;
                 map<string, api_description> _registered_apis;
                 vector<string> _methods;
                 map<string, map<string, api_method_signature> > _method_sigs;
@@ -422,10 +603,58 @@ namespace golos {
             plugin::~plugin() {
             }
 
+            void plugin::set_program_options(
+                boost::program_options::options_description &cli,
+                boost::program_options::options_description &cfg
+            ) {
+                cfg.add_options()
+                    ("rpc-stats", boost::program_options::value<bool>()->default_value(false),
+                        "Collect latencies and sizes of API calls by methods (see get_rpc_stats). Default: false")
+                    ("rpc-slow-call-ms", boost::program_options::value<uint32_t>()->default_value(0),
+                        "Log API calls which take longer than this number of milliseconds with their params. "
+                        "0 disables the log. Default: 0")
+                    ("rpc-cache-method", boost::program_options::value<std::vector<std::string>>()->composing()->multitoken(),
+                        "Cache results of the read-only API method (api.method) till the next block, "
+                        "or for TTL milliseconds if it's set as api.method=TTL. Can be specified multiple times")
+                    ("rpc-cache-size-mb", boost::program_options::value<uint32_t>()->default_value(64),
+                        "Maximum size of cached results of API methods in megabytes. Default: 64");
+            }
+
             void plugin::plugin_initialize(const boost::program_options::variables_map &options) {
                 ilog("json_rpc plugin: plugin_initialize() begin");
                 pimpl = std::make_unique<impl>();
                 pimpl->initialize();
+                if (options.count("rpc-stats")) {
+                    pimpl->_stats.enable(options.at("rpc-stats").as<bool>());
+                }
+                if (options.count("rpc-slow-call-ms")) {
+                    pimpl->_slow_call_us = uint64_t(options.at("rpc-slow-call-ms").as<uint32_t>()) * 1000;
+                }
+                if (options.count("rpc-cache-size-mb")) {
+                    pimpl->_cache.set_max_size(uint64_t(options.at("rpc-cache-size-mb").as<uint32_t>()) << 20);
+                }
+                if (options.count("rpc-cache-method")) {
+                    for (const auto &item: options.at("rpc-cache-method").as<std::vector<std::string>>()) {
+                        std::vector<std::string> values;
+                        boost::split(values, item, boost::is_any_of(" \t"));
+                        for (const auto &value: values) {
+                            if (value.empty()) {
+                                continue;
+                            }
+                            auto pos = value.find('=');
+                            auto method = value.substr(0, pos);
+                            FC_ASSERT(method.find('.') != std::string::npos,
+                                "rpc-cache-method should be api.method or api.method=TTL", ("value", value));
+                            uint32_t ttl = 0;
+                            if (pos != std::string::npos) {
+                                ttl = boost::lexical_cast<uint32_t>(value.substr(pos + 1));
+                            }
+                            pimpl->_cache.add_method(method, response_cache::milliseconds(ttl));
+                            ilog("Caching results of ${method} ${mode}",
+                                ("method", method)("mode", ttl ? "for " + std::to_string(ttl) + " ms" : "till next block"));
+                        }
+                    }
+                }
                 ilog("json_rpc plugin: plugin_initialize() end");
             }
 
@@ -449,6 +678,18 @@ namespace golos {
             void plugin::call(const string &message, response_handler_type response_handler) {
                 pimpl->call(message, response_handler);
             }
+
+            void plugin::set_batch_executor(task_executor_type executor) {
+                pimpl->_batch_executor = std::move(executor);
+            }
+
+            response_cache &plugin::get_response_cache() {
+                return pimpl->_cache;
+            }
+
+            rpc_stats &plugin::get_rpc_stats() {
+                return pimpl->_stats;
+            }
         }
     }
 } // golos::plugins::json_rpc
@@ -0,0 +1,173 @@
+#include <golos/plugins/json_rpc/response_cache.hpp>
+
+#include <fc/io/json.hpp>
+
+#include <list>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+
+namespace golos { namespace plugins { namespace json_rpc {
+
+    namespace {
+
+        using clock_type = std::chrono::steady_clock;
+
+        // approximate memory of an entry besides its strings
+        constexpr uint64_t entry_overhead = 128;
+
+        struct cache_method final {
+            response_cache::milliseconds ttl{0};
+            uint64_t hits = 0;
+            uint64_t misses = 0;
+        };
+
+        struct cache_entry final {
+            std::string key;
+            std::string json;
+            bool till_block = true;
+            clock_type::time_point expires;
+
+            uint64_t size() const {
+                return key.size() + json.size() + entry_overhead;
+            }
+        };
+
+    } // namespace
+
+    struct response_cache::impl final {
+        using lru_type = std::list<cache_entry>;
+
+        void erase(lru_type::iterator itr) {
+            size -= itr->size();
+            entries.erase(itr->key);
+            lru.erase(itr);
+        }
+
+        std::map<std::string, cache_method> methods;
+        uint64_t max_size = 64 << 20;
+
+        mutable std::mutex mutex;
+        lru_type lru; // the most recently used entries are at the front
+        std::unordered_map<std::string, lru_type::iterator> entries;
+        uint64_t size = 0;
+        uint64_t generation = 0;
+    };
+
+    response_cache::response_cache(): _impl(new impl()) {
+    }
+
+    response_cache::~response_cache() {
+    }
+
+    void response_cache::add_method(const std::string& method, milliseconds ttl) {
+        _impl->methods[method].ttl = ttl;
+    }
+
+    void response_cache::set_max_size(uint64_t bytes) {
+        _impl->max_size = bytes;
+    }
+
+    bool response_cache::enabled() const {
+        return !_impl->methods.empty() && _impl->max_size > 0;
+    }
+
+    std::string response_cache::key(
+        const std::string& method, const fc::optional<std::vector<fc::variant>>& args
+    ) const {
+        if (!enabled() || !_impl->methods.count(method)) {
+            return std::string();
+        }
+        if (!args.valid()) {
+            return method + "[]";
+        }
+        return method + fc::json::to_string(fc::variant(*args));
+    }
+
+    fc::optional<std::string> response_cache::get(const std::string& method, const std::string& key) {
+        std::lock_guard<std::mutex> lock(_impl->mutex);
+        auto& stats = _impl->methods[method];
+
+        auto itr = _impl->entries.find(key);
+        if (itr != _impl->entries.end()) {
+            auto entry = itr->second;
+            if (entry->till_block || clock_type::now() < entry->expires) {
+                _impl->lru.splice(_impl->lru.begin(), _impl->lru, entry);
+                ++stats.hits;
+                return entry->json;
+            }
+            _impl->erase(entry);
+        }
+
+        ++stats.misses;
+        return {};
+    }
+
+    uint64_t response_cache::generation() const {
+        std::lock_guard<std::mutex> lock(_impl->mutex);
+        return _impl->generation;
+    }
+
+    void response_cache::put(
+        const std::string& method, const std::string& key, const std::string& json, uint64_t generation
+    ) {
+        auto ttl = _impl->methods.at(method).ttl;
+
+        cache_entry entry;
+        entry.key = key;
+        entry.json = json;
+        entry.till_block = ttl.count() == 0;
+        entry.expires = clock_type::now() + ttl;
+        if (entry.size() > _impl->max_size) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(_impl->mutex);
+        // the result was read from the state before the last block
+        if (entry.till_block && generation != _impl->generation) {
+            return;
+        }
+
+        auto itr = _impl->entries.find(key);
+        if (itr != _impl->entries.end()) {
+            _impl->erase(itr->second);
+        }
+        while (!_impl->lru.empty() && _impl->size + entry.size() > _impl->max_size) {
+            _impl->erase(std::prev(_impl->lru.end()));
+        }
+
+        _impl->size += entry.size();
+        _impl->lru.push_front(std::move(entry));
+        _impl->entries.emplace(key, _impl->lru.begin());
+    }
+
+    void response_cache::on_block() {
+        std::lock_guard<std::mutex> lock(_impl->mutex);
+        ++_impl->generation;
+        for (auto itr = _impl->lru.begin(); itr != _impl->lru.end();) {
+            auto entry = itr++;
+            if (entry->till_block) {
+                _impl->erase(entry);
+            }
+        }
+    }
+
+    response_cache_stats response_cache::get_stats() const {
+        response_cache_stats result;
+
+        std::lock_guard<std::mutex> lock(_impl->mutex);
+        result.entries = _impl->entries.size();
+        result.size_bytes = _impl->size;
+        result.max_size_bytes = _impl->max_size;
+        result.methods.reserve(_impl->methods.size());
+        for (const auto& method: _impl->methods) {
+            response_cache_item item;
+            item.method = method.first;
+            item.hits = method.second.hits;
+            item.misses = method.second.misses;
+            result.methods.push_back(std::move(item));
+        }
+        return result;
+    }
+
+} } } // golos::plugins::json_rpc
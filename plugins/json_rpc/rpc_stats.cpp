@@ -0,0 +1,71 @@
+#include <golos/plugins/json_rpc/rpc_stats.hpp>
+
+#include <algorithm>
+
+namespace golos { namespace plugins { namespace json_rpc {
+
+    const std::vector<uint64_t> rpc_stats::time_buckets = {
+        100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 500000, 1000000, 5000000};
+
+    namespace {
+
+        uint64_t percentile(const rpc_stats_item& item, uint64_t percent) {
+            auto rank = (item.count * percent + 99) / 100;
+            uint64_t sum = 0;
+            for (std::size_t i = 0; i < item.histogram.size(); ++i) {
+                sum += item.histogram[i];
+                if (sum >= rank) {
+                    return i < rpc_stats::time_buckets.size() ?
+                        std::min(rpc_stats::time_buckets[i], item.max_us) : item.max_us;
+                }
+            }
+            return item.max_us;
+        }
+
+    } // namespace
+
+    void rpc_stats::add(
+        const std::string& method, uint64_t time_us, uint64_t lock_wait_us,
+        uint64_t request_bytes, uint64_t response_bytes, bool error
+    ) {
+        auto bucket = std::lower_bound(time_buckets.begin(), time_buckets.end(), time_us) - time_buckets.begin();
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto& item = _items[method];
+        if (item.histogram.empty()) {
+            item.method = method;
+            item.histogram.resize(time_buckets.size() + 1);
+        }
+
+        ++item.count;
+        if (error) {
+            ++item.errors;
+        }
+        item.request_bytes += request_bytes;
+        item.response_bytes += response_bytes;
+        item.total_us += time_us;
+        item.max_us = std::max(item.max_us, time_us);
+        item.lock_wait_us += lock_wait_us;
+        ++item.histogram[bucket];
+    }
+
+    std::vector<rpc_stats_item> rpc_stats::get() const {
+        std::vector<rpc_stats_item> result;
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        result.reserve(_items.size());
+        for (const auto& item: _items) {
+            result.push_back(item.second);
+            auto& r = result.back();
+            r.p50_us = percentile(r, 50);
+            r.p99_us = percentile(r, 99);
+        }
+        return result;
+    }
+
+    void rpc_stats::clear() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _items.clear();
+    }
+
+} } } // golos::plugins::json_rpc
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <fc/reflect/reflect.hpp>
+
+#include <boost/filesystem/path.hpp>
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace golos {
+namespace plugins {
+namespace mongo_db {
+
+    /**
+     * A formatted write to one collection. Documents are stored as raw BSON,
+     *   so a request can be spilled to disk and restored without reformatting.
+     */
+    struct write_request final {
+        enum request_type: uint8_t {
+            insert_one,
+            upsert_one,
+            update_many,
+            replace_one ///< upsert of the whole document by filter on _id
+        };
+
+        uint8_t type = insert_one;
+        std::string collection;
+        std::string filter;
+        std::string doc;
+        std::vector<std::string> indexes;
+    };
+
+    /**
+     * All writes produced for a series of irreversible blocks, the last of them is block_num.
+     */
+    struct write_batch final {
+        uint32_t block_num = 0;
+        std::vector<write_request> requests;
+    };
+
+    /**
+     * Bounded queue of batches between the block-apply thread and the writer thread.
+     *
+     * When the memory part is full, new batches are written to files in the spill directory
+     *   and are read back after the memory part is drained, so the order of batches is kept.
+     * Batches left on shutdown are spilled too, the writer resumes from them on the next start.
+     */
+    class write_queue final {
+    public:
+        write_queue(const boost::filesystem::path& spill_dir, uint32_t max_size);
+
+        void push(write_batch batch);
+
+        /**
+         * Waits for the next batch. Returns false if the queue was stopped.
+         * The batch stays in the queue until pop() is called.
+         */
+        bool front(write_batch& batch);
+
+        void pop();
+
+        /// Saves a batch which can't be written to the failed directory, it can be written later manually
+        boost::filesystem::path park(const write_batch& batch);
+
+        /// Stops waiting in front() and spills batches from memory to disk, later batches are spilled on push()
+        void stop();
+
+        uint32_t memory_size() const;
+
+        uint32_t spilled_size() const;
+
+        uint32_t last_block_num() const;
+
+    private:
+        boost::filesystem::path spill_file(uint32_t block_num) const;
+
+        void write_file(const boost::filesystem::path& path, const write_batch& batch) const;
+
+        void spill(const write_batch& batch);
+
+        write_batch restore(uint32_t block_num) const;
+
+        const boost::filesystem::path spill_dir_;
+        const uint32_t max_size_;
+
+        std::deque<write_batch> memory_;
+        std::deque<uint32_t> spilled_;
+        uint32_t last_block_num_ = 0;
+        bool stopped_ = false;
+
+        mutable std::mutex mutex_;
+        std::condition_variable cond_;
+    };
+
+}}} // golos::plugins::mongo_db
+
+FC_REFLECT((golos::plugins::mongo_db::write_request), (type)(collection)(filter)(doc)(indexes))
+FC_REFLECT((golos::plugins::mongo_db::write_batch), (block_num)(requests))
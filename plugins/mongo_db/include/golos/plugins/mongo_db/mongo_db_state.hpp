@@ -95,6 +95,9 @@ namespace mongo_db {
 
         db_map &all_docs;
 
+        // number of documents of operations in the block, used for their _id
+        uint32_t op_docs_count = 0;
+
         bool format_comment(const std::string& auth, const std::string& perm);
 
         void format_account(const account_object& account);
@@ -6,6 +6,7 @@
 
 #include <golos/plugins/mongo_db/mongo_db_types.hpp>
 #include <golos/plugins/mongo_db/mongo_db_state.hpp>
+#include <golos/plugins/mongo_db/mongo_db_queue.hpp>
 
 #include <libraries/chain/include/golos/chain/operation_notification.hpp>
 
@@ -20,6 +21,7 @@
 
 #include <appbase/application.hpp>
 
+#include <atomic>
 #include <thread>
 #include <map>
 #include <mutex>
@@ -39,13 +41,22 @@ namespace mongo_db {
 
     using bulk_ptr = std::unique_ptr<mongocxx::bulk_write>;
 
+    /**
+     * Documents are formatted on the block-apply path, because they read the chain state,
+     *   and are written to MongoDB by a separate thread through the write_queue,
+     *   so a slow or unavailable MongoDB doesn't stall block application.
+     */
     class mongo_db_writer final {
     public:
         mongo_db_writer();
         ~mongo_db_writer();
 
         bool initialize(const std::string& uri_str, const bool write_raw, const std::vector<std::string>& op,
-            unsigned int store_history_dgp, unsigned int store_history_wso);
+            unsigned int store_history_dgp, unsigned int store_history_wso,
+            const boost::filesystem::path& queue_dir, uint32_t queue_size);
+
+        void startup();
+        void shutdown();
 
         void on_block(const signed_block& block);
         void on_operation(const golos::chain::operation_notification& note);
@@ -62,7 +73,11 @@ namespace mongo_db {
         void format_block_info(const signed_block& block, document& doc);
         void format_transaction_info(const signed_transaction& tran, document& doc);
 
-        void write_data();
+        void write_loop();
+        void write_data(const write_batch& batch);
+        uint32_t read_checkpoint();
+        void write_checkpoint(uint32_t block_num);
+        void print_queue_stats();
 
         uint64_t processed_blocks = 0;
 
@@ -74,8 +89,14 @@ namespace mongo_db {
         std::map<uint32_t, operations> virtual_ops;
         std::map<uint32_t, dynamic_global_property_object> dgp_s;
         std::map<uint32_t, witness_schedule_object> wso_s;
-        // Table name, bulk write
-        std::map<std::string, bulk_ptr> formatted_blocks;
+        // Writes of current series of blocks
+        write_batch formatted_blocks;
+
+        std::unique_ptr<write_queue> queue;
+        std::thread writer_thread;
+        std::atomic<bool> stopping{false};
+        // The last block written to MongoDB, older blocks are skipped
+        std::atomic<uint32_t> checkpoint_block_num{0};
 
         bool write_raw_blocks;
         flat_set<std::string> write_operations;
@@ -89,7 +110,8 @@ namespace mongo_db {
         mongocxx::client mongo_conn;
         mongocxx::options::bulk_write bulk_opts;
 
-        std::unordered_map<std::string, std::string> indexes; // Prevent repeative create_index() calls. Only in current session 
+        std::unordered_map<std::string, std::string> indexes; // Prevent repeative create_index() calls. Only in current session
+        std::unordered_map<std::string, std::string> requested_indexes; // The same for requests from block-apply thread
 
         golos::chain::database &_db;
     };
@@ -18,8 +18,10 @@ namespace mongo_db {
         }
 
         bool initialize(const std::string& uri, const bool write_raw, const std::vector<std::string>& op,
-            unsigned int store_history_dgp, unsigned int store_history_wso) {
-            return writer.initialize(uri, write_raw, op, store_history_dgp, store_history_wso);
+            unsigned int store_history_dgp, unsigned int store_history_wso,
+            const boost::filesystem::path& queue_dir, uint32_t queue_size) {
+            return writer.initialize(uri, write_raw, op, store_history_dgp, store_history_wso,
+                queue_dir, queue_size);
         }
 
         ~mongo_db_plugin_impl() = default;
@@ -70,7 +72,13 @@ namespace mongo_db {
              "Mode of storing global_property_object history for each N block")
             ("mongodb-store-wso-history",
              boost::program_options::value<unsigned int>()->default_value(100),
-             "Mode of storing witness_schedule_object history for each N block");
+             "Mode of storing witness_schedule_object history for each N block")
+            ("mongodb-queue-size",
+             boost::program_options::value<uint32_t>()->default_value(1000),
+             "Max number of block series waiting in memory for writing into mongo, the rest are saved to disk")
+            ("mongodb-queue-dir",
+             boost::program_options::value<boost::filesystem::path>()->default_value("mongo_db_queue"),
+             "Directory for block series waiting for writing into mongo (absolute path or relative to application data dir)");
         cfg.add(cli);
     }
 
@@ -94,6 +102,14 @@ namespace mongo_db {
             if (options.count("mongodb-store-wso-history")) {
                 store_history_wso = options.at("mongodb-store-wso-history").as<unsigned int>();
             }
+            uint32_t queue_size = 1000;
+            if (options.count("mongodb-queue-size")) {
+                queue_size = options.at("mongodb-queue-size").as<uint32_t>();
+            }
+            auto queue_dir = options.at("mongodb-queue-dir").as<boost::filesystem::path>();
+            if (queue_dir.is_relative()) {
+                queue_dir = appbase::app().data_dir() / queue_dir;
+            }
 
             // First init mongo db
             if (options.count("mongodb-uri")) {
@@ -102,7 +118,8 @@ namespace mongo_db {
 
                 pimpl_ = std::make_unique<mongo_db_plugin_impl>(*this);
 
-                if (!pimpl_->initialize(uri_str, raw_blocks, write_operations, store_history_dgp, store_history_wso)) {
+                if (!pimpl_->initialize(uri_str, raw_blocks, write_operations, store_history_dgp, store_history_wso,
+                        queue_dir, queue_size)) {
                     ilog("Cannot initialize MongoDB plugin. Plugin disabled.");
                     pimpl_.reset();
                     return;
@@ -129,12 +146,20 @@ namespace mongo_db {
     void mongo_db_plugin::plugin_startup() {
         ilog("mongo_db plugin: plugin_startup() begin");
 
+        if (pimpl_) {
+            pimpl_->writer.startup();
+        }
+
         ilog("mongo_db plugin: plugin_startup() end");
     }
 
     void mongo_db_plugin::plugin_shutdown() {
         ilog("mongo_db plugin: plugin_shutdown() begin");
 
+        if (pimpl_) {
+            pimpl_->writer.shutdown();
+        }
+
         ilog("mongo_db plugin: plugin_shutdown() end");
     }
 
@@ -0,0 +1,157 @@
+#include <golos/plugins/mongo_db/mongo_db_queue.hpp>
+
+#include <fc/io/raw.hpp>
+#include <fc/log/logger.hpp>
+#include <fc/exception/exception.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+namespace golos {
+namespace plugins {
+namespace mongo_db {
+
+    namespace bfs = boost::filesystem;
+
+    write_queue::write_queue(const bfs::path& spill_dir, uint32_t max_size)
+        : spill_dir_(spill_dir),
+          max_size_(std::max<uint32_t>(max_size, 1)) {
+
+        bfs::create_directories(spill_dir_);
+
+        for (bfs::directory_iterator itr(spill_dir_), end; itr != end; ++itr) {
+            if (!bfs::is_regular_file(itr->path()) || itr->path().extension() != ".batch") {
+                continue;
+            }
+            try {
+                spilled_.push_back(std::stoul(itr->path().stem().string()));
+            } catch (...) {
+                wlog("Skip unknown file ${f} in MongoDB queue directory", ("f", itr->path().string()));
+            }
+        }
+
+        std::sort(spilled_.begin(), spilled_.end());
+        if (!spilled_.empty()) {
+            last_block_num_ = spilled_.back();
+            ilog("MongoDB queue has ${n} batches from previous run, blocks ${from}...${to}",
+                ("n", spilled_.size())("from", spilled_.front())("to", spilled_.back()));
+        }
+    }
+
+    bfs::path write_queue::spill_file(uint32_t block_num) const {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%010u.batch", block_num);
+        return spill_dir_ / name;
+    }
+
+    void write_queue::write_file(const bfs::path& path, const write_batch& batch) const {
+        auto data = fc::raw::pack(batch);
+        std::ofstream stream(path.string(), std::ios::out | std::ios::binary | std::ios::trunc);
+        stream.write(data.data(), data.size());
+        FC_ASSERT(stream.good(), "Can't write MongoDB queue file ${f}", ("f", path.string()));
+    }
+
+    void write_queue::spill(const write_batch& batch) {
+        write_file(spill_file(batch.block_num), batch);
+        spilled_.push_back(batch.block_num);
+    }
+
+    bfs::path write_queue::park(const write_batch& batch) {
+        auto dir = spill_dir_ / "failed";
+        bfs::create_directories(dir);
+        auto path = dir / spill_file(batch.block_num).filename();
+        write_file(path, batch);
+        return path;
+    }
+
+    write_batch write_queue::restore(uint32_t block_num) const {
+        auto path = spill_file(block_num);
+        std::ifstream stream(path.string(), std::ios::in | std::ios::binary);
+        FC_ASSERT(stream.good(), "Can't read MongoDB queue file ${f}", ("f", path.string()));
+
+        std::vector<char> data((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+        return fc::raw::unpack<write_batch>(data);
+    }
+
+    void write_queue::push(write_batch batch) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        last_block_num_ = batch.block_num;
+        // after the stop the memory part isn't saved anymore
+        if (stopped_ || !spilled_.empty() || memory_.size() >= max_size_) {
+            spill(batch);
+        } else {
+            memory_.push_back(std::move(batch));
+        }
+        cond_.notify_one();
+    }
+
+    bool write_queue::front(write_batch& batch) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cond_.wait(lock, [&]() {
+            return stopped_ || !memory_.empty() || !spilled_.empty();
+        });
+
+        if (stopped_) {
+            return false;
+        }
+
+        // spilled batches are always newer than ones in memory
+        if (!memory_.empty()) {
+            batch = memory_.front();
+        } else {
+            batch = restore(spilled_.front());
+        }
+        return true;
+    }
+
+    void write_queue::pop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!memory_.empty()) {
+            memory_.pop_front();
+        } else if (!spilled_.empty()) {
+            bfs::remove(spill_file(spilled_.front()));
+            spilled_.pop_front();
+        }
+    }
+
+    void write_queue::stop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        stopped_ = true;
+        cond_.notify_all();
+
+        if (memory_.empty()) {
+            return;
+        }
+
+        ilog("Saving ${n} MongoDB batches to ${d}", ("n", memory_.size())("d", spill_dir_.string()));
+
+        // keep order: batches from memory go before already spilled ones
+        std::deque<uint32_t> spilled;
+        spilled.swap(spilled_);
+        for (const auto& batch: memory_) {
+            spill(batch);
+        }
+        spilled_.insert(spilled_.end(), spilled.begin(), spilled.end());
+        memory_.clear();
+    }
+
+    uint32_t write_queue::memory_size() const {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return memory_.size();
+    }
+
+    uint32_t write_queue::spilled_size() const {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return spilled_.size();
+    }
+
+    uint32_t write_queue::last_block_num() const {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return last_block_num_;
+    }
+
+}}} // golos::plugins::mongo_db
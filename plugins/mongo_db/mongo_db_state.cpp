@@ -38,6 +38,15 @@ namespace mongo_db {
         doc.key = key;
         doc.keyval = keyval;
         doc.is_removal = false;
+
+        // documents of operations get _id from the block and their order in it,
+        //  so they are the same when blocks are written again after a restart
+        if (keyval.empty()) {
+            auto oid = name + "/" + std::to_string(state_block.block_num()) + "/" + std::to_string(op_docs_count++);
+            doc.key = "_id";
+            doc.keyval = hash_oid(oid);
+            format_oid(doc.doc, oid);
+        }
         return doc;
     }
 
@@ -127,7 +136,7 @@ namespace mongo_db {
                 auto con_itr = con_idx.find(comment.id);
                 if (con_itr != con_idx.end()) {
                     format_value(body, "title", con_itr->title);
-                    format_value(body, "body", con_itr->body);
+                    format_value(body, "body", golos::plugins::social_network::get_comment_body(*con_itr));
                     format_json(body, "json_metadata", con_itr->json_metadata);
                 }
             }
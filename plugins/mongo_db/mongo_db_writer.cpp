@@ -8,6 +8,8 @@
 #include <appbase/application.hpp>
 
 #include <mongocxx/exception/exception.hpp>
+#include <mongocxx/options/update.hpp>
+#include <mongocxx/model/replace_one.hpp>
 #include <bsoncxx/array/element.hpp>
 #include <bsoncxx/builder/stream/array.hpp>
 
@@ -18,6 +20,8 @@
 #include <boost/multi_index/random_access_index.hpp>
 #include <boost/multi_index/sequenced_index.hpp>
 
+#include <chrono>
+
 namespace golos {
 namespace plugins {
 namespace mongo_db {
@@ -30,15 +34,27 @@ namespace mongo_db {
     using bsoncxx::builder::stream::open_document;
     using bsoncxx::builder::stream::close_document;
 
+    static const std::string checkpoint_collection = "export_checkpoint";
+
+    static std::string to_raw(const bsoncxx::document::view& view) {
+        return std::string(reinterpret_cast<const char*>(view.data()), view.length());
+    }
+
+    static bsoncxx::document::view to_view(const std::string& raw) {
+        return bsoncxx::document::view(reinterpret_cast<const uint8_t*>(raw.data()), raw.size());
+    }
+
     mongo_db_writer::mongo_db_writer() :
         _db(appbase::app().get_plugin<golos::plugins::chain::plugin>().db()) {
     }
 
     mongo_db_writer::~mongo_db_writer() {
+        shutdown();
     }
 
     bool mongo_db_writer::initialize(const std::string& uri_str, const bool write_raw, const std::vector<std::string>& ops,
-        unsigned int store_history_dgp, unsigned int store_history_wso) {
+        unsigned int store_history_dgp, unsigned int store_history_wso,
+        const boost::filesystem::path& queue_dir, uint32_t queue_size) {
         try {
             uri = mongocxx::uri {uri_str};
             mongo_conn = mongocxx::client {uri};
@@ -55,6 +71,15 @@ namespace mongo_db {
                 }
             }
 
+            queue = std::make_unique<write_queue>(queue_dir, queue_size);
+
+            try {
+                checkpoint_block_num = read_checkpoint();
+                ilog("MongoDB has blocks up to ${n}", ("n", checkpoint_block_num.load()));
+            } catch (const std::exception& e) {
+                wlog("Can't read MongoDB checkpoint, it will be read by writer thread: ${e}", ("e", e.what()));
+            }
+
             ilog("MongoDB writer initialized.");
 
             return true;
@@ -84,9 +109,21 @@ namespace mongo_db {
 
                 db_map all_docs;
 
+                // Blocks up to it are already written to MongoDB or are in the queue from previous run
+                auto written_block_num = std::max(checkpoint_block_num.load(), queue->last_block_num());
+
                 // Write all the blocks that has num less then last irreversible block
                 while (!blocks.empty() && blocks.begin()->first <= last_irreversible_block_num) {
                     auto head_iter = blocks.begin();
+                    auto head_num = head_iter->first;
+
+                    if (head_num <= written_block_num) {
+                        dgp_s.erase(head_num);
+                        wso_s.erase(head_num);
+                        virtual_ops.erase(head_num);
+                        blocks.erase(head_iter);
+                        continue;
+                    }
 
                     try {
                         if (write_raw_blocks) {
@@ -117,16 +154,17 @@ namespace mongo_db {
                     }
                     catch (...) {
                         // If some block causes any problems lets remove it from buffer and move on
+                        dgp_s.erase(head_num);
+                        wso_s.erase(head_num);
+                        virtual_ops.erase(head_num);
                         blocks.erase(head_iter);
-                        dgp_s.erase(head_iter->first);
-                        wso_s.erase(head_iter->first);
-                        virtual_ops.erase(head_iter->first);
                         throw;
                     }
+                    dgp_s.erase(head_num);
+                    wso_s.erase(head_num);
+                    virtual_ops.erase(head_num);
                     blocks.erase(head_iter);
-                    dgp_s.erase(head_iter->first);
-                    wso_s.erase(head_iter->first);
-                    virtual_ops.erase(head_iter->first);
+                    formatted_blocks.block_num = head_num;
                 }
 
                 // End of blocks series. Writing all docs to bulk
@@ -141,12 +179,18 @@ namespace mongo_db {
                     }
                 }
 
-                // Writing bulk to mongo
+                // Passing bulk to the writer thread
 
-                write_data();
+                if (formatted_blocks.block_num != 0) {
+                    queue->push(std::move(formatted_blocks));
+                }
+                formatted_blocks = write_batch();
             }
 
             ++processed_blocks;
+            if (processed_blocks % 1000 == 0) {
+                print_queue_stats();
+            }
         }
         catch (const std::exception& e) {
             wlog("Unknown exception in MongoDB ${e}", ("e", e.what()));
@@ -216,55 +260,55 @@ namespace mongo_db {
         block_doc << transactions << transactions_array;
 
         static const std::string blocks = "blocks";
-        if (formatted_blocks.find(blocks) == formatted_blocks.end()) {
-            formatted_blocks[blocks] = std::make_unique<mongocxx::bulk_write>(bulk_opts);
-        }
-
-        mongocxx::model::insert_one insert_msg{block_doc.view()};
-        formatted_blocks[blocks]->append(insert_msg);
+        document filter;
+        filter << "_id" << static_cast<int64_t>(block.block_num());
+
+        write_request insert_msg;
+        insert_msg.type = write_request::replace_one;
+        insert_msg.collection = blocks;
+        insert_msg.filter = to_raw(filter.view());
+        insert_msg.doc = to_raw(block_doc.view());
+        formatted_blocks.requests.push_back(std::move(insert_msg));
     }
 
     void mongo_db_writer::write_document(named_document const& named_doc) {
-        if (formatted_blocks.find(named_doc.collection_name) == formatted_blocks.end()) {
-            formatted_blocks[named_doc.collection_name] = std::make_unique<mongocxx::bulk_write>(bulk_opts);
-        }
+        write_request msg;
+        msg.collection = named_doc.collection_name;
 
+        // all documents have deterministic _id and are upserted, so blocks can be written again
         auto view = named_doc.doc.view();
-        auto itr = view.find("$set");
-        if (view.end() == itr) {
-            mongocxx::model::insert_one msg{std::move(view)};
-            formatted_blocks[named_doc.collection_name]->append(msg);
+        document filter;
+        filter << "_id" << bsoncxx::oid(named_doc.keyval);
+        msg.filter = to_raw(filter.view());
+        msg.doc = to_raw(view);
+        if (view.end() == view.find("$set")) {
+            msg.type = write_request::replace_one;
         } else {
-            document filter;
-
-            filter << "_id" << bsoncxx::oid(named_doc.keyval); 
-
-            mongocxx::model::update_one msg{filter.view(), view};
-            msg.upsert(true);
-            formatted_blocks[named_doc.collection_name]->append(msg);
+            msg.type = write_request::upsert_one;
         }
 
-        if (indexes.find(named_doc.collection_name) == indexes.end()) {
+        if (requested_indexes.find(named_doc.collection_name) == requested_indexes.end()) {
             for (auto& index_to_create : named_doc.indexes_to_create) {
-                mongo_database[named_doc.collection_name].create_index(index_to_create.view());
-                indexes[named_doc.collection_name] = "created";
+                msg.indexes.push_back(to_raw(index_to_create.view()));
+                requested_indexes[named_doc.collection_name] = "requested";
             }
         }
+
+        formatted_blocks.requests.push_back(std::move(msg));
     }
 
     void mongo_db_writer::remove_document(named_document const& named_doc) {
-        if (formatted_blocks.find(named_doc.collection_name) == formatted_blocks.end()) {
-            formatted_blocks[named_doc.collection_name] = std::make_unique<mongocxx::bulk_write>(bulk_opts);
-        }
-
         document filter;
         filter << named_doc.key << bsoncxx::oid(named_doc.keyval);
-        auto v1 = filter.view();
         document newval;
         newval << "$set" << open_document << "removed" << true << close_document;
-        auto v2 = newval.view();
-        mongocxx::model::update_many msg{v1, v2};
-        formatted_blocks[named_doc.collection_name]->append(msg);
+
+        write_request msg;
+        msg.type = write_request::update_many;
+        msg.collection = named_doc.collection_name;
+        msg.filter = to_raw(filter.view());
+        msg.doc = to_raw(newval.view());
+        formatted_blocks.requests.push_back(std::move(msg));
     }
 
     void mongo_db_writer::write_block_operations(state_writer& st_writer, const signed_block& block, const operations& ops) {
@@ -275,7 +319,8 @@ namespace mongo_db {
     }
 
     void mongo_db_writer::format_block_info(const signed_block& block, document& doc) {
-        doc << "block_num"              << static_cast<int32_t>(block.block_num())
+        doc << "_id"                    << static_cast<int64_t>(block.block_num())
+            << "block_num"              << static_cast<int32_t>(block.block_num())
             << "block_id"               << block.id().str()
             << "block_prev_block_id"    << block.previous.str()
             << "block_timestamp"        << block.timestamp
@@ -289,27 +334,167 @@ namespace mongo_db {
             << "transaction_expiration"     << tran.expiration;
     }
 
-    void mongo_db_writer::write_data() {
-        auto iter = formatted_blocks.begin();
-        for (; iter != formatted_blocks.end(); ++iter) {
+    void mongo_db_writer::startup() {
+        writer_thread = std::thread([this]() {
+            write_loop();
+        });
+    }
+
+    void mongo_db_writer::shutdown() {
+        stopping = true;
+        if (queue) {
+            queue->stop();
+        }
+        if (writer_thread.joinable()) {
+            writer_thread.join();
+        }
+    }
+
+    void mongo_db_writer::print_queue_stats() {
+        auto last_block_num = queue->last_block_num();
+        auto written_block_num = checkpoint_block_num.load();
+        ilog("MongoDB queue: ${m} batches in memory, ${s} batches on disk, lag ${l} blocks",
+            ("m", queue->memory_size())("s", queue->spilled_size())
+            ("l", last_block_num > written_block_num ? last_block_num - written_block_num : 0));
+    }
+
+    uint32_t mongo_db_writer::read_checkpoint() {
+        document filter;
+        filter << "_id" << MONGO_ID_SINGLE;
+
+        auto result = mongo_database[checkpoint_collection].find_one(filter.view());
+        if (!result) {
+            return 0;
+        }
+
+        auto element = result->view()["block_num"];
+        if (!element) {
+            return 0;
+        }
+        return static_cast<uint32_t>(element.get_int64().value);
+    }
+
+    void mongo_db_writer::write_checkpoint(uint32_t block_num) {
+        document filter;
+        filter << "_id" << MONGO_ID_SINGLE;
+        document value;
+        value << "$set" << open_document << "block_num" << static_cast<int64_t>(block_num) << close_document;
+
+        mongocxx::options::update opts;
+        opts.upsert(true);
+        mongo_database[checkpoint_collection].update_one(filter.view(), value.view(), opts);
+        checkpoint_block_num = block_num;
+    }
 
-            auto& oper = *iter;
+    void mongo_db_writer::write_loop() {
+        static constexpr int retry_sec = 1;
+        static constexpr int max_retry_sec = 60;
+        static constexpr uint32_t max_batch_retries = 10;
+
+        auto wait_retry = [&](int sec) {
+            for (int i = 0; i < sec * 10 && !stopping; ++i) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            }
+        };
+
+        while (!stopping) {
             try {
-                const std::string& collection_name = oper.first;
-                mongocxx::collection _collection = mongo_database[collection_name];
+                checkpoint_block_num = read_checkpoint();
+                break;
+            } catch (const std::exception& e) {
+                wlog("Can't read MongoDB checkpoint, retry after ${s} sec: ${e}", ("s", retry_sec)("e", e.what()));
+                wait_retry(retry_sec);
+            }
+        }
 
-                auto& bulkp = oper.second;
-                if (!_collection.bulk_write(*bulkp)) {
-                    wlog("Failed to write blocks to Mongo DB");
+        write_batch batch;
+        uint32_t retries = 0;
+        while (!stopping && queue->front(batch)) {
+            if (batch.block_num > checkpoint_block_num) {
+                try {
+                    write_data(batch);
+                    write_checkpoint(batch.block_num);
+                } catch (const std::exception& e) {
+                    if (++retries < max_batch_retries) {
+                        // batch stays in queue and will be written on next try
+                        auto sec = std::min(retry_sec << (retries - 1), max_retry_sec);
+                        wlog("Exception while writing blocks to mongo, retry ${r} after ${s} sec: ${e}",
+                            ("r", retries)("s", sec)("e", e.what()));
+                        wait_retry(sec);
+                        continue;
+                    }
+
+                    // writes are upserts, so the parked batch can be written again after the problem is fixed
+                    try {
+                        auto path = queue->park(batch);
+                        elog("Can't write blocks up to ${n} (${c} requests) to mongo after ${r} tries, "
+                            "the batch is saved to ${p}: ${e}",
+                            ("n", batch.block_num)("c", batch.requests.size())("r", retries)
+                            ("p", path.string())("e", e.what()));
+                    } catch (const fc::exception& pe) {
+                        elog("Can't write blocks up to ${n} (${c} requests) to mongo after ${r} tries "
+                            "and can't save the batch, it is dropped: ${e}, ${pe}",
+                            ("n", batch.block_num)("c", batch.requests.size())("r", retries)
+                            ("e", e.what())("pe", pe.to_string()));
+                    }
                 }
             }
-            catch (const std::exception& e) {
-                wlog("Unknown exception while writing blocks to mongo: ${e}", ("e", e.what()));
-                // If we got some errors writing block into mongo just skip this block and move on
-                formatted_blocks.erase(iter);
-                throw;
+            retries = 0;
+            queue->pop();
+        }
+    }
+
+    void mongo_db_writer::write_data(const write_batch& batch) {
+        // Table name, bulk write
+        std::map<std::string, bulk_ptr> bulks;
+
+        for (const auto& req: batch.requests) {
+            auto& bulkp = bulks[req.collection];
+            if (!bulkp) {
+                bulkp = std::make_unique<mongocxx::bulk_write>(bulk_opts);
+            }
+
+            switch (req.type) {
+                case write_request::insert_one: {
+                    mongocxx::model::insert_one msg{to_view(req.doc)};
+                    bulkp->append(msg);
+                    break;
+                }
+                case write_request::upsert_one: {
+                    mongocxx::model::update_one msg{to_view(req.filter), to_view(req.doc)};
+                    msg.upsert(true);
+                    bulkp->append(msg);
+                    break;
+                }
+                case write_request::update_many: {
+                    mongocxx::model::update_many msg{to_view(req.filter), to_view(req.doc)};
+                    bulkp->append(msg);
+                    break;
+                }
+                case write_request::replace_one: {
+                    mongocxx::model::replace_one msg{to_view(req.filter), to_view(req.doc)};
+                    msg.upsert(true);
+                    bulkp->append(msg);
+                    break;
+                }
+                default:
+                    wlog("Unknown type ${t} of MongoDB request", ("t", req.type));
+                    break;
+            }
+
+            if (!req.indexes.empty() && indexes.find(req.collection) == indexes.end()) {
+                for (auto& index_to_create : req.indexes) {
+                    mongo_database[req.collection].create_index(to_view(index_to_create));
+                }
+                indexes[req.collection] = "created";
+            }
+        }
+
+        for (auto& oper : bulks) {
+            mongocxx::collection _collection = mongo_database[oper.first];
+            if (!_collection.bulk_write(*oper.second)) {
+                wlog("Failed to write blocks to Mongo DB");
             }
         }
-        formatted_blocks.clear();
     }
 }}}
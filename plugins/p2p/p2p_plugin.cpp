@@ -61,6 +61,9 @@ namespace golos {
 
                     virtual message get_item(const item_id &) override;
 
+                    virtual uint32_t get_packed_blocks(uint32_t, uint32_t, uint32_t, std::vector<char> &,
+                                                       item_hash_t &) override;
+
                     virtual std::vector<item_hash_t> get_blockchain_synopsis(const item_hash_t &, uint32_t) override;
 
                     virtual void sync_status(uint32_t, uint32_t) override;
@@ -91,6 +94,8 @@ namespace golos {
                     bool force_validate = false;
                     bool block_producer = false;
 
+                    fc::mutable_variant_object sync_params;
+
                     std::unique_ptr<golos::network::node> node;
 
                     chain::plugin &chain;
@@ -246,6 +251,45 @@ namespace golos {
                     } FC_CAPTURE_AND_RETHROW((id))
                 }
 
+                uint32_t p2p_plugin_impl::get_packed_blocks(
+                        uint32_t first_block_num, uint32_t count, uint32_t max_size,
+                        std::vector<char> &result, item_hash_t &last_block_id) {
+                    try {
+                        return chain.db().with_weak_read_lock([&]() {
+                            auto &db = chain.db();
+                            // irreversible blocks are copied from the block log as is
+                            const auto &block_log = db.get_block_log();
+                            uint32_t read_count = block_log.read_packed_blocks(
+                                    first_block_num, count, max_size, result);
+
+                            // reversible blocks are taken from the fork db, only if the block log has no more blocks,
+                            //   otherwise the range is stopped by max_size
+                            const auto &log_head = block_log.head();
+                            uint32_t log_head_num = log_head ? log_head->block_num() : 0;
+                            bool past_log_head = first_block_num + read_count > log_head_num;
+                            for (; past_log_head && read_count < count; ++read_count) {
+                                auto block_num = first_block_num + read_count;
+                                if (block_num > db.head_block_num()) {
+                                    break;
+                                }
+                                auto opt_block = db.fetch_block_by_id(db.get_block_id_for_num(block_num));
+                                if (!opt_block) {
+                                    break;
+                                }
+                                auto data = fc::raw::pack(*opt_block);
+                                if (read_count > 0 && result.size() + data.size() > max_size) {
+                                    break;
+                                }
+                                result.insert(result.end(), data.begin(), data.end());
+                            }
+                            if (read_count > 0) {
+                                last_block_id = db.get_block_id_for_num(first_block_num + read_count - 1);
+                            }
+                            return read_count;
+                        });
+                    } FC_CAPTURE_AND_RETHROW((first_block_num)(count)(max_size))
+                }
+
                 chain_id_type p2p_plugin_impl::get_chain_id() const {
                     return STEEMIT_CHAIN_ID;
                 }
@@ -443,7 +487,21 @@ namespace golos {
                     ("seed-node", boost::program_options::value<vector<string>>()->composing(),
                         "The IP address and port of a remote peer to sync with. Deprecated in favor of p2p-seed-node.")
                     ("p2p-seed-node", boost::program_options::value<vector<string>>()->composing(),
-                        "The IP address and port of a remote peer to sync with.");
+                        "The IP address and port of a remote peer to sync with.")
+                    ("p2p-sync-blocks-per-peer", boost::program_options::value<uint32_t>()->default_value(GRAPHENE_NET_MAX_BLOCKS_PER_PEER_DURING_SYNCING),
+                        "Maximum number of blocks requested from one peer at once on syncing, the actual number is adapted to throughput of the peer.")
+                    ("p2p-sync-blocks-in-progress", boost::program_options::value<uint32_t>()->default_value(200),
+                        "Maximum number of sync blocks passed to the chain and not yet applied.")
+                    ("p2p-sync-blocks-to-prefetch", boost::program_options::value<uint32_t>()->default_value(2000),
+                        "Maximum number of received sync blocks waiting for previous blocks, fetching is suspended above it.")
+                    ("p2p-block-decode-threads", boost::program_options::value<uint32_t>()->default_value(0),
+                        "Number of threads which unpack received blocks and recover signature keys of their transactions (0 - the p2p thread unpacks blocks).")
+                    ("p2p-sync-block-ranges", boost::program_options::value<bool>()->default_value(true),
+                        "Fetch contiguous ranges of sync blocks in one message from peers which support it.")
+                    ("p2p-sync-compress-block-ranges", boost::program_options::value<bool>()->default_value(false),
+                        "Request compressed ranges of sync blocks, it saves bandwidth of remote peers, but not of local ones.")
+                    ("p2p-message-cache-size-mb", boost::program_options::value<uint32_t>()->default_value(GRAPHENE_NET_MESSAGE_CACHE_MAX_SIZE_IN_BYTES >> 20),
+                        "Maximum size of recently broadcasted messages kept for requests of peers, in megabytes.");
                 cli.add_options()
                     ("force-validate", boost::program_options::bool_switch()->default_value(false),
                         "Force validation of all transactions. Deprecated in favor of p2p-force-validate")
@@ -490,6 +548,34 @@ namespace golos {
                     }
                 }
 
+                if (options.count("p2p-sync-blocks-per-peer")) {
+                    my->sync_params["maximum_blocks_per_peer_during_syncing"] = options.at("p2p-sync-blocks-per-peer").as<uint32_t>();
+                }
+
+                if (options.count("p2p-sync-blocks-in-progress")) {
+                    my->sync_params["maximum_number_of_blocks_to_handle_at_one_time"] = options.at("p2p-sync-blocks-in-progress").as<uint32_t>();
+                }
+
+                if (options.count("p2p-sync-blocks-to-prefetch")) {
+                    my->sync_params["maximum_number_of_sync_blocks_to_prefetch"] = options.at("p2p-sync-blocks-to-prefetch").as<uint32_t>();
+                }
+
+                if (options.count("p2p-block-decode-threads")) {
+                    my->sync_params["block_decode_threads"] = options.at("p2p-block-decode-threads").as<uint32_t>();
+                }
+
+                if (options.count("p2p-sync-block-ranges")) {
+                    my->sync_params["use_block_ranges"] = options.at("p2p-sync-block-ranges").as<bool>();
+                }
+
+                if (options.count("p2p-sync-compress-block-ranges")) {
+                    my->sync_params["compress_block_ranges"] = options.at("p2p-sync-compress-block-ranges").as<bool>();
+                }
+
+                if (options.count("p2p-message-cache-size-mb")) {
+                    my->sync_params["message_cache_max_size"] = uint64_t(options.at("p2p-message-cache-size-mb").as<uint32_t>()) << 20;
+                }
+
                 my->force_validate = options.at("p2p-force-validate").as<bool>();
 
                 if (!my->force_validate && options.at("force-validate").as<bool>()) {
@@ -522,6 +608,10 @@ namespace golos {
                         my->node->set_advanced_node_parameters(node_param);
                     }
 
+                    // keys are recovered only if signatures of transactions are checked on applying of blocks
+                    my->sync_params["decode_signature_keys"] = my->block_producer || my->force_validate;
+                    my->node->set_advanced_node_parameters(my->sync_params);
+
                     my->node->listen_to_p2p_network();
                     my->node->connect_to_p2p_network();
                     block_id_type block_id;
@@ -554,6 +644,12 @@ namespace golos {
 
             void p2p_plugin::set_block_production(bool producing_blocks) {
                 my->block_producer = producing_blocks;
+                if (my->node) {
+                    my->p2p_thread.async([this] {
+                        my->node->set_advanced_node_parameters(fc::variant_object("decode_signature_keys",
+                            fc::variant(my->block_producer || my->force_validate)));
+                    }).wait();
+                }
             }
 
         }
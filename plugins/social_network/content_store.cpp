@@ -0,0 +1,182 @@
+#include <golos/plugins/social_network/content_store.hpp>
+
+#include <fc/exception/exception.hpp>
+#include <fc/log/logger.hpp>
+
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <shared_mutex>
+
+
+namespace golos { namespace plugins { namespace social_network {
+
+    namespace bfs = boost::filesystem;
+    namespace bip = boost::interprocess;
+
+    namespace {
+
+        const uint64_t content_store_magic = 0x31544e4f43534f47; // "GOSCONT1"
+
+        struct content_store_header final {
+            uint64_t magic = content_store_magic;
+            uint64_t end = sizeof(content_store_header); ///< position after the last appended data
+            uint32_t last_block = 0;
+            uint32_t reserved = 0;
+            uint64_t reserved2 = 0;
+        };
+
+    } // namespace
+
+    struct content_store::impl final {
+        bfs::path file;
+        bool opened = false;
+        bool read_only = false;
+        bip::file_mapping mapping;
+        bip::mapped_region region;
+        mutable std::shared_timed_mutex mutex;
+
+        content_store_header& header() const {
+            return *reinterpret_cast<content_store_header*>(region.get_address());
+        }
+
+        char* data() const {
+            return reinterpret_cast<char*>(region.get_address());
+        }
+
+        void map() {
+            auto mode = read_only ? bip::read_only : bip::read_write;
+            region = bip::mapped_region();
+            mapping = bip::file_mapping(file.string().c_str(), mode);
+            region = bip::mapped_region(mapping, mode);
+        }
+
+        void create() {
+            std::ofstream stream(file.string(), std::ios::out|std::ios::binary|std::ios::trunc);
+            content_store_header h;
+            stream.write(reinterpret_cast<const char*>(&h), sizeof(h));
+            stream.close();
+            bfs::resize_file(file, grow_size);
+        }
+
+        void reserve(uint64_t size) {
+            if (header().end + size <= region.get_size()) {
+                return;
+            }
+            auto new_size = ((header().end + size) / grow_size + 1) * grow_size;
+            region.flush();
+            region = bip::mapped_region();
+            mapping = bip::file_mapping();
+            bfs::resize_file(file, new_size);
+            map();
+        }
+    };
+
+    content_store::content_store(): _impl(new impl()) {
+    }
+
+    content_store::~content_store() {
+        close();
+    }
+
+    void content_store::open(const bfs::path& file, bool read_only) {
+        std::unique_lock<std::shared_timed_mutex> lock(_impl->mutex);
+        FC_ASSERT(!_impl->opened, "Content store is already opened");
+
+        _impl->file = file;
+        _impl->read_only = read_only;
+        if (!bfs::exists(file)) {
+            FC_ASSERT(!read_only, "Content store ${file} doesn't exist", ("file", file.string()));
+            if (file.has_parent_path()) {
+                bfs::create_directories(file.parent_path());
+            }
+            _impl->create();
+        }
+
+        _impl->map();
+        FC_ASSERT(_impl->region.get_size() >= sizeof(content_store_header) &&
+            _impl->header().magic == content_store_magic &&
+            _impl->header().end <= _impl->region.get_size(),
+            "Content store ${file} is corrupted", ("file", file.string()));
+        _impl->opened = true;
+
+        ilog("Content store opened in ${file}: ${size} bytes, last block ${block}",
+            ("file", file.string())("size", _impl->header().end)("block", _impl->header().last_block));
+    }
+
+    void content_store::close() {
+        std::unique_lock<std::shared_timed_mutex> lock(_impl->mutex);
+        if (!_impl->opened) {
+            return;
+        }
+        if (!_impl->read_only) {
+            _impl->region.flush();
+        }
+        _impl->region = bip::mapped_region();
+        _impl->mapping = bip::file_mapping();
+        _impl->opened = false;
+    }
+
+    bool content_store::is_open() const {
+        return _impl->opened;
+    }
+
+    void content_store::reset() {
+        std::unique_lock<std::shared_timed_mutex> lock(_impl->mutex);
+        FC_ASSERT(_impl->opened && !_impl->read_only, "Content store isn't opened for writing");
+
+        wlog("Dropping ${size} bytes of content store ${file}",
+            ("size", _impl->header().end)("file", _impl->file.string()));
+        _impl->header() = content_store_header();
+    }
+
+    uint32_t content_store::last_block() const {
+        std::shared_lock<std::shared_timed_mutex> lock(_impl->mutex);
+        return _impl->opened ? _impl->header().last_block : 0;
+    }
+
+    uint64_t content_store::append(const std::string& data, uint32_t block_num) {
+        std::unique_lock<std::shared_timed_mutex> lock(_impl->mutex);
+        FC_ASSERT(_impl->opened && !_impl->read_only, "Content store isn't opened for writing");
+
+        _impl->reserve(data.size());
+
+        auto& h = _impl->header();
+        auto pos = h.end;
+        std::memcpy(_impl->data() + pos, data.data(), data.size());
+        h.end += data.size();
+        h.last_block = block_num;
+        return pos;
+    }
+
+    std::string content_store::read(uint64_t pos, uint32_t size) const {
+        {
+            std::shared_lock<std::shared_timed_mutex> lock(_impl->mutex);
+            FC_ASSERT(_impl->opened, "Content store isn't opened");
+            if (pos + size <= _impl->region.get_size()) {
+                return std::string(_impl->data() + pos, size);
+            }
+        }
+
+        // the store was grown by the primary node, which writes it
+        std::unique_lock<std::shared_timed_mutex> lock(_impl->mutex);
+        if (pos + size > _impl->region.get_size()) {
+            _impl->map();
+        }
+        FC_ASSERT(pos + size <= _impl->region.get_size(), "Position is out of content store",
+            ("pos", pos)("size", size)("file_size", _impl->region.get_size()));
+        return std::string(_impl->data() + pos, size);
+    }
+
+    void content_store::flush() {
+        std::unique_lock<std::shared_timed_mutex> lock(_impl->mutex);
+        if (_impl->opened && !_impl->read_only) {
+            _impl->region.flush(0, 0, true);
+        }
+    }
+
+} } } // golos::plugins::social_network
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <boost/filesystem/path.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+
+namespace golos { namespace plugins { namespace social_network {
+
+    /**
+     * Append-only memory-mapped file of comment bodies.
+     *
+     * comment_content_object keeps only the position and the size of its body in the file,
+     * so undo of blocks just restores old positions, and new bodies are always appended.
+     * Bodies of popped blocks stay in the file as garbage.
+     */
+    class content_store final {
+    public:
+        static constexpr uint64_t grow_size = 64 << 20;
+
+        content_store();
+
+        ~content_store();
+
+        void open(const boost::filesystem::path& file, bool read_only);
+
+        void close();
+
+        bool is_open() const;
+
+        /// Drops all data, used when shared memory is replayed from the beginning
+        void reset();
+
+        /// The block of the last appended body
+        uint32_t last_block() const;
+
+        /// @return the position of data in the file
+        uint64_t append(const std::string& data, uint32_t block_num);
+
+        std::string read(uint64_t pos, uint32_t size) const;
+
+        void flush();
+
+    private:
+        struct impl;
+        std::unique_ptr<impl> _impl;
+    };
+
+} } } // golos::plugins::social_network
@@ -14,6 +14,7 @@ namespace golos { namespace plugins { namespace social_network {
     using golos::api::discussion;
     using golos::api::account_vote;
     using golos::api::vote_state;
+    using golos::api::vote_order;
     using namespace golos::chain;
     using golos::api::comment_api_object;
 
@@ -60,6 +61,8 @@ namespace golos { namespace plugins { namespace social_network {
         const comment_content_object& get_comment_content(const comment_id_type& comment) const ;
         const comment_content_object* find_comment_content(const comment_id_type& comment) const ;
 
+        std::string get_comment_body(const comment_content_object& content) const;
+
 
     private:
         struct impl;
@@ -68,6 +71,10 @@ namespace golos { namespace plugins { namespace social_network {
 
 // Callback which is needed for correct work of discussion_helper
     void fill_comment_info(const golos::chain::database& db, const comment_object& co, comment_api_object& cao);
+    // The same, but body and json_metadata aren't copied
+    void fill_comment_info_without_content(const golos::chain::database& db, const comment_object& co, comment_api_object& cao);
     std::string get_json_metadata(const golos::chain::database& db, const comment_object&);
+    uint32_t get_comment_body_length(const golos::chain::database& db, const comment_object&);
+    std::string get_comment_body(const comment_content_object& content);
 
 } } } // golos::plugins::social_network
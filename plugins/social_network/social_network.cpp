@@ -1,5 +1,7 @@
 #include <boost/program_options/options_description.hpp>
+#include <boost/filesystem.hpp>
 #include <golos/plugins/social_network/social_network.hpp>
+#include <golos/plugins/social_network/content_store.hpp>
 #include <golos/chain/index.hpp>
 #include <golos/api/vote_state.hpp>
 #include <golos/chain/steem_objects.hpp>
@@ -92,7 +94,8 @@ namespace golos { namespace plugins { namespace social_network {
 
         void select_active_votes (
             std::vector<vote_state>& result, uint32_t& total_count,
-            const std::string& author, const std::string& permlink, uint32_t limit
+            const std::string& author, const std::string& permlink, uint32_t limit,
+            vote_order order, const std::string& start_voter
         ) const ;
 
         void select_content_replies(
@@ -131,6 +134,10 @@ namespace golos { namespace plugins { namespace social_network {
 
         const comment_content_object* find_comment_content(const comment_id_type& comment) const;
 
+        std::string get_comment_body(const comment_content_object& content) const;
+
+        void set_comment_body(comment_content_object& content, const std::string& body);
+
         bool set_comment_update(const comment_object& comment, time_point_sec active, bool set_last_update) const;
 
         void activate_parent_comments(const comment_object& comment) const;
@@ -139,6 +146,9 @@ namespace golos { namespace plugins { namespace social_network {
         std::unique_ptr<discussion_helper> helper;
         comment_depth_params depth_parameters;
 
+        content_store body_store;
+        bool body_store_checked = false;
+
         // variables to temporarily store values through states of operation visitor
         asset author_gbg_payout_value{0, SBD_SYMBOL}; // part of author payout
         asset author_golos_payout_value{0, STEEM_SYMBOL}; // part of author payout
@@ -167,15 +177,50 @@ namespace golos { namespace plugins { namespace social_network {
         return pimpl->find_comment_content(comment);
     }
 
+    std::string social_network::impl::get_comment_body(const comment_content_object& content) const {
+        if (content.body_size == 0) {
+            return to_string(content.body);
+        }
+        return body_store.read(content.body_pos, content.body_size);
+    }
+
+    std::string social_network::get_comment_body(const comment_content_object& content) const {
+        return pimpl->get_comment_body(content);
+    }
+
+    void social_network::impl::set_comment_body(comment_content_object& content, const std::string& body) {
+        if (!body_store.is_open() || body.empty()) {
+            from_string(content.body, body);
+            content.body_size = 0;
+            return;
+        }
+
+        if (!body_store_checked) {
+            // shared memory is replayed from the beginning, nothing refers to the old bodies.
+            //   the undo history is skipped, because its blocks can still restore references
+            body_store_checked = true;
+            if (db.get_index<comment_content_index>().indices().empty() &&
+                db.head_block_num() + STEEMIT_MAX_UNDO_HISTORY < body_store.last_block()
+            ) {
+                body_store.reset();
+            }
+        }
+
+        content.body.clear();
+        content.body_pos = body_store.append(body, db.head_block_num());
+        content.body_size = static_cast<uint32_t>(body.size());
+    }
+
     discussion social_network::impl::get_discussion(const comment_object& c, uint32_t vote_limit) const {
         return helper->get_discussion(c, vote_limit);
     }
 
     void social_network::impl::select_active_votes(
         std::vector<vote_state>& result, uint32_t& total_count,
-        const std::string& author, const std::string& permlink, uint32_t limit
+        const std::string& author, const std::string& permlink, uint32_t limit,
+        vote_order order, const std::string& start_voter
     ) const {
-        helper->select_active_votes(result, total_count, author, permlink, limit);
+        helper->select_active_votes(result, total_count, author, permlink, limit, order, start_voter);
     }
 
     bool social_network::impl::set_comment_update(const comment_object& comment, time_point_sec active, bool set_last_update) const {
@@ -311,18 +356,18 @@ namespace golos { namespace plugins { namespace social_network {
                                 diff_match_patch<std::wstring> dmp;
                                 auto patch = dmp.patch_fromText(utf8_to_wstring(o.body));
                                 if (patch.size()) {
-                                    auto result = dmp.patch_apply(patch, utf8_to_wstring(to_string(con.body)));
+                                    auto result = dmp.patch_apply(patch, utf8_to_wstring(impl.get_comment_body(con)));
                                     auto patched_body = wstring_to_utf8(result.first);
                                     if(!fc::is_utf8(patched_body)) {
-                                        from_string(con.body, fc::prune_invalid_utf8(patched_body));
+                                        impl.set_comment_body(con, fc::prune_invalid_utf8(patched_body));
                                     } else {
-                                        from_string(con.body, patched_body);
+                                        impl.set_comment_body(con, patched_body);
                                     }
                                 } else { // replace
-                                    from_string(con.body, o.body);
+                                    impl.set_comment_body(con, o.body);
                                 }
                             } catch ( ... ) {
-                                from_string(con.body, o.body);
+                                impl.set_comment_body(con, o.body);
                             }
                         }
                         // Set depth null if needed (this parameter is given in config)
@@ -339,7 +384,7 @@ namespace golos { namespace plugins { namespace social_network {
                         }
 
                         if ((!dp.has_comment_body_depth || dp.comment_body_depth > 0) && o.body.size() < 1024*1024*128) {
-                            from_string(con.body, o.body);
+                            impl.set_comment_body(con, o.body);
                         }
                         if ((!dp.has_comment_json_metadata_depth || dp.comment_json_metadata_depth > 0) &&
                             fc::is_utf8(o.json_metadata)
@@ -490,6 +535,7 @@ namespace golos { namespace plugins { namespace social_network {
 
                         if (dp.has_comment_body_depth && delta > dp.comment_body_depth) {
                             con.body.clear();
+                            con.body_size = 0;
                         }
 
                         if (dp.has_comment_json_metadata_depth && delta > dp.comment_json_metadata_depth) {
@@ -529,6 +575,7 @@ namespace golos { namespace plugins { namespace social_network {
 
     void social_network::plugin_shutdown() {
         wlog("social_network plugin: plugin_shutdown()");
+        pimpl->body_store.close();
     }
 
     const std::string& social_network::name() {
@@ -561,6 +608,9 @@ namespace golos { namespace plugins { namespace social_network {
             ) (
                 "store-comment-rewards", boost::program_options::value<bool>()->default_value(true),
                 "store comment rewards"
+            ) (
+                "comment-body-store-file", boost::program_options::value<boost::filesystem::path>(),
+                "If set, store comment bodies in this memory-mapped file (relative to data dir) instead of shared memory"
             );
         //  Do not use bool_switch() in cfg!
     }
@@ -618,6 +668,14 @@ namespace golos { namespace plugins { namespace social_network {
         if (options.count("set-content-storing-depth-null-after-update")) {
             params.set_null_after_update = options.at("set-content-storing-depth-null-after-update").as<bool>();
         }
+
+        if (options.count("comment-body-store-file")) {
+            auto file = options.at("comment-body-store-file").as<boost::filesystem::path>();
+            if (file.is_relative()) {
+                file = appbase::app().data_dir() / file;
+            }
+            pimpl->body_store.open(file, appbase::app().get_plugin<chain::plugin>().read_only());
+        }
     }
 
     social_network::~social_network() = default;
@@ -754,11 +812,13 @@ namespace golos { namespace plugins { namespace social_network {
             (string,   author)
             (string,   permlink)
             (uint32_t, vote_limit, DEFAULT_VOTE_LIMIT)
+            (vote_order, order, vote_order::by_voter)
+            (string,   start_voter, "")
         );
         return pimpl->db.with_weak_read_lock([&]() {
             std::vector<vote_state> result;
             uint32_t total_count;
-            pimpl->select_active_votes(result, total_count, author, permlink, vote_limit);
+            pimpl->select_active_votes(result, total_count, author, permlink, vote_limit, order, start_voter);
             return result;
         });
     }
@@ -828,13 +888,17 @@ namespace golos { namespace plugins { namespace social_network {
         });
     }
 
-    void fill_comment_info(const golos::chain::database& db, const comment_object& co, comment_api_object& con) {
+    static void fill_comment_info_impl(
+        const golos::chain::database& db, const comment_object& co, comment_api_object& con, bool fill_content
+    ) {
         if (db.has_index<comment_content_index>()) {
             const auto content = db.find<comment_content_object, by_comment>(co.id);
             if (content != nullptr) {
                 con.title = to_string(content->title);
-                con.body = to_string(content->body);
-                con.json_metadata = to_string(content->json_metadata);
+                if (fill_content) {
+                    con.body = get_comment_body(*content);
+                    con.json_metadata = to_string(content->json_metadata);
+                }
             }
 
             const auto root_content = db.find<comment_content_object, by_comment>(co.root_comment);
@@ -880,6 +944,34 @@ namespace golos { namespace plugins { namespace social_network {
         }
     }
 
+    std::string get_comment_body(const comment_content_object& content) {
+        if (content.body_size == 0) {
+            return to_string(content.body);
+        }
+        return appbase::app().get_plugin<social_network>().get_comment_body(content);
+    }
+
+    void fill_comment_info(const golos::chain::database& db, const comment_object& co, comment_api_object& con) {
+        fill_comment_info_impl(db, co, con, true);
+    }
+
+    void fill_comment_info_without_content(
+        const golos::chain::database& db, const comment_object& co, comment_api_object& con
+    ) {
+        fill_comment_info_impl(db, co, con, false);
+    }
+
+    uint32_t get_comment_body_length(const golos::chain::database& db, const comment_object& c) {
+        if (!db.has_index<comment_content_index>()) {
+            return 0;
+        }
+        const auto content = db.find<comment_content_object, by_comment>(c.id);
+        if (content == nullptr) {
+            return 0;
+        }
+        return content->body_size ? content->body_size : static_cast<uint32_t>(content->body.size());
+    }
+
     std::string get_json_metadata(const golos::chain::database& db, const comment_object& c) {
         if (!db.has_index<comment_content_index>()) {
             return std::string();
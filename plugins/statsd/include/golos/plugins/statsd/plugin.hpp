@@ -2,6 +2,7 @@
 
 #include <appbase/application.hpp>
 #include <golos/plugins/chain/plugin.hpp>
+#include <golos/plugins/json_rpc/plugin.hpp>
 
 #include <golos/chain/steem_object_types.hpp>
 #include <boost/multi_index/composite_key.hpp>
@@ -41,7 +42,7 @@ public:
         return name;
     }
 
-    APPBASE_PLUGIN_REQUIRES((chain::plugin))
+    APPBASE_PLUGIN_REQUIRES((chain::plugin)(json_rpc::plugin))
 
     plugin();
 
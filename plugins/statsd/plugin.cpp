@@ -11,6 +11,7 @@
 #include <fc/io/json.hpp>
 #include <boost/program_options.hpp>
 #include <golos/plugins/statsd/statistics_sender.hpp>
+#include <golos/plugins/webserver/webserver_plugin.hpp>
 
 
 
@@ -51,9 +52,29 @@ public:
 
     void post_operation(const operation_notification &o);
 
+    void push_lock_stats();
+
+    void push_rpc_stats();
+
+    void push_webserver_stats();
+
+    void push_rpc_cache_stats();
+
+    void push_pending_transactions_stats();
+
     golos::chain::database &database_;
 
     std::shared_ptr<statistics_sender> stat_sender;
+
+    std::map<std::pair<std::string, lock_type>, lock_stats_item> previous_lock_stats;
+
+    std::map<std::string, json_rpc::rpc_stats_item> previous_rpc_stats;
+
+    webserver::request_scheduler_stats previous_webserver_stats;
+
+    std::map<std::string, json_rpc::response_cache_item> previous_rpc_cache_stats;
+
+    golos::chain::pending_transactions_stats previous_pending_stats;
 };
 
 struct operation_process {
@@ -228,6 +249,144 @@ void plugin::plugin_impl::on_block(const signed_block &b) {
 
     stat_sender->current_bucket.transactions += num_trx;
     stat_sender->current_bucket.bandwidth += trx_size;
+
+    push_lock_stats();
+    push_rpc_stats();
+    push_webserver_stats();
+    push_rpc_cache_stats();
+    push_pending_transactions_stats();
+}
+
+void plugin::plugin_impl::push_lock_stats() {
+    auto& stats = database().get_lock_stats();
+    if (!stats.enabled()) {
+        return;
+    }
+
+    std::vector<std::string> result;
+    for (auto& item : stats.get()) {
+        auto key = std::make_pair(item.context, item.type);
+        auto& prev = previous_lock_stats[key];
+        if (item.count < prev.count) {
+            // statistics were cleared by get_lock_stats
+            prev = lock_stats_item();
+        }
+
+        auto name = "locks." + item.context + "." + fc::reflector<lock_type>::to_string(item.type);
+        increment_counter(result, name + ".count", uint32_t(item.count - prev.count));
+        increment_counter(result, name + ".timeouts", uint32_t(item.timeouts - prev.timeouts));
+        increment_counter(result, name + ".retries", uint32_t(item.retries - prev.retries));
+        increment_counter(result, name + ".wait_us", uint32_t(item.total_wait_us - prev.total_wait_us));
+        increment_counter(result, name + ".hold_us", uint32_t(item.total_hold_us - prev.total_hold_us));
+
+        prev = std::move(item);
+    }
+
+    for (auto& str : result) {
+        stat_sender->push(str);
+    }
+}
+
+void plugin::plugin_impl::push_rpc_stats() {
+    auto& stats = appbase::app().get_plugin<json_rpc::plugin>().get_rpc_stats();
+    if (!stats.enabled()) {
+        return;
+    }
+
+    std::vector<std::string> result;
+    for (auto& item : stats.get()) {
+        auto& prev = previous_rpc_stats[item.method];
+        if (item.count < prev.count) {
+            // statistics were cleared by get_rpc_stats
+            prev = json_rpc::rpc_stats_item();
+        }
+        if (item.count == prev.count) {
+            continue;
+        }
+
+        auto name = "rpc." + item.method;
+        increment_counter(result, name + ".count", uint32_t(item.count - prev.count));
+        increment_counter(result, name + ".errors", uint32_t(item.errors - prev.errors));
+        increment_counter(result, name + ".request_bytes", uint32_t(item.request_bytes - prev.request_bytes));
+        increment_counter(result, name + ".response_bytes", uint32_t(item.response_bytes - prev.response_bytes));
+        increment_counter(result, name + ".time_us", uint32_t(item.total_us - prev.total_us));
+        increment_counter(result, name + ".lock_wait_us", uint32_t(item.lock_wait_us - prev.lock_wait_us));
+        increment_counter(result, name + ".p50_us", uint32_t(item.p50_us), "g");
+        increment_counter(result, name + ".p99_us", uint32_t(item.p99_us), "g");
+
+        prev = std::move(item);
+    }
+
+    for (auto& str : result) {
+        stat_sender->push(str);
+    }
+}
+
+void plugin::plugin_impl::push_webserver_stats() {
+    auto webserver = appbase::app().find_plugin<webserver::webserver_plugin>();
+    if (webserver == nullptr || webserver->get_state() != appbase::abstract_plugin::started) {
+        return;
+    }
+
+    auto stats = webserver->get_scheduler_stats();
+    auto& prev = previous_webserver_stats;
+
+    std::vector<std::string> result;
+    result.push_back("webserver.queue_depth:" + std::to_string(stats.queue_depth) + "|g");
+    result.push_back("webserver.running:" + std::to_string(stats.running) + "|g");
+    increment_counter(result, "webserver.executed", uint32_t(stats.executed - prev.executed));
+    increment_counter(result, "webserver.rejected_queue", uint32_t(stats.rejected_queue - prev.rejected_queue));
+    increment_counter(result, "webserver.rejected_connection",
+        uint32_t(stats.rejected_connection - prev.rejected_connection));
+    prev = stats;
+
+    for (auto& str : result) {
+        stat_sender->push(str);
+    }
+}
+
+void plugin::plugin_impl::push_rpc_cache_stats() {
+    auto& cache = appbase::app().get_plugin<json_rpc::plugin>().get_response_cache();
+    if (!cache.enabled()) {
+        return;
+    }
+
+    auto stats = cache.get_stats();
+
+    std::vector<std::string> result;
+    result.push_back("rpc_cache.size_bytes:" + std::to_string(stats.size_bytes) + "|g");
+    result.push_back("rpc_cache.entries:" + std::to_string(stats.entries) + "|g");
+    for (auto& item : stats.methods) {
+        auto& prev = previous_rpc_cache_stats[item.method];
+        auto name = "rpc_cache." + item.method;
+        increment_counter(result, name + ".hits", uint32_t(item.hits - prev.hits));
+        increment_counter(result, name + ".misses", uint32_t(item.misses - prev.misses));
+        prev = std::move(item);
+    }
+
+    for (auto& str : result) {
+        stat_sender->push(str);
+    }
+}
+
+void plugin::plugin_impl::push_pending_transactions_stats() {
+    // on_block is called inside of push_block, so the last rebuild of the pending state is counted on the next block
+    auto stats = database().get_pending_transactions_stats();
+    auto& prev = previous_pending_stats;
+
+    std::vector<std::string> result;
+    result.push_back("pending.transactions:" + std::to_string(stats.pending) + "|g");
+    increment_counter(result, "pending.rebuilds", uint32_t(stats.rebuilds - prev.rebuilds));
+    increment_counter(result, "pending.reapplied", uint32_t(stats.reapplied - prev.reapplied));
+    increment_counter(result, "pending.failed", uint32_t(stats.failed - prev.failed));
+    increment_counter(result, "pending.dropped_expired", uint32_t(stats.dropped_expired - prev.dropped_expired));
+    increment_counter(result, "pending.dropped_included", uint32_t(stats.dropped_included - prev.dropped_included));
+    increment_counter(result, "pending.time_us", uint32_t(stats.total_us - prev.total_us));
+    prev = stats;
+
+    for (auto& str : result) {
+        stat_sender->push(str);
+    }
 }
 
 void plugin::plugin_impl::pre_operation(const operation_notification &o) {
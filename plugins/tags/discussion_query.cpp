@@ -17,11 +17,56 @@ namespace golos { namespace plugins { namespace tags {
         }
     }
 
+    namespace {
+
+        struct field_names_visitor final {
+            std::set<std::string>& names;
+
+            template<typename Member, class Class, Member (Class::*member)>
+            void operator()(const char* name) const {
+                names.insert(name);
+            }
+        };
+
+        const std::set<std::string>& discussion_field_names() {
+            static const std::set<std::string> names = [] {
+                std::set<std::string> result = {"pending_payout"};
+                fc::reflector<discussion>::visit(field_names_visitor{result});
+                return result;
+            }();
+            return names;
+        }
+
+    } // namespace
+
     void discussion_query::prepare() {
         tags_to_lower(select_tags);
         tags_to_lower(filter_tags);
         tags_to_lower(select_languages);
         tags_to_lower(filter_languages);
+
+        // long names are compared as tag_name_type by prefix, as they are stored in tag_object
+        auto to_names = [](const std::set<std::string>& src, std::set<tag_name_type>& dst) {
+            dst.clear();
+            for (const auto& name: src) {
+                dst.insert(tag_name_type(name));
+            }
+        };
+        to_names(select_tags, select_tag_names);
+        to_names(filter_tags, filter_tag_names);
+        to_names(select_languages, select_language_names);
+        to_names(filter_languages, filter_language_names);
+
+        // fields which are calculated together
+        for (const auto& name: std::set<std::string>(fields)) {
+            if (boost::starts_with(name, "pending_") || name == "total_pending_payout_value" ||
+                name == "author_reputation" || name == "promoted"
+            ) {
+                fields.insert("pending_payout");
+            } else if (name == "active_votes_count") {
+                fields.insert("active_votes");
+            }
+        }
     }
 
     void discussion_query::validate() const {
@@ -42,32 +87,59 @@ namespace golos { namespace plugins { namespace tags {
                     ("language", itr));
             }
         });
+
+        GOLOS_CHECK_PARAM(fields, {
+            const auto& names = discussion_field_names();
+            for (auto& itr : fields) {
+                GOLOS_CHECK_VALUE(names.count(itr), "Unknown field '${field}' of discussion", ("field", itr));
+            }
+        });
     }
 
-    bool discussion_query::is_good_tags(
-        const discussion& d, std::size_t tags_number, std::size_t tag_max_length
-    ) const {
-        if (!has_tags_selector() && !has_tags_filter() && !has_language_selector() && !has_language_filter()) {
-            return true;
-        }
+    namespace {
 
-        auto meta = get_metadata(d.json_metadata, tags_number, tag_max_length);
-        if ((has_language_selector() && !select_languages.count(meta.language)) ||
-            (has_language_filter() && filter_languages.count(meta.language))
+        template<typename Names, typename Name, typename Tags>
+        bool is_good_tags(
+            const Names& select_languages, const Names& filter_languages,
+            const Names& select_tags, const Names& filter_tags,
+            const Name& language, const Tags& tags
         ) {
-            return false;
-        }
-
-        bool result = select_tags.empty();
-        for (auto& name: meta.tags) {
-            if (has_tags_filter() && filter_tags.count(name)) {
+            if ((!select_languages.empty() && !select_languages.count(language)) ||
+                (!filter_languages.empty() && filter_languages.count(language))
+            ) {
                 return false;
-            } else if (!result && select_tags.count(name)) {
-                result = true;
             }
+
+            bool result = select_tags.empty();
+            for (auto& name: tags) {
+                if (!filter_tags.empty() && filter_tags.count(name)) {
+                    return false;
+                } else if (!result && select_tags.count(name)) {
+                    result = true;
+                }
+            }
+
+            return result;
         }
 
-        return result;
+    } // namespace
+
+    bool discussion_query::is_good_tags(const comment_tags_object& tags) const {
+        if (!has_tags_query()) {
+            return true;
+        }
+        return tags::is_good_tags(
+            select_language_names, filter_language_names, select_tag_names, filter_tag_names,
+            tags.language, tags.tags);
+    }
+
+    bool discussion_query::is_good_tags(const comment_metadata& meta) const {
+        if (!has_tags_query()) {
+            return true;
+        }
+        return tags::is_good_tags(
+            select_languages, filter_languages, select_tags, filter_tags,
+            meta.language, meta.tags);
     }
 
 } } } // golos::plugins::tags
@@ -10,6 +10,7 @@
 #include <memory>
 #include <vector>
 #include <fc/exception/exception.hpp>
+#include <fc/fixed_string.hpp>
 
 #include <golos/chain/comment_object.hpp>
 #include <golos/chain/account_object.hpp>
@@ -26,6 +27,11 @@ namespace golos { namespace plugins { namespace tags {
     using golos::api::comment_api_object;
     using golos::api::discussion;
 
+    class comment_tags_object;
+    struct comment_metadata;
+
+    using tag_name_type = fc::fixed_string<fc::sha256>;
+
     /**
      * @class discussion_query
      * @brief The discussion_query structure implements the RPC API param set.
@@ -48,11 +54,18 @@ namespace golos { namespace plugins { namespace tags {
         fc::optional<std::string>         start_permlink; ///< the permlink of discussion to start searching from
         fc::optional<std::string>         parent_author; ///< the author of parent discussion
         fc::optional<std::string>         parent_permlink; ///< the permlink of parent discussion
+        std::set<std::string>             fields; ///< list of fields of discussion to return, empty for all
 
         discussion                        start_comment;
         discussion                        parent_comment;
         std::set<account_object::id_type> select_author_ids;
 
+        // tags and languages converted by prepare() for comparing with names of comment_tags_object
+        std::set<tag_name_type>           select_tag_names;
+        std::set<tag_name_type>           filter_tag_names;
+        std::set<tag_name_type>           select_language_names;
+        std::set<tag_name_type>           filter_language_names;
+
         bool has_tags_selector() const {
             return !select_tags.empty();
         }
@@ -69,7 +82,22 @@ namespace golos { namespace plugins { namespace tags {
             return !filter_languages.empty();
         }
 
-        bool is_good_tags(const discussion& d, std::size_t tags_number, std::size_t tag_max_length) const;
+        bool has_tags_query() const {
+            return has_tags_selector() || has_tags_filter() || has_language_selector() || has_language_filter();
+        }
+
+        bool is_good_tags(const comment_tags_object& tags) const;
+
+        bool is_good_tags(const comment_metadata& meta) const;
+
+        /**
+         * Expensive fields are calculated only if they are requested:
+         *   "url", "active_votes", "pending_payout" (all pending payouts, author_reputation, promoted),
+         *   "body" and "json_metadata" (they are returned empty if not requested)
+         */
+        bool has_field(const std::string& name) const {
+            return fields.empty() || fields.count(name);
+        }
 
         bool has_author_selector() const {
             return !select_author_ids.empty();
@@ -109,7 +137,7 @@ namespace golos { namespace plugins { namespace tags {
 FC_REFLECT((golos::plugins::tags::discussion_query),
         (select_tags)(filter_tags)(select_authors)(truncate_body)(vote_limit)
         (start_author)(start_permlink)(parent_author)
-        (parent_permlink)(limit)(select_languages)(filter_languages)
+        (parent_permlink)(limit)(select_languages)(filter_languages)(fields)
 );
 
 #endif //GOLOS_DISCUSSION_QUERY_H
@@ -60,6 +60,15 @@ namespace golos { namespace plugins { namespace tags {
 
         double calculate_trending(const share_type& score, const time_point_sec& created) const;
 
+        /** parses json_metadata of comment and stores the result in comment_tags_object */
+        comment_metadata update_comment_metadata(const comment_object& comment) const;
+
+        /** reads tags and language of comment from comment_tags_object, parses json_metadata if there is no object */
+        comment_metadata get_comment_metadata(const comment_object& comment) const;
+
+        /** removes comment_tags_object, should be called before the removal of comment */
+        void remove_comment_metadata(const account_name_type& author, const std::string& permlink) const;
+
         /** finds tags that have been added or removed or updated */
         void create_update_tags(const account_name_type& author, const std::string& permlink) const;
         void update_tags(const account_name_type& author, const std::string& permlink) const;
@@ -53,7 +53,8 @@ namespace golos { namespace plugins { namespace tags {
         tag_object_type = (TAG_SPACE_ID << 8),
         tag_stats_object_type = (TAG_SPACE_ID << 8) + 1,
         author_tag_stats_object_type = (TAG_SPACE_ID << 8) + 2,
-        language_object_type = (TAG_SPACE_ID << 8) + 3
+        language_object_type = (TAG_SPACE_ID << 8) + 3,
+        comment_tags_object_type = (TAG_SPACE_ID << 8) + 4
     };
 
     /**
@@ -112,6 +113,9 @@ namespace golos { namespace plugins { namespace tags {
     struct by_author_comment;
     struct by_comment;
     struct by_tag;
+    struct by_tag_trending;
+    struct by_tag_hot;
+    struct by_tag_promoted;
 
     using tag_index = multi_index_container<
         tag_object,
@@ -148,6 +152,47 @@ namespace golos { namespace plugins { namespace tags {
                 composite_key_compare<
                     std::less<tag_name_type>,
                     std::less<tag_type>>>,
+            // per-tag rankings, they are updated on each change of tag, so queries by tags read top posts in order;
+            //   ties are broken by comment id, as in tags_sort.hpp, so a tag gives the same top posts as the final sort
+            ordered_unique<
+                tag<by_tag_trending>,
+                composite_key<
+                    tag_object,
+                    member<tag_object, tag_name_type, &tag_object::name>,
+                    member<tag_object, tag_type, &tag_object::type>,
+                    member<tag_object, double, &tag_object::trending>,
+                    member<tag_object, comment_object::id_type, &tag_object::comment>>,
+                composite_key_compare<
+                    std::less<tag_name_type>,
+                    std::less<tag_type>,
+                    std::greater<double>,
+                    std::less<comment_object::id_type>>>,
+            ordered_unique<
+                tag<by_tag_hot>,
+                composite_key<
+                    tag_object,
+                    member<tag_object, tag_name_type, &tag_object::name>,
+                    member<tag_object, tag_type, &tag_object::type>,
+                    member<tag_object, double, &tag_object::hot>,
+                    member<tag_object, comment_object::id_type, &tag_object::comment>>,
+                composite_key_compare<
+                    std::less<tag_name_type>,
+                    std::less<tag_type>,
+                    std::greater<double>,
+                    std::less<comment_object::id_type>>>,
+            ordered_unique<
+                tag<by_tag_promoted>,
+                composite_key<
+                    tag_object,
+                    member<tag_object, tag_name_type, &tag_object::name>,
+                    member<tag_object, tag_type, &tag_object::type>,
+                    member<tag_object, share_type, &tag_object::promoted_balance>,
+                    member<tag_object, comment_object::id_type, &tag_object::comment>>,
+                composite_key_compare<
+                    std::less<tag_name_type>,
+                    std::less<tag_type>,
+                    std::greater<share_type>,
+                    std::less<comment_object::id_type>>>,
             ordered_non_unique<
                 tag<sort::by_created>,
                 composite_key<
@@ -384,6 +429,41 @@ namespace golos { namespace plugins { namespace tags {
                 member<language_object, tag_name_type, &language_object::name>>>,
         allocator<language_object>>;
 
+    /**
+     * Normalized tags and language of comment, they are parsed from json_metadata once on creation
+     * or editing of comment, so queries don't parse it.
+     */
+    class comment_tags_object: public object<comment_tags_object_type, comment_tags_object> {
+    public:
+        template<typename Constructor, typename Allocator>
+        comment_tags_object(Constructor&& c, allocator<Allocator> a)
+            : tags(a) {
+            c(*this);
+        }
+
+        id_type id;
+        comment_object::id_type comment;
+        tag_name_type language;
+
+        using tags_allocator_type = allocator<tag_name_type>;
+        using tags_type = bip::vector<tag_name_type, tags_allocator_type>;
+
+        tags_type tags;
+    };
+
+    using comment_tags_id_type = object_id<comment_tags_object>;
+
+    using comment_tags_index = multi_index_container<
+        comment_tags_object,
+        indexed_by<
+            ordered_unique<
+                tag<by_id>,
+                member<comment_tags_object, comment_tags_id_type, &comment_tags_object::id>>,
+            ordered_unique<
+                tag<by_comment>,
+                member<comment_tags_object, comment_object::id_type, &comment_tags_object::comment>>>,
+        allocator<comment_tags_object>>;
+
     /**
      * Used to parse the metadata from the comment json_meta field.
      */
@@ -409,5 +489,25 @@ CHAINBASE_SET_INDEX_TYPE(
     golos::plugins::tags::language_object,
     golos::plugins::tags::language_index)
 
+CHAINBASE_SET_INDEX_TYPE(
+    golos::plugins::tags::comment_tags_object,
+    golos::plugins::tags::comment_tags_index)
+
 FC_REFLECT((golos::plugins::tags::comment_metadata), (tags)(language))
 
+
+FC_REFLECT_ENUM(golos::plugins::tags::tag_type, (tag)(language))
+
+FC_REFLECT((golos::plugins::tags::tag_object),
+    (id)(name)(type)(created)(active)(updated)(cashout)(net_rshares)(net_votes)(children)
+    (hot)(trending)(promoted_balance)(children_rshares2)(author)(parent)(comment))
+
+FC_REFLECT((golos::plugins::tags::tag_stats_object),
+    (id)(name)(type)(total_children_rshares2)(total_payout)(net_votes)(top_posts)(comments))
+
+FC_REFLECT((golos::plugins::tags::author_tag_stats_object),
+    (id)(author)(name)(type)(total_rewards)(total_posts))
+
+FC_REFLECT((golos::plugins::tags::language_object), (id)(name))
+
+FC_REFLECT((golos::plugins::tags::comment_tags_object), (id)(comment)(language)(tags))
@@ -21,6 +21,41 @@ namespace golos { namespace plugins { namespace tags {
     using golos::chain::feed_history_object;
     using golos::api::discussion_helper;
 
+    /**
+     * Per-tag indexes of tag_object, which have the same order as DiscussionOrder,
+     * so discussions of a tag are read in order and only limit of them are created.
+     * Other orders select all discussions of a tag and sort them.
+     */
+    template<typename DiscussionOrder>
+    struct tag_ordered_index: std::false_type {};
+
+    template<>
+    struct tag_ordered_index<sort::by_trending>: std::true_type {
+        using type = tags::by_tag_trending;
+
+        static double value(const discussion& d) {
+            return d.trending;
+        }
+    };
+
+    template<>
+    struct tag_ordered_index<sort::by_hot>: std::true_type {
+        using type = tags::by_tag_hot;
+
+        static double value(const discussion& d) {
+            return d.hot;
+        }
+    };
+
+    template<>
+    struct tag_ordered_index<sort::by_promoted>: std::true_type {
+        using type = tags::by_tag_promoted;
+
+        static share_type value(const discussion& d) {
+            return d.promoted ? d.promoted->amount : share_type(0);
+        }
+    };
+
     struct tags_plugin::impl final {
         impl(): database_(appbase::app().get_plugin<chain::plugin>().db()) {
             helper = std::make_unique<discussion_helper>(
@@ -28,6 +63,11 @@ namespace golos { namespace plugins { namespace tags {
                 follow::fill_account_reputation,
                 fill_promoted,
                 social_network::fill_comment_info);
+            helper_without_content = std::make_unique<discussion_helper>(
+                database_,
+                follow::fill_account_reputation,
+                fill_promoted,
+                social_network::fill_comment_info_without_content);
         }
 
         ~impl() {}
@@ -43,6 +83,15 @@ namespace golos { namespace plugins { namespace tags {
             }
         }
 
+        void on_pre_operation(const operation_notification& note) {
+            // the comment is still here, so its metadata can be found
+            if (note.op.which() == operation::tag<delete_comment_operation>::value) {
+                const auto& op = note.op.get<delete_comment_operation>();
+                tags::operation_visitor(database_, tags_number, tag_max_length).remove_comment_metadata(
+                    op.author, op.permlink);
+            }
+        }
+
         golos::chain::database& database() {
             return database_;
         }
@@ -66,6 +115,8 @@ namespace golos { namespace plugins { namespace tags {
 
         bool filter_query(discussion_query& query) const;
 
+        bool is_good_tags(const discussion_query& query, const discussion& d) const;
+
         template<typename DatabaseIndex, typename DiscussionIndex, typename Fill>
         std::vector<discussion> select_unordered_discussions(discussion_query&, Fill&&) const;
 
@@ -80,6 +131,26 @@ namespace golos { namespace plugins { namespace tags {
             Order&& order
         ) const;
 
+        template<typename DiscussionOrder, typename Selector>
+        void select_tag_discussions(
+            std::set<comment_object::id_type>& id_set,
+            std::vector<discussion>& result,
+            const discussion_query& query,
+            const std::string& name, tags::tag_type type,
+            Selector&& selector,
+            std::true_type
+        ) const;
+
+        template<typename DiscussionOrder, typename Selector>
+        void select_tag_discussions(
+            std::set<comment_object::id_type>& id_set,
+            std::vector<discussion>& result,
+            const discussion_query& query,
+            const std::string& name, tags::tag_type type,
+            Selector&& selector,
+            std::false_type
+        ) const;
+
         template<typename DiscussionOrder, typename Selector>
         std::vector<discussion> select_ordered_discussions(discussion_query&, Selector&&) const;
 
@@ -100,6 +171,9 @@ namespace golos { namespace plugins { namespace tags {
 
         discussion create_discussion(const comment_object& o) const;
         discussion create_discussion(const comment_object& o, const discussion_query& query) const;
+        discussion create_discussion_without_content(const comment_object& o) const;
+        /// copies body and json_metadata only if they are requested by query, doesn't fill other fields
+        discussion create_query_discussion(const comment_object& o, const discussion_query& query) const;
         void fill_discussion(discussion& d, const discussion_query& query) const;
         void fill_comment_api_object(const comment_object& o, discussion& d) const;
 
@@ -112,6 +186,7 @@ namespace golos { namespace plugins { namespace tags {
     private:
         golos::chain::database& database_;
         std::unique_ptr<discussion_helper> helper;
+        std::unique_ptr<discussion_helper> helper_without_content;
     };
 
     void tags_plugin::impl::select_active_votes(
@@ -138,15 +213,41 @@ namespace golos { namespace plugins { namespace tags {
         return helper->create_discussion(o);
     }
 
+    discussion tags_plugin::impl::create_discussion_without_content(const comment_object& o) const {
+        return helper_without_content->create_discussion(o);
+    }
+
+    discussion tags_plugin::impl::create_query_discussion(const comment_object& o, const discussion_query& query) const {
+        if (query.has_field("body")) {
+            discussion d = create_discussion(o);
+            d.body_length = static_cast<uint32_t>(d.body.size());
+            if (!query.has_field("json_metadata")) {
+                d.json_metadata.clear();
+            }
+            return d;
+        }
+
+        discussion d = create_discussion_without_content(o);
+        d.body_length = social_network::get_comment_body_length(database_, o);
+        if (query.has_field("json_metadata")) {
+            d.json_metadata = social_network::get_json_metadata(database_, o);
+        }
+        return d;
+    }
+
     void tags_plugin::impl::fill_comment_api_object(const comment_object& o, discussion& d) const {
         helper->fill_comment_api_object(o, d);
     }
 
     void tags_plugin::impl::fill_discussion(discussion& d, const discussion_query& query) const {
-        set_url(d);
-        set_pending_payout(d);
-        select_active_votes(d.active_votes, d.active_votes_count, d.author, d.permlink, query.vote_limit);
-        d.body_length = static_cast<uint32_t>(d.body.size());
+        if (query.has_field("pending_payout")) {
+            set_pending_payout(d); // it also sets url
+        } else if (query.has_field("url")) {
+            set_url(d);
+        }
+        if (query.has_field("active_votes")) {
+            select_active_votes(d.active_votes, d.active_votes_count, d.author, d.permlink, query.vote_limit);
+        }
         if (query.truncate_body) {
             if (d.body.size() > query.truncate_body) {
                 d.body.erase(query.truncate_body);
@@ -168,7 +269,7 @@ namespace golos { namespace plugins { namespace tags {
 
     discussion tags_plugin::impl::create_discussion(const comment_object& o, const discussion_query& query) const {
 
-        discussion d = create_discussion(o);
+        discussion d = create_query_discussion(o, query);
         fill_discussion(d, query);
 
         return d;
@@ -218,6 +319,9 @@ namespace golos { namespace plugins { namespace tags {
     void tags_plugin::plugin_initialize(const boost::program_options::variables_map& options) {
         pimpl = std::make_unique<impl>();
         auto& db = pimpl->database();
+        db.pre_apply_operation.connect([&](const operation_notification& note) {
+            pimpl->on_pre_operation(note);
+        });
         db.post_apply_operation.connect([&](const operation_notification& note) {
             pimpl->on_operation(note);
         });
@@ -225,6 +329,7 @@ namespace golos { namespace plugins { namespace tags {
         add_plugin_index<tags::tag_stats_index>(db);
         add_plugin_index<tags::author_tag_stats_index>(db);
         add_plugin_index<tags::language_index>(db);
+        add_plugin_index<tags::comment_tags_index>(db);
 
         pimpl->tags_number = options.at("tags-number").as<uint16_t>();
         pimpl->tag_max_length = options.at("tag-max-length").as<uint16_t>();
@@ -295,6 +400,9 @@ namespace golos { namespace plugins { namespace tags {
 
             query.start_comment = create_discussion(*comment, query);
             auto& d = query.start_comment;
+            if (!query.has_field("pending_payout")) {
+                set_pending_payout(d); // promoted is used in the order of discussions
+            }
             operation_visitor v(database_, tags_number, tag_max_length);
 
             d.hot = v.calculate_hot(d.net_rshares, d.created);
@@ -328,6 +436,22 @@ namespace golos { namespace plugins { namespace tags {
         return true;
     }
 
+    bool tags_plugin::impl::is_good_tags(const discussion_query& query, const discussion& d) const {
+        if (!query.has_tags_query()) {
+            return true;
+        }
+
+        const auto& idx = database().get_index<tags::comment_tags_index>().indices().get<tags::by_comment>();
+        auto itr = idx.find(d.id);
+        if (itr != idx.end()) {
+            return query.is_good_tags(*itr);
+        }
+
+        // the comment was created before the index, json_metadata of discussion can be not requested
+        auto json_metadata = social_network::get_json_metadata(database_, database_.get_comment(d.id));
+        return query.is_good_tags(get_metadata(json_metadata, tags_number, tag_max_length));
+    }
+
     template<
         typename DatabaseIndex,
         typename DiscussionIndex,
@@ -381,8 +505,8 @@ namespace golos { namespace plugins { namespace tags {
                     continue;
                 }
 
-                discussion d = create_discussion(*comment);
-                if (!query.is_good_tags(d, tags_number, tag_max_length)) {
+                discussion d = create_query_discussion(*comment, query);
+                if (!is_good_tags(query, d)) {
                     continue;
                 }
 
@@ -424,10 +548,10 @@ namespace golos { namespace plugins { namespace tags {
                 continue;
             }
 
-            discussion d = create_discussion(*comment);
+            discussion d = create_query_discussion(*comment, query);
             d.promoted = asset(itr->promoted_balance, SBD_SYMBOL);
 
-            if (!select(d) || !query.is_good_tags(d, tags_number, tag_max_length)) {
+            if (!select(d) || !is_good_tags(query, d)) {
                 continue;
             }
 
@@ -443,6 +567,59 @@ namespace golos { namespace plugins { namespace tags {
         }
     }
 
+    template<
+        typename DiscussionOrder,
+        typename Selector>
+    void tags_plugin::impl::select_tag_discussions(
+        std::set<comment_object::id_type>& id_set,
+        std::vector<discussion>& result,
+        const discussion_query& query,
+        const std::string& name, tags::tag_type type,
+        Selector&& selector,
+        std::true_type
+    ) const {
+        using ordered_index = tag_ordered_index<DiscussionOrder>;
+
+        const auto& idx = database().get_index<tags::tag_index>().indices().get<typename ordered_index::type>();
+        auto itr = idx.lower_bound(std::make_tuple(name, type));
+        if (query.has_start_comment()) {
+            // discussions before the start one are skipped without reading
+            itr = idx.lower_bound(std::make_tuple(
+                name, type, ordered_index::value(query.start_comment), query.start_comment.id));
+        }
+
+        // the tag can't give more than limit discussions to the result
+        const auto size = result.size();
+        select_discussions(
+            id_set, result, query, itr, idx.end(),
+            selector,
+            [&](const tags::tag_object& tag) {
+                return tag.name != name || tag.type != type || result.size() - size >= query.limit;
+            },
+            DiscussionOrder());
+    }
+
+    template<
+        typename DiscussionOrder,
+        typename Selector>
+    void tags_plugin::impl::select_tag_discussions(
+        std::set<comment_object::id_type>& id_set,
+        std::vector<discussion>& result,
+        const discussion_query& query,
+        const std::string& name, tags::tag_type type,
+        Selector&& selector,
+        std::false_type
+    ) const {
+        const auto& idx = database().get_index<tags::tag_index>().indices().get<tags::by_tag>();
+        select_discussions(
+            id_set, result, query, idx.lower_bound(std::make_tuple(name, type)), idx.end(),
+            selector,
+            [&](const tags::tag_object& tag) {
+                return tag.name != name || tag.type != type;
+            },
+            DiscussionOrder());
+    }
+
     template<
         typename DiscussionOrder,
         typename Selector>
@@ -462,18 +639,12 @@ namespace golos { namespace plugins { namespace tags {
 
             std::set<comment_object::id_type> id_set;
             if (query.has_tags_selector()) { // seems to have a least complexity
-                const auto& idx = db.get_index<tags::tag_index>().indices().get<tags::by_tag>();
-                auto etr = idx.end();
                 unordered.reserve(query.select_tags.size() * query.limit);
 
                 for (auto& name: query.select_tags) {
-                    select_discussions(
-                        id_set, unordered, query, idx.lower_bound(std::make_tuple(name, tags::tag_type::tag)), etr,
-                        selector,
-                        [&](const tags::tag_object& tag){
-                            return tag.name != name || tag.type != tags::tag_type::tag;
-                        },
-                        DiscussionOrder());
+                    select_tag_discussions<DiscussionOrder>(
+                        id_set, unordered, query, name, tags::tag_type::tag, selector,
+                        tag_ordered_index<DiscussionOrder>());
                 }
             } else if (query.has_author_selector()) { // a more complexity
                 const auto& idx = db.get_index<tags::tag_index>().indices().get<tags::by_author_comment>();
@@ -490,18 +661,12 @@ namespace golos { namespace plugins { namespace tags {
                         DiscussionOrder());
                 }
             } else if (query.has_language_selector()) { // the most complexity
-                const auto& idx = db.get_index<tags::tag_index>().indices().get<tags::by_tag>();
-                auto etr = idx.end();
                 unordered.reserve(query.select_languages.size() * query.limit);
 
                 for (auto& name: query.select_languages) {
-                    select_discussions(
-                        id_set, unordered, query, idx.lower_bound(std::make_tuple(name, tags::tag_type::language)), etr,
-                        selector,
-                        [&](const tags::tag_object& tag){
-                            return tag.name != name || tag.type != tags::tag_type::language;
-                        },
-                        DiscussionOrder());
+                    select_tag_discussions<DiscussionOrder>(
+                        id_set, unordered, query, name, tags::tag_type::language, selector,
+                        tag_ordered_index<DiscussionOrder>());
                 }
             } else {
                 const auto& indices = db.get_index<tags::tag_index>().indices();
@@ -663,18 +828,14 @@ namespace golos { namespace plugins { namespace tags {
 
             for (; itr != clu_idx.end() && itr->author == *query.start_author && result.size() < query.limit; ++itr) {
                 if (itr->parent_author.size() > 0) {
-                    discussion p;
                     auto& comment = db.get_comment(itr->comment);
-                    pimpl->fill_comment_api_object(db.get_comment(comment.root_comment), p);
-                    if (!query.is_good_tags(p, pimpl->tags_number, pimpl->tag_max_length) ||
+                    auto p = pimpl->create_discussion_without_content(db.get_comment(comment.root_comment));
+                    if (!pimpl->is_good_tags(query, p) ||
                         !query.is_good_author(p.author)
                     ) {
                         continue;
                     }
-                    discussion d;
-                    pimpl->fill_comment_api_object(comment, d);
-                    result.push_back(std::move(d));
-                    pimpl->fill_discussion(result.back(), query);
+                    result.push_back(pimpl->create_discussion(comment, query));
                 }
             }
             return result;
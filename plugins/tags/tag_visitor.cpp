@@ -60,6 +60,60 @@ namespace golos { namespace plugins { namespace tags {
           tag_max_length_(tag_max_length) {
     }
 
+    comment_metadata operation_visitor::update_comment_metadata(const comment_object& comment) const {
+        auto meta = get_metadata(db_, comment, tags_number_, tag_max_length_);
+
+        auto fill = [&](comment_tags_object& obj) {
+            obj.comment = comment.id;
+            obj.language = meta.language;
+            obj.tags.clear();
+            obj.tags.reserve(meta.tags.size());
+            for (const auto& name: meta.tags) {
+                obj.tags.push_back(name);
+            }
+        };
+
+        const auto& idx = db_.get_index<comment_tags_index>().indices().get<by_comment>();
+        auto itr = idx.find(comment.id);
+        if (itr != idx.end()) {
+            db_.modify(*itr, fill);
+        } else {
+            db_.create<comment_tags_object>(fill);
+        }
+        return meta;
+    }
+
+    comment_metadata operation_visitor::get_comment_metadata(const comment_object& comment) const {
+        const auto& idx = db_.get_index<comment_tags_index>().indices().get<by_comment>();
+        auto itr = idx.find(comment.id);
+        if (itr == idx.end()) {
+            // the comment was created before the index
+            return get_metadata(db_, comment, tags_number_, tag_max_length_);
+        }
+
+        comment_metadata meta;
+        meta.language = std::string(itr->language);
+        for (const auto& name: itr->tags) {
+            meta.tags.insert(std::string(name));
+        }
+        return meta;
+    }
+
+    void operation_visitor::remove_comment_metadata(
+        const account_name_type& author, const std::string& permlink
+    ) const {
+        const auto* comment = db_.find_comment(author, permlink);
+        if (!comment) {
+            return;
+        }
+
+        const auto& idx = db_.get_index<comment_tags_index>().indices().get<by_comment>();
+        auto itr = idx.find(comment->id);
+        if (itr != idx.end()) {
+            db_.remove(*itr);
+        }
+    }
+
     void operation_visitor::remove_stats(const tag_object& tag) const {
         const auto& idx = db_.get_index<tag_stats_index>().indices().get<by_tag>();
         auto itr = idx.find(std::make_tuple(tag.type, tag.name));
@@ -244,7 +298,7 @@ namespace golos { namespace plugins { namespace tags {
         auto trending = calculate_trending(comment.net_rshares, comment.created);
         const auto& comment_idx = db_.get_index<tag_index>().indices().get<by_comment>();
 
-        auto meta = get_metadata(db_, comment, tags_number_, tag_max_length_);
+        auto meta = get_comment_metadata(comment);
         auto citr = comment_idx.lower_bound(comment.id);
         const tag_object* language_tag = nullptr;
 
@@ -377,7 +431,7 @@ namespace golos { namespace plugins { namespace tags {
         const auto& comment = db_.get_comment(op.author, op.permlink);
         const auto& author = db_.get_account(op.author).id;
 
-        auto meta = get_metadata(db_, comment, tags_number_, tag_max_length_);
+        auto meta = get_comment_metadata(comment);
         const auto& stats_idx = db_.get_index<tag_stats_index>().indices().get<by_tag>();
         const auto& auth_idx = db_.get_index<author_tag_stats_index>().indices().get<by_author_tag_posts>();
 
@@ -408,6 +462,7 @@ namespace golos { namespace plugins { namespace tags {
 
     void operation_visitor::operator()(const comment_operation& op) const {
         const auto& comment = db_.get_comment(op.author, op.permlink);
+        update_comment_metadata(comment);
 
         if (db_.calculate_discussion_payout_time(comment) != fc::time_point_sec::maximum()) {
             // in a cashout window
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <fc/reflect/reflect.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+namespace golos { namespace plugins { namespace webserver {
+
+    enum class request_priority: uint8_t {
+        high,    ///< broadcasts and cheap state queries
+        normal,
+        low      ///< heavy scans, they are processed when there are no other requests
+    };
+
+    struct request_scheduler_stats final {
+        uint32_t queue_depth = 0;
+        uint32_t running = 0;
+        uint64_t executed = 0;
+        uint64_t rejected_queue = 0;       ///< rejected because the queue of the priority class is full
+        uint64_t rejected_connection = 0;  ///< rejected because the connection has too many pending requests
+    };
+
+    /**
+     * Bounded queue of API requests processed by a fixed number of threads.
+     *
+     * Requests are taken by priority classes, and in the order of arrival inside a class.
+     * Each class has its own queue of queue_size requests, so a flood of low priority requests
+     * doesn't cause rejection of high priority ones. A request is rejected if the queue of its class
+     * is full or if its connection already has connection_limit queued and running requests.
+     */
+    class request_scheduler final {
+    public:
+        using task_type = std::function<void()>;
+
+        request_scheduler(uint32_t thread_pool_size, uint32_t queue_size, uint32_t connection_limit);
+
+        ~request_scheduler();
+
+        void start();
+
+        void stop();
+
+        /// @return false if the request is rejected
+        bool post(request_priority priority, const void* connection, task_type task);
+
+        /// Queues the task without limits, it is used for parts of already accepted requests
+        void execute(request_priority priority, task_type task);
+
+        request_scheduler_stats get_stats() const;
+
+    private:
+        struct impl;
+        std::unique_ptr<impl> _impl;
+    };
+
+} } } // golos::plugins::webserver
+
+FC_REFLECT_ENUM(golos::plugins::webserver::request_priority, (high)(normal)(low))
+
+FC_REFLECT((golos::plugins::webserver::request_scheduler_stats),
+    (queue_depth)(running)(executed)(rejected_queue)(rejected_connection))
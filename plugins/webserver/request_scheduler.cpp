@@ -0,0 +1,173 @@
+#include <golos/plugins/webserver/request_scheduler.hpp>
+
+#include <fc/exception/exception.hpp>
+#include <fc/log/logger.hpp>
+
+#include <array>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace golos { namespace plugins { namespace webserver {
+
+    namespace {
+
+        constexpr std::size_t priority_count = 3;
+
+        struct queued_task final {
+            const void* connection = nullptr;
+            request_scheduler::task_type task;
+        };
+
+    } // namespace
+
+    struct request_scheduler::impl final {
+        impl(uint32_t thread_pool_size, uint32_t queue_size, uint32_t connection_limit)
+            : thread_pool_size(thread_pool_size),
+              queue_size(queue_size),
+              connection_limit(connection_limit) {
+        }
+
+        bool pop(queued_task& result) {
+            std::unique_lock<std::mutex> lock(mutex);
+            cond.wait(lock, [&] {
+                return stopped || depth > 0;
+            });
+            if (stopped) {
+                return false;
+            }
+
+            for (auto& queue: queues) {
+                if (!queue.empty()) {
+                    result = std::move(queue.front());
+                    queue.pop_front();
+                    break;
+                }
+            }
+            --depth;
+            ++stats.running;
+            return true;
+        }
+
+        void done(const void* connection) {
+            std::lock_guard<std::mutex> lock(mutex);
+            --stats.running;
+            ++stats.executed;
+            if (connection != nullptr) {
+                auto itr = connections.find(connection);
+                if (itr != connections.end() && --itr->second == 0) {
+                    connections.erase(itr);
+                }
+            }
+        }
+
+        void run() {
+            queued_task item;
+            while (pop(item)) {
+                try {
+                    item.task();
+                } catch (const fc::exception& e) {
+                    elog("Error on processing of API request: ${e}", ("e", e.to_detail_string()));
+                } catch (const std::exception& e) {
+                    elog("Error on processing of API request: ${e}", ("e", e.what()));
+                } catch (...) {
+                    elog("Unknown error on processing of API request");
+                }
+                done(item.connection);
+                item = queued_task();
+            }
+        }
+
+        const uint32_t thread_pool_size;
+        const uint32_t queue_size;
+        const uint32_t connection_limit;
+
+        mutable std::mutex mutex;
+        std::condition_variable cond;
+        std::array<std::deque<queued_task>, priority_count> queues;
+        uint32_t depth = 0;
+        std::map<const void*, uint32_t> connections;
+        request_scheduler_stats stats;
+        bool stopped = false;
+
+        std::vector<std::thread> threads;
+    };
+
+    request_scheduler::request_scheduler(uint32_t thread_pool_size, uint32_t queue_size, uint32_t connection_limit)
+        : _impl(new impl(thread_pool_size, queue_size, connection_limit)) {
+    }
+
+    request_scheduler::~request_scheduler() {
+        stop();
+    }
+
+    void request_scheduler::start() {
+        for (uint32_t i = 0; i < _impl->thread_pool_size; ++i) {
+            _impl->threads.emplace_back([this] {
+                _impl->run();
+            });
+        }
+    }
+
+    void request_scheduler::stop() {
+        {
+            std::lock_guard<std::mutex> lock(_impl->mutex);
+            _impl->stopped = true;
+        }
+        _impl->cond.notify_all();
+
+        for (auto& thread: _impl->threads) {
+            thread.join();
+        }
+        _impl->threads.clear();
+    }
+
+    bool request_scheduler::post(request_priority priority, const void* connection, task_type task) {
+        {
+            std::lock_guard<std::mutex> lock(_impl->mutex);
+            if (_impl->stopped) {
+                return false;
+            }
+            auto& queue = _impl->queues[static_cast<std::size_t>(priority)];
+            if (_impl->queue_size && queue.size() >= _impl->queue_size) {
+                ++_impl->stats.rejected_queue;
+                return false;
+            }
+            if (_impl->connection_limit && connection != nullptr) {
+                auto& pending = _impl->connections[connection];
+                if (pending >= _impl->connection_limit) {
+                    ++_impl->stats.rejected_connection;
+                    return false;
+                }
+                ++pending;
+            } else {
+                connection = nullptr;
+            }
+
+            queue.push_back({connection, std::move(task)});
+            ++_impl->depth;
+        }
+        _impl->cond.notify_one();
+        return true;
+    }
+
+    void request_scheduler::execute(request_priority priority, task_type task) {
+        {
+            std::lock_guard<std::mutex> lock(_impl->mutex);
+            _impl->queues[static_cast<std::size_t>(priority)].push_back({nullptr, std::move(task)});
+            ++_impl->depth;
+        }
+        _impl->cond.notify_one();
+    }
+
+    request_scheduler_stats request_scheduler::get_stats() const {
+        std::lock_guard<std::mutex> lock(_impl->mutex);
+        auto result = _impl->stats;
+        result.queue_depth = _impl->depth;
+        return result;
+    }
+
+} } } // golos::plugins::webserver
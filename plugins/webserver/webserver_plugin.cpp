@@ -5,6 +5,7 @@
 #include <fc/network/ip.hpp>
 #include <fc/log/logger_config.hpp>
 #include <fc/io/json.hpp>
+#include <fc/variant_object.hpp>
 #include <fc/network/resolve.hpp>
 
 #include <boost/asio.hpp>
@@ -20,6 +21,9 @@
 #include <websocketpp/logger/stub.hpp>
 #include <websocketpp/logger/syslog.hpp>
 
+#include <boost/algorithm/string.hpp>
+
+#include <cctype>
 #include <thread>
 #include <memory>
 #include <iostream>
@@ -78,11 +82,9 @@ namespace golos {
 
             struct webserver_plugin::webserver_plugin_impl final {
             public:
-                boost::thread_group& thread_pool = appbase::app().scheduler();
-                webserver_plugin_impl(thread_pool_size_t thread_pool_size) : thread_pool_work(this->thread_pool_ios) {
-                    for (uint32_t i = 0; i < thread_pool_size; ++i) {
-                        thread_pool.create_thread(boost::bind(&asio::io_service::run, &thread_pool_ios));
-                    }
+                webserver_plugin_impl(thread_pool_size_t thread_pool_size, uint32_t queue_size, uint32_t connection_limit)
+                    : scheduler(thread_pool_size, queue_size, connection_limit) {
+                    scheduler.start();
                 }
 
                 void start_webserver();
@@ -93,6 +95,10 @@ namespace golos {
 
                 void handle_http_message(websocket_server_type *, connection_hdl);
 
+                request_priority get_priority(const std::string &api, const std::string &method) const;
+
+                request_priority get_priority(const std::string &body) const;
+
                 shared_ptr<std::thread> http_thread;
                 asio::io_service http_ios;
                 optional<tcp::endpoint> http_endpoint;
@@ -102,8 +108,11 @@ namespace golos {
                 asio::io_service ws_ios;
                 optional<tcp::endpoint> ws_endpoint;
                 websocket_server_type ws_server;
-                asio::io_service thread_pool_ios;
-                asio::io_service::work thread_pool_work;
+
+                request_scheduler scheduler;
+                std::map<std::string, request_priority> priorities; // api or api.method
+
+                bool concurrent_batch = false;
 
                 plugins::json_rpc::plugin *api;
                 boost::signals2::connection chain_sync_con;
@@ -173,8 +182,7 @@ namespace golos {
                     http_server.stop_listening();
                 }
 
-                thread_pool_ios.stop();
-                thread_pool.join_all();
+                scheduler.stop();
 
                 if (ws_thread) {
                     ws_ios.stop();
@@ -189,13 +197,133 @@ namespace golos {
                 }
             }
 
+            request_priority webserver_plugin::webserver_plugin_impl::get_priority(
+                const std::string &api, const std::string &method
+            ) const {
+                auto itr = priorities.find(api + "." + method);
+                if (itr == priorities.end()) {
+                    itr = priorities.find(api);
+                }
+                return itr != priorities.end() ? itr->second : request_priority::normal;
+            }
+
+            namespace {
+                void skip_spaces(const std::string &body, std::size_t &pos) {
+                    while (pos < body.size() && std::isspace(static_cast<unsigned char>(body[pos]))) {
+                        ++pos;
+                    }
+                }
+
+                bool read_char(const std::string &body, std::size_t &pos, char c) {
+                    skip_spaces(body, pos);
+                    if (pos < body.size() && body[pos] == c) {
+                        ++pos;
+                        return true;
+                    }
+                    return false;
+                }
+
+                // api and method names don't contain escaped characters
+                bool read_string(const std::string &body, std::size_t &pos, std::string &result) {
+                    if (!read_char(body, pos, '"')) {
+                        return false;
+                    }
+                    auto end = body.find('"', pos);
+                    if (end == std::string::npos) {
+                        return false;
+                    }
+                    result = body.substr(pos, end - pos);
+                    pos = end + 1;
+                    return true;
+                }
+
+                // The id of a single request, it's a number, a string or null.
+                // The id of a batch isn't looked for, an overload error of batch is returned with null id.
+                fc::variant get_request_id(const std::string &body) {
+                    std::size_t pos = 0;
+                    if (!read_char(body, pos, '{')) {
+                        return fc::variant();
+                    }
+
+                    static const std::string id = "\"id\"";
+                    for (pos = body.find(id, pos); pos != std::string::npos; pos = body.find(id, pos)) {
+                        pos += id.size();
+                        if (!read_char(body, pos, ':')) {
+                            continue;
+                        }
+                        skip_spaces(body, pos);
+                        auto end = pos;
+                        if (end < body.size() && body[end] == '"') {
+                            for (++end; end < body.size() && body[end] != '"'; ++end) {
+                                if (body[end] == '\\') {
+                                    ++end;
+                                }
+                            }
+                            ++end;
+                        } else {
+                            while (end < body.size() && (std::isalnum(static_cast<unsigned char>(body[end])) ||
+                                body[end] == '-' || body[end] == '+' || body[end] == '.')
+                            ) {
+                                ++end;
+                            }
+                        }
+                        if (end == pos || end > body.size()) {
+                            return fc::variant();
+                        }
+                        try {
+                            return fc::json::from_string(body.substr(pos, end - pos));
+                        } catch (const fc::exception &) {
+                            return fc::variant();
+                        }
+                    }
+                    return fc::variant();
+                }
+
+                std::string overloaded_response(const std::string &body) {
+                    return fc::json::to_string(fc::mutable_variant_object()
+                        ("jsonrpc", "2.0")
+                        ("error", fc::mutable_variant_object()
+                            ("code", SERVER_OVERLOADED)
+                            ("message", "Server is overloaded, try again later"))
+                        ("id", get_request_id(body)));
+                }
+            }
+
+            // The body isn't parsed before scheduling, only "params": ["api", "method", ...] are looked for.
+            // A batch gets the lowest priority of its items.
+            request_priority webserver_plugin::webserver_plugin_impl::get_priority(const std::string &body) const {
+                if (priorities.empty()) {
+                    return request_priority::normal;
+                }
+
+                static const std::string params = "\"params\"";
+                fc::optional<request_priority> result;
+                for (auto pos = body.find(params); pos != std::string::npos; pos = body.find(params, pos)) {
+                    pos += params.size();
+                    std::string api;
+                    std::string method;
+                    if (!read_char(body, pos, ':') || !read_char(body, pos, '[') ||
+                        !read_string(body, pos, api) || !read_char(body, pos, ',') ||
+                        !read_string(body, pos, method)
+                    ) {
+                        continue;
+                    }
+                    auto priority = get_priority(api, method);
+                    if (!result.valid() || *result < priority) {
+                        result = priority;
+                    }
+                }
+                return result.valid() ? *result : request_priority::normal;
+            }
+
             void webserver_plugin::webserver_plugin_impl::handle_ws_message(
                 websocket_server_type *server,
                 connection_hdl hdl,
                 websocket_server_type::message_ptr msg
             ) {
                 auto con = server->get_con_from_hdl(hdl);
-                thread_pool_ios.post([con, msg, this]() {
+                auto priority = get_priority(msg->get_payload());
+                bool accepted = scheduler.post(priority, con.get(), [con, msg, this]() {
                     try {
                         if (msg->get_opcode() == websocketpp::frame::opcode::text) {
                             api->call(msg->get_payload(), [con](const std::string &data){
@@ -211,13 +339,22 @@ namespace golos {
                         con->send("error calling API " + e.to_string());
                     }
                 });
+
+                if (!accepted) {
+                    try {
+                        con->send(overloaded_response(msg->get_payload()));
+                    } catch (...) {
+                        // connection can be already closed
+                    }
+                }
             }
 
             void webserver_plugin::webserver_plugin_impl::handle_http_message(websocket_server_type *server, connection_hdl hdl) {
                 auto con = server->get_con_from_hdl(hdl);
                 con->defer_http_response();
 
-                thread_pool_ios.post([con, this]() {
+                auto priority = get_priority(con->get_request_body());
+                bool accepted = scheduler.post(priority, con.get(), [con, this]() {
                     auto body = con->get_request_body();
 
                     try {
@@ -243,6 +380,16 @@ namespace golos {
                         }
                     }
                 });
+
+                if (!accepted) {
+                    con->set_body(overloaded_response(con->get_request_body()));
+                    con->set_status(websocketpp::http::status_code::service_unavailable);
+                    try {
+                        con->send_http_response();
+                    } catch (...) {
+                        // disable segfault
+                    }
+                }
             }
 
             webserver_plugin::webserver_plugin() {
@@ -259,15 +406,53 @@ namespace golos {
                         "Local websocket endpoint for webserver requests.")
                     ("rpc-endpoint", boost::program_options::value<string>(),
                         "Local http and websocket endpoint for webserver requests. Deprectaed in favor of webserver-http-endpoint and webserver-ws-endpoint")
-                    ("webserver-thread-pool-size", boost::program_options::value<thread_pool_size_t>()->default_value(256),
-                        "Number of threads used to handle queries. Default: 256.");
+                    ("webserver-thread-pool-size", boost::program_options::value<thread_pool_size_t>()->default_value(16),
+                        "Number of threads used to handle queries. Queries wait in the priority queues while all "
+                        "threads are busy, so a large pool only adds contention on the database lock. Default: 16.")
+                    ("webserver-queue-size", boost::program_options::value<uint32_t>()->default_value(1024),
+                        "Maximum number of queued queries of each priority class, new queries are rejected "
+                        "with the overload error (HTTP 503) when the queue of their class is full. 0 - unlimited. Default: 1024.")
+                    ("webserver-connection-limit", boost::program_options::value<uint32_t>()->default_value(16),
+                        "Maximum number of queued and processing queries of one connection. 0 - unlimited. Default: 16.")
+                    ("webserver-high-priority-api", boost::program_options::value<std::vector<string>>()->composing()->multitoken(),
+                        "APIs (api) or methods (api.method) which are processed before other queries. "
+                        "Default: network_broadcast_api database_api.get_dynamic_global_properties.")
+                    ("webserver-low-priority-api", boost::program_options::value<std::vector<string>>()->composing()->multitoken(),
+                        "APIs (api) or methods (api.method) which are processed when there are no other queries. "
+                        "Default: tags account_history.")
+                    ("webserver-concurrent-batch", boost::program_options::value<bool>()->default_value(false),
+                        "Process items of a batch request concurrently in the thread pool. "
+                        "Items are executed in arbitrary order, so don't enable it if clients send dependent items in a batch.");
             }
 
             void webserver_plugin::plugin_initialize(const boost::program_options::variables_map &options) {
                 auto thread_pool_size = options.at("webserver-thread-pool-size").as<thread_pool_size_t>();
                 FC_ASSERT(thread_pool_size > 0, "webserver-thread-pool-size must be greater than 0");
                 ilog("configured with ${tps} thread pool size", ("tps", thread_pool_size));
-                my.reset(new webserver_plugin_impl(thread_pool_size));
+                auto queue_size = options.at("webserver-queue-size").as<uint32_t>();
+                auto connection_limit = options.at("webserver-connection-limit").as<uint32_t>();
+                ilog("configured with ${qs} queue size and ${cl} queries per connection",
+                    ("qs", queue_size)("cl", connection_limit));
+                my.reset(new webserver_plugin_impl(thread_pool_size, queue_size, connection_limit));
+                my->concurrent_batch = options.at("webserver-concurrent-batch").as<bool>();
+
+                auto set_priorities = [&](const std::string &name, std::vector<string> names, request_priority priority) {
+                    if (options.count(name)) {
+                        names = options.at(name).as<std::vector<string>>();
+                    }
+                    for (const auto &item: names) {
+                        std::vector<string> values;
+                        boost::split(values, item, boost::is_any_of(" \t,"));
+                        for (const auto &value: values) {
+                            if (!value.empty()) {
+                                my->priorities[value] = priority;
+                            }
+                        }
+                    }
+                };
+                set_priorities("webserver-low-priority-api", {"tags", "account_history"}, request_priority::low);
+                set_priorities("webserver-high-priority-api",
+                    {"network_broadcast_api", "database_api.get_dynamic_global_properties"}, request_priority::high);
 
                 if (options.count("webserver-http-endpoint")) {
                     auto http_endpoint = options.at("webserver-http-endpoint").as<string>();
@@ -315,6 +500,12 @@ namespace golos {
                 my->api = appbase::app().find_plugin<plugins::json_rpc::plugin>();
                 FC_ASSERT(my->api != nullptr, "Could not find API Register Plugin");
 
+                if (my->concurrent_batch) {
+                    my->api->set_batch_executor([this](std::function<void()> task) {
+                        my->scheduler.execute(request_priority::normal, std::move(task));
+                    });
+                }
+
                 chain::plugin *chain = appbase::app().find_plugin<chain::plugin>();
                 if (chain != nullptr && chain->get_state() != appbase::abstract_plugin::started) {
                     ilog("Waiting for chain plugin to start");
@@ -330,6 +521,10 @@ namespace golos {
                 my->stop_webserver();
             }
 
+            request_scheduler_stats webserver_plugin::get_scheduler_stats() const {
+                return my->scheduler.get_stats();
+            }
+
         }
     }
 } // steem::plugins::webserver
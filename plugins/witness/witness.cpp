@@ -119,6 +119,7 @@ namespace golos {
 
                 uint32_t _production_skip_flags = golos::chain::database::skip_nothing;
                 bool _production_enabled = false;
+                bool _candidate_block = false;
                 asio::deadline_timer production_timer_;
 
                 std::map<public_key_type, fc::ecc::private_key> _private_keys;
@@ -142,6 +143,7 @@ namespace golos {
                         ("miner-account-creation-fee", bpo::value<uint64_t>()->implicit_value(100000), "Account creation fee to be voted on upon successful POW - Minimum fee is 100.000 STEEM (written as 100000)")
                         ("miner-maximum-block-size", bpo::value<uint32_t>()->implicit_value(131072), "Maximum block size (in bytes) to be voted on upon successful POW - Max block size must be between 128 KB and 750 MB")
                         ("miner-sbd-interest-rate", bpo::value<uint32_t>()->implicit_value(1000), "SBD interest rate to be vote on upon successful POW - Default interest rate is 10% (written as 1000)")
+                        ("witness-candidate-block", bpo::value<bool>()->default_value(false), "Keep the candidate block from pending transactions as they arrive, so on the slot time only the header is signed")
                         ;
 
                 config_file_options.add(command_line_options);
@@ -229,6 +231,10 @@ namespace golos {
                         pimpl->_miner_prop_vote.sbd_interest_rate = options["miner-sbd-interest-rate"].as<uint32_t>();
                     }
 
+                    if (options.count("witness-candidate-block")) {
+                        pimpl->_candidate_block = options["witness-candidate-block"].as<bool>();
+                    }
+
                     ilog("witness plugin:  plugin_initialize() end");
                 } FC_LOG_AND_RETHROW()
             }
@@ -249,6 +255,10 @@ namespace golos {
                             }
                             pimpl->_production_skip_flags |= golos::chain::database::skip_undo_history_check;
                         }
+                        if (pimpl->_candidate_block) {
+                            ilog("Keeping candidate block from pending transactions.");
+                            d.enable_candidate_block(true);
+                        }
                         pimpl->schedule_production_loop();
                     } else
                         elog("No witnesses configured! Please add witness names and private keys to configuration.");
@@ -324,7 +334,7 @@ namespace golos {
 
                 switch (result) {
                     case block_production_condition::produced:
-                        ilog("Generated block #${n} with timestamp ${t} at time ${c} by ${w}", (capture));
+                        ilog("Generated block #${n} with timestamp ${t} at time ${c} by ${w}, broadcast ${g} ms after slot time", (capture));
                         break;
                     case block_production_condition::not_synced:
                         // This log-record is commented, because it outputs very often
@@ -436,8 +446,11 @@ namespace golos {
                                 private_key_itr->second,
                                 _production_skip_flags
                         );
-                        capture("n", block.block_num())("t", block.timestamp)("c", now)("w", scheduled_witness);
                         p2p().broadcast_block(block);
+                        // negative if the block is produced before its slot (see the 500 ms rounding of now)
+                        auto gap = golos::time::now() - fc::time_point(scheduled_time);
+                        capture("n", block.block_num())("t", block.timestamp)("c", now)("w", scheduled_witness)
+                            ("g", gap.count() / 1000);
 
                         return block_production_condition::produced;
                     }
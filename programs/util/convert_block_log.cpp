@@ -0,0 +1,102 @@
+#include <golos/chain/block_log.hpp>
+#include <golos/chain/compressed_block_log.hpp>
+
+#include <fc/time.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <iostream>
+
+using golos::chain::block_log;
+using golos::chain::compressed_block_log;
+
+uint64_t files_size(const fc::path& file, std::initializer_list<const char*> suffixes) {
+    uint64_t result = 0;
+    for (auto suffix: suffixes) {
+        auto path = file.string() + suffix;
+        if (boost::filesystem::is_regular_file(path)) {
+            result += boost::filesystem::file_size(path);
+        }
+    }
+    return result;
+}
+
+template <typename Log>
+void measure_read(const char* name, const Log& log, uint32_t last_block_num) {
+    uint64_t raw_size = 0;
+    auto start = fc::time_point::now();
+    for (uint32_t block_num = 1; block_num <= last_block_num; ++block_num) {
+        raw_size += fc::raw::pack_size(*log.read_block_by_num(block_num));
+    }
+    auto elapsed = (fc::time_point::now() - start).count();
+    if (elapsed == 0) {
+        elapsed = 1;
+    }
+
+    ilog("${name}: read ${n} blocks in ${t} ms, ${bps} blocks/s, ${mbps} MB/s", ("name", name)
+        ("n", last_block_num)("t", elapsed / 1000)
+        ("bps", uint64_t(last_block_num) * 1000000 / elapsed)
+        ("mbps", raw_size / elapsed));
+}
+
+/**
+ * Converts block log to compressed block log (block log v2) and reports compression ratio and read throughput.
+ *
+ * Usage: convert_block_log <input block_log> <output block_log> [blocks per frame]
+ */
+int main(int argc, char** argv, char** envp) {
+    try {
+        if (argc < 3) {
+            std::cerr << "Usage: " << argv[0] << " <input block_log> <output block_log> [blocks per frame]" << std::endl;
+            return 1;
+        }
+
+        fc::path input_path(argv[1]);
+        fc::path output_path(argv[2]);
+        uint32_t frame_size = compressed_block_log::default_frame_size;
+        if (argc > 3) {
+            frame_size = std::stoul(argv[3]);
+        }
+
+        FC_ASSERT(!boost::filesystem::exists(output_path.string()),
+            "Output file ${path} already exists", ("path", output_path.string()));
+
+        block_log input;
+        input.open(input_path);
+        FC_ASSERT(input.head(), "Input block log is empty");
+        const auto last_block_num = input.head()->block_num();
+
+        compressed_block_log output;
+        output.open(output_path, frame_size);
+
+        ilog("Converting ${n} blocks to compressed block log with ${s} blocks per frame",
+            ("n", last_block_num)("s", frame_size));
+
+        auto start = fc::time_point::now();
+        for (uint32_t block_num = 1; block_num <= last_block_num; ++block_num) {
+            output.append(*input.read_block_by_num(block_num));
+            if (block_num % 100000 == 0) {
+                ilog("Converted ${n} of ${l} blocks", ("n", block_num)("l", last_block_num));
+            }
+        }
+        ilog("Converted ${n} blocks in ${t} sec", ("n", last_block_num)
+            ("t", (fc::time_point::now() - start).count() / 1000000));
+
+        const auto input_size = files_size(input_path, {"", ".index"});
+        const auto output_size = files_size(output_path, {"", ".index", ".head"});
+        ilog("Size of input ${i} bytes, size of output ${o} bytes, compression ratio ${r}",
+            ("i", input_size)("o", output_size)
+            ("r", output_size ? double(input_size) / output_size : 0.0));
+
+        measure_read("Input", input, last_block_num);
+        measure_read("Output", output, last_block_num);
+    } catch (const fc::exception& e) {
+        edump((e.to_detail_string()));
+        return 1;
+    } catch (const std::exception& e) {
+        edump((std::string(e.what())));
+        return 1;
+    }
+
+    return 0;
+}
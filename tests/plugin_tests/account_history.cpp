@@ -3,6 +3,8 @@
 
 #include "database_fixture.hpp"
 
+#include <graphene/utilities/tempdir.hpp>
+
 
 using namespace golos::chain;
 using golos::plugins::json_rpc::msg_pack;
@@ -63,6 +65,59 @@ BOOST_AUTO_TEST_CASE(account_history_blocks) {
     BOOST_CHECK_EQUAL(blocks.size(), HISTORY_BLOCKS);
 }
 
+BOOST_AUTO_TEST_CASE(account_history_cold_store) {
+    BOOST_TEST_MESSAGE("Testing: account_history_cold_store");
+    fc::temp_directory cold_dir(golos::utilities::temp_directory_path());
+    initialize({
+        {"history-cold-blocks", "1"},
+        {"history-cold-dir", cold_dir.path().string()}});
+    add_operations();
+    generate_blocks(5);
+
+    BOOST_TEST_MESSAGE("--- Test operations are moved out of shared memory");
+    const auto& idx = db->get_index<account_history_index>().indices().get<by_account>();
+    auto itr = idx.lower_bound(std::make_tuple(account_name_type("bob"), uint32_t(-1)));
+    BOOST_CHECK(itr == idx.end() || itr->account != account_name_type("bob"));
+    BOOST_CHECK(boost::filesystem::exists(cold_dir.path() / "segment-000000.dat"));
+
+    auto get_history = [this](const std::string& acc, uint32_t from, uint32_t limit, const account_history_query& q) {
+        msg_pack mp;
+        mp.args = std::vector<fc::variant>({
+            fc::variant(acc), fc::variant(from), fc::variant(limit), fc::variant(q)});
+        return ah_plugin->get_account_history(mp);
+    };
+
+    BOOST_TEST_MESSAGE("--- Test history is read from the cold store");
+    auto q = account_history_query();
+    auto bob_all = get_history("bob", -1, 10, q);
+    BOOST_CHECK_EQUAL(bob_all.size(), 8);
+    BOOST_CHECK_EQUAL(bob_all.rbegin()->first, 7);
+    BOOST_CHECK(bob_all.rbegin()->second.op.which() == operation::tag<delete_comment_operation>::value);
+
+    auto bob_page = get_history("bob", 5, 2, q);
+    BOOST_CHECK_EQUAL(bob_page.size(), 3);
+    BOOST_CHECK_EQUAL(bob_page.begin()->first, 3);
+    BOOST_CHECK_EQUAL(bob_page.rbegin()->first, 5);
+
+    BOOST_TEST_MESSAGE("--- Test filtering of the cold store");
+    q.direction = operation_direction::sender;
+    auto bob_sender = get_history("bob", -1, 10, q);
+    BOOST_CHECK_EQUAL(bob_sender.size(), 4);
+
+    BOOST_TEST_MESSAGE("--- Test summary counts operations in the cold store");
+    msg_pack mp;
+    mp.args = std::vector<fc::variant>({fc::variant("bob")});
+    BOOST_CHECK_EQUAL(ah_plugin->get_account_history_summary(mp).total, 8);
+
+    BOOST_TEST_MESSAGE("--- Test sequence continues after the cold store");
+    transfer(STEEMIT_INIT_MINER_NAME, "bob", 1);
+    generate_block();
+    q = account_history_query();
+    auto bob_new = get_history("bob", -1, 10, q);
+    BOOST_CHECK_EQUAL(bob_new.rbegin()->first, 8);
+    BOOST_CHECK(bob_new.rbegin()->second.op.which() == operation::tag<transfer_operation>::value);
+}
+
 
 ///////////////////////////////////////////////////////////////
 // filtering
@@ -150,6 +205,26 @@ BOOST_AUTO_TEST_CASE(account_history_filter) {
     auto bob_dual = get_history("bob", -1, 10, q);
     check_ops(bob_dual, "transfer_to_vesting|vote|delete_comment");
 
+    BOOST_TEST_MESSAGE("--- Test summary of operations");
+    msg_pack mp;
+    mp.args = std::vector<fc::variant>({fc::variant("bob")});
+    auto bob_summary = ah_plugin->get_account_history_summary(mp);
+    BOOST_CHECK_EQUAL(bob_summary.account, "bob");
+    BOOST_CHECK_EQUAL(bob_summary.total, 8);
+    std::map<std::pair<std::string, operation_direction>, uint32_t> bob_counts;
+    for (const auto& item: bob_summary.operations) {
+        bob_counts[std::make_pair(item.op, item.direction)] = item.count;
+    }
+    BOOST_CHECK_EQUAL(bob_counts.size(), 7);
+    BOOST_CHECK_EQUAL((bob_counts[{"vote", operation_direction::receiver}]), 2);
+    BOOST_CHECK_EQUAL((bob_counts[{"vote", operation_direction::dual}]), 1);
+    BOOST_CHECK_EQUAL((bob_counts[{"comment", operation_direction::sender}]), 1);
+
+    mp.args = std::vector<fc::variant>({fc::variant("nobody")});
+    auto nobody_summary = ah_plugin->get_account_history_summary(mp);
+    BOOST_CHECK_EQUAL(nobody_summary.total, 0);
+    BOOST_CHECK(nobody_summary.operations.empty());
+
     BOOST_TEST_MESSAGE("--- Test virtual only select");
     q.direction = operation_direction::any;
     q.select_ops = op_names({"VIRTUAL"});
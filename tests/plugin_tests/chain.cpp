@@ -78,6 +78,10 @@ struct chain_fixture : public golos::chain::database_fixture {
         const auto n = db->get_index<golos::chain::comment_vote_index>().indices().size();
         return n;
     }
+
+    uint32_t count_post_votes() {
+        return db->get_comment("alice", std::string("post")).vote_count;
+    }
 };
 
 
@@ -129,12 +133,14 @@ BOOST_AUTO_TEST_CASE(clear_votes_before_block) {
     auto interval = cashout_blocks / 5;
     vote_sequence("alice", "post", 4, interval);
     BOOST_CHECK_EQUAL(9, count_stored_votes());
+    BOOST_CHECK_EQUAL(9, count_post_votes());
 
     BOOST_TEST_MESSAGE("--- go to 1 block before cashout and check 9 votes stored");
     generate_blocks(interval - 1);
     const auto& post = db->get_comment("alice", std::string("post"));
     BOOST_CHECK(post.mode != golos::chain::archived);
     BOOST_CHECK_EQUAL(9, count_stored_votes());
+    BOOST_CHECK_EQUAL(9, count_post_votes());
 
     BOOST_TEST_MESSAGE("--- go to cashout block and check votes removed");
     generate_blocks(1);
@@ -143,23 +149,28 @@ BOOST_AUTO_TEST_CASE(clear_votes_before_block) {
         BOOST_CHECK_EQUAL(post.mode, golos::chain::archived);
     }
     BOOST_CHECK_EQUAL(0, count_stored_votes());
+    BOOST_CHECK_EQUAL(0, count_post_votes());
 
     BOOST_TEST_MESSAGE("--- go to just before 'clear-votes-before-block', vote and check 1 vote stored");
     generate_blocks(cashout_blocks - 1);
     vote_sequence("alice", "post", 1);
     BOOST_CHECK_EQUAL(1, count_stored_votes());
+    BOOST_CHECK_EQUAL(1, count_post_votes());
 
     BOOST_TEST_MESSAGE("--- check, vote removed in the next block");
     generate_blocks(1);
     BOOST_CHECK_EQUAL(0, count_stored_votes());
+    BOOST_CHECK_EQUAL(0, count_post_votes());
 
     BOOST_TEST_MESSAGE("--- vote 5 times and check 5 votes stored");
     vote_sequence("alice", "post", 5, 10);
     BOOST_CHECK_EQUAL(5, count_stored_votes());
+    BOOST_CHECK_EQUAL(5, count_post_votes());
 
     BOOST_TEST_MESSAGE("--- go to future and check 5 votes still stored");
     generate_blocks(cashout_blocks);
     BOOST_CHECK_EQUAL(5, count_stored_votes());
+    BOOST_CHECK_EQUAL(5, count_post_votes());
 }
 
 BOOST_AUTO_TEST_CASE(clear_votes_before_cashout_block) {
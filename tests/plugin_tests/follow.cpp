@@ -200,3 +200,113 @@ BOOST_AUTO_TEST_CASE(reblog_apply) {
 }
 
 BOOST_AUTO_TEST_SUITE_END()
+
+struct follow_pull_feed_fixture : public golos::chain::database_fixture {
+    follow_pull_feed_fixture() : golos::chain::database_fixture() {
+        initialize<golos::plugins::follow::plugin>({{"follow-feed-mode", "pull"}});
+        open_database();
+        startup();
+    }
+};
+
+BOOST_FIXTURE_TEST_SUITE(follow_pull_feed, follow_pull_feed_fixture)
+
+BOOST_AUTO_TEST_CASE(pull_feed) {
+    BOOST_TEST_MESSAGE("Testing: pull_feed");
+
+    ACTORS((alice)(bob)(carol)(dave));
+
+    generate_blocks(60 / STEEMIT_BLOCK_INTERVAL);
+    signed_transaction tx;
+
+    auto push_follow_op = [&](const follow_plugin_operation& op, const std::string& account, const private_key_type& key) {
+        boost::container::vector<follow_plugin_operation> vec;
+        vec.push_back(op);
+
+        custom_binary_operation cop;
+        cop.required_posting_auths.insert(account);
+        cop.id = "follow";
+        cop.data = fc::raw::pack(vec);
+        BOOST_CHECK_NO_THROW(push_tx_with_ops(tx, key, cop));
+        generate_block();
+    };
+
+    auto push_post = [&](const std::string& author, const private_key_type& key) {
+        comment_operation op;
+        op.author = author;
+        op.permlink = "lorem";
+        op.parent_permlink = "ipsum";
+        op.title = "Lorem Ipsum";
+        op.body = "Lorem ipsum dolor sit amet.";
+        BOOST_CHECK_NO_THROW(push_tx_with_ops(tx, key, op));
+        generate_block();
+    };
+
+    follow_operation fop;
+    fop.follower = "alice";
+    fop.what = {"blog"};
+    fop.following = "bob";
+    push_follow_op(fop, "alice", alice_private_key);
+    fop.following = "carol";
+    push_follow_op(fop, "alice", alice_private_key);
+
+    push_post("bob", bob_private_key);
+    push_post("carol", carol_private_key);
+
+    reblog_operation rop;
+    rop.account = "carol";
+    rop.author = "bob";
+    rop.permlink = "lorem";
+    push_follow_op(rop, "carol", carol_private_key);
+
+    BOOST_TEST_MESSAGE("--- feed isn't stored");
+    BOOST_CHECK_EQUAL(db->get_index<feed_index>().indices().size(), 0);
+
+    BOOST_TEST_MESSAGE("--- feed is assembled from blogs");
+    auto* follow_plugin = find_plugin<golos::plugins::follow::plugin>();
+    msg_pack mp;
+    mp.args = std::vector<fc::variant>({fc::variant("alice"), fc::variant(0), fc::variant(10)});
+    auto feed = follow_plugin->get_feed_entries(mp);
+
+    BOOST_REQUIRE_EQUAL(feed.size(), 2);
+    BOOST_CHECK_EQUAL(feed[0].author, "bob");
+    BOOST_REQUIRE_EQUAL(feed[0].reblog_by.size(), 1);
+    BOOST_CHECK_EQUAL(feed[0].reblog_by[0], "carol");
+    BOOST_CHECK_EQUAL(feed[1].author, "carol");
+    BOOST_CHECK(feed[1].reblog_by.empty());
+    BOOST_CHECK(feed[0].entry_id > feed[1].entry_id);
+
+    BOOST_TEST_MESSAGE("--- paging by entry_id starts from it, as in push mode");
+    mp.args = std::vector<fc::variant>({fc::variant("alice"), fc::variant(0), fc::variant(1)});
+    auto page = follow_plugin->get_feed_entries(mp);
+    BOOST_REQUIRE_EQUAL(page.size(), 1);
+    BOOST_CHECK_EQUAL(page[0].author, "bob");
+    BOOST_CHECK_EQUAL(page[0].entry_id, feed[0].entry_id);
+
+    mp.args = std::vector<fc::variant>({fc::variant("alice"), fc::variant(page[0].entry_id), fc::variant(2)});
+    page = follow_plugin->get_feed_entries(mp);
+    BOOST_REQUIRE_EQUAL(page.size(), 2);
+    BOOST_CHECK_EQUAL(page[0].author, "bob");
+    BOOST_CHECK_EQUAL(page[1].author, "carol");
+
+    mp.args = std::vector<fc::variant>({fc::variant("alice"), fc::variant(page[1].entry_id - 1), fc::variant(10)});
+    page = follow_plugin->get_feed_entries(mp);
+    BOOST_CHECK_EQUAL(page.size(), 0);
+
+    BOOST_TEST_MESSAGE("--- older reblogs behind posts of other pages are returned");
+    fop.following = "dave";
+    push_follow_op(fop, "alice", alice_private_key);
+    push_post("dave", dave_private_key);
+    rop.account = "dave";
+    push_follow_op(rop, "dave", dave_private_key);
+
+    mp.args = std::vector<fc::variant>({fc::variant("alice"), fc::variant(0), fc::variant(1)});
+    page = follow_plugin->get_feed_entries(mp);
+    BOOST_REQUIRE_EQUAL(page.size(), 1);
+    BOOST_CHECK_EQUAL(page[0].author, "bob");
+    BOOST_REQUIRE_EQUAL(page[0].reblog_by.size(), 2);
+    BOOST_CHECK_EQUAL(page[0].reblog_by[0], "carol");
+    BOOST_CHECK_EQUAL(page[0].reblog_by[1], "dave");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
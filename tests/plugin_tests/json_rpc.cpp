@@ -15,11 +15,39 @@ using namespace golos::protocol;
 
 typedef golos::plugins::json_rpc::plugin json_rpc_plugin;
 
+namespace test_plugin {
+
+    struct stream_item final {
+        std::string name;
+        fc::optional<uint32_t> value;
+        asset amount;
+        std::vector<char> data;
+        std::map<std::string, std::vector<uint16_t>> tags;
+    };
+
+} // namespace test_plugin
+
+FC_REFLECT((test_plugin::stream_item), (name)(value)(amount)(data)(tags))
+JSON_RPC_STREAM_OBJECT(test_plugin::stream_item)
+
 namespace test_plugin {
 
     using golos::plugins::json_rpc::msg_pack;
 
     DEFINE_API_ARGS(throw_exception, msg_pack, std::string)
+    DEFINE_API_ARGS(get_stream_items, msg_pack, std::vector<stream_item>)
+
+    std::vector<stream_item> make_stream_items() {
+        std::vector<stream_item> items(3);
+        items[0].name = "first \"quoted\"";
+        items[0].value = 10;
+        items[0].amount = asset(1000, STEEM_SYMBOL);
+        items[1].name = "second";
+        items[1].data = {'a', 'b'};
+        items[1].tags["tag"] = {1, 2, 3};
+        items[2].value = 0xffffffff;
+        return items;
+    }
 
     class testing_api final : public appbase::plugin<testing_api> {
     public:
@@ -47,9 +75,13 @@ namespace test_plugin {
 
         void plugin_shutdown() override { }
 
-        DECLARE_API((throw_exception))
+        DECLARE_API((throw_exception)(get_stream_items))
     };
 
+    DEFINE_API(testing_api, get_stream_items) {
+        return make_stream_items();
+    }
+
     DEFINE_API(testing_api, throw_exception) {
         auto error = args.args->at(0).get_string();
 
@@ -109,6 +141,37 @@ void check_error_response(const fc::variant& response, const fc::variant& id, in
 
 BOOST_FIXTURE_TEST_SUITE(json_rpc, database_fixture)
 
+    BOOST_AUTO_TEST_CASE(json_stream_test) {
+        try {
+            using golos::plugins::json_rpc::write_json;
+
+            auto items = test_plugin::make_stream_items();
+
+            BOOST_TEST_MESSAGE("--- streamed JSON is the same as JSON of variant");
+            std::string json;
+            write_json(json, items);
+            BOOST_CHECK_EQUAL(json, fc::json::to_string(fc::variant(items)));
+
+            std::map<uint32_t, test_plugin::stream_item> history;
+            history[1] = items[0];
+            history[5] = items[1];
+            json.clear();
+            write_json(json, history);
+            BOOST_CHECK_EQUAL(json, fc::json::to_string(fc::variant(history)));
+
+            fc::optional<test_plugin::stream_item> item;
+            json.clear();
+            write_json(json, item);
+            BOOST_CHECK_EQUAL(json, fc::json::to_string(fc::variant(item)));
+
+            item = items[2];
+            json.clear();
+            write_json(json, item);
+            BOOST_CHECK_EQUAL(json, fc::json::to_string(fc::variant(item)));
+        }
+        FC_LOG_AND_RETHROW()
+    }
+
     BOOST_AUTO_TEST_CASE(json_rpc_test) {
         try {
             initialize();
@@ -280,6 +343,90 @@ BOOST_FIXTURE_TEST_SUITE(json_rpc, database_fixture)
                 check_error_response(response, fc::variant(1u), JSON_RPC_INTERNAL_ERROR);
             });
 
+            BOOST_TEST_MESSAGE("--- streamed result");
+            BOOST_CHECK_NO_THROW({
+                auto response = call(rpc_plugin, "{\"id\":7, \"jsonrpc\":\"2.0\",\"method\":\"call\",\"params\":["
+                        "\"testing_api\",\"get_stream_items\",[]]}").get_object();
+                BOOST_CHECK_EQUAL(response["jsonrpc"].get_string(), "2.0");
+                BOOST_CHECK_EQUAL(response["id"].as_uint64(), 7);
+                BOOST_CHECK(!response.contains("error"));
+                BOOST_CHECK_EQUAL(fc::json::to_string(response["result"]),
+                    fc::json::to_string(fc::variant(test_plugin::make_stream_items())));
+            });
+
+            BOOST_TEST_MESSAGE("--- cached result");
+            {
+                auto& cache = rpc_plugin.get_response_cache();
+                cache.add_method("testing_api.get_stream_items", golos::plugins::json_rpc::response_cache::milliseconds(0));
+                BOOST_CHECK(cache.enabled());
+
+                auto request = "{\"id\":7, \"jsonrpc\":\"2.0\",\"method\":\"call\",\"params\":["
+                    "\"testing_api\",\"get_stream_items\",[]]}";
+                auto expected = fc::json::to_string(fc::variant(test_plugin::make_stream_items()));
+                BOOST_CHECK_EQUAL(fc::json::to_string(call(rpc_plugin, request)["result"]), expected);
+                BOOST_CHECK_EQUAL(fc::json::to_string(call(rpc_plugin, request)["result"]), expected);
+
+                auto stats = cache.get_stats();
+                BOOST_CHECK_EQUAL(stats.entries, 1);
+                BOOST_REQUIRE_EQUAL(stats.methods.size(), 1);
+                BOOST_CHECK_EQUAL(stats.methods[0].hits, 1);
+                BOOST_CHECK_EQUAL(stats.methods[0].misses, 1);
+
+                cache.on_block();
+                BOOST_CHECK_EQUAL(cache.get_stats().entries, 0);
+                BOOST_CHECK_EQUAL(fc::json::to_string(call(rpc_plugin, request)["result"]), expected);
+                BOOST_CHECK_EQUAL(cache.get_stats().methods[0].misses, 2);
+            }
+
+            BOOST_TEST_MESSAGE("--- stats of calls by methods");
+            auto& stats = rpc_plugin.get_rpc_stats();
+            stats.enable(true);
+            call(rpc_plugin, "{\"id\":1, \"jsonrpc\":\"2.0\",\"method\":\"call\",\"params\":["
+                "\"testing_api\",\"throw_exception\",[\"business_exception\"]]}");
+            call(rpc_plugin, "{\"id\":1, \"jsonrpc\":\"2.0\",\"method\":\"call\",\"params\":["
+                "\"testing_api\",\"throw_exception\",[\"invalid_parameter\"]]}");
+            {
+                auto items = stats.get();
+                BOOST_REQUIRE_EQUAL(items.size(), 1);
+                BOOST_CHECK_EQUAL(items[0].method, "testing_api.throw_exception");
+                BOOST_CHECK_EQUAL(items[0].count, 2);
+                BOOST_CHECK_EQUAL(items[0].errors, 2);
+                BOOST_CHECK_GT(items[0].request_bytes, 0);
+                BOOST_CHECK_GT(items[0].response_bytes, 0);
+                BOOST_CHECK_LE(items[0].p50_us, items[0].p99_us);
+            }
+            stats.clear();
+            stats.enable(false);
+            BOOST_CHECK(stats.get().empty());
+
+            BOOST_TEST_MESSAGE("--- concurrent batch keeps order of responses");
+            std::vector<std::function<void()>> tasks;
+            rpc_plugin.set_batch_executor([&](std::function<void()> task) {
+                tasks.push_back(std::move(task));
+            });
+
+            fc::variant batch_response;
+            rpc_plugin.call("["
+                "{\"id\":1, \"jsonrpc\":\"2.0\",\"method\":\"call\",\"params\":[\"testing_api\",\"throw_exception\",[\"invalid_parameter\"]]},"
+                "{\"id\":2, \"jsonrpc\":\"2.0\",\"method\":\"call\",\"params\":[\"testing_api\",\"missing_method\",[]]},"
+                "{\"id\":3, \"jsonrpc\":\"2.0\",\"method\":\"call\",\"params\":[\"testing_api\",\"throw_exception\",[\"business_exception\"]]}"
+                "]", [&](const std::string& str) {batch_response = fc::json::from_string(str);});
+
+            BOOST_CHECK(batch_response.is_null());
+            BOOST_CHECK_EQUAL(tasks.size(), 2);
+            for (auto itr = tasks.rbegin(); itr != tasks.rend(); ++itr) {
+                (*itr)();
+            }
+
+            BOOST_CHECK_NO_THROW({
+                auto responses = batch_response.get_array();
+                BOOST_CHECK_EQUAL(responses.size(), 3);
+                check_error_response(responses[0], fc::variant(1u), SERVER_INVALID_PARAMETER, "invalid_parameter");
+                check_error_response(responses[1], fc::variant(2u), JSON_RPC_METHOD_NOT_FOUND);
+                check_error_response(responses[2], fc::variant(3u), SERVER_BUSINESS_LOGIC_ERROR, "business_exception");
+            });
+
+            rpc_plugin.set_batch_executor(json_rpc_plugin::task_executor_type());
         }
         FC_LOG_AND_RETHROW()
     }
@@ -0,0 +1,113 @@
+#include <boost/test/unit_test.hpp>
+
+#include "database_fixture.hpp"
+#include "helpers.hpp"
+
+#include <golos/chain/comment_object.hpp>
+#include <golos/plugins/tags/plugin.hpp>
+
+using golos::plugins::json_rpc::msg_pack;
+
+using golos::protocol::comment_operation;
+using golos::protocol::vote_operation;
+using golos::protocol::signed_transaction;
+
+using golos::plugins::tags::tags_plugin;
+using golos::plugins::tags::discussion_query;
+using golos::api::discussion;
+
+
+struct tags_fixture : public golos::chain::database_fixture {
+    tags_fixture() : golos::chain::database_fixture() {
+        initialize<tags_plugin>();
+        open_database();
+        startup();
+    }
+
+    void post(const std::string& author, const fc::ecc::private_key& key, const std::string& tag) {
+        comment_operation op;
+        op.author = author;
+        op.permlink = "post";
+        op.parent_permlink = "other";
+        op.title = "foo";
+        op.body = "bar";
+        op.json_metadata = "{\"tags\":[\"" + tag + "\"]}";
+        signed_transaction tx;
+        GOLOS_CHECK_NO_THROW(push_tx_with_ops(tx, key, op));
+    }
+
+    std::vector<discussion> get_discussions(
+        std::vector<discussion> (tags_plugin::*method)(msg_pack&),
+        uint32_t limit, const std::string& start_author = std::string()
+    ) {
+        discussion_query query;
+        query.select_tags = {"test"};
+        query.limit = limit;
+        if (!start_author.empty()) {
+            query.start_author = start_author;
+            query.start_permlink = "post";
+        }
+        msg_pack mp;
+        mp.args = std::vector<fc::variant>({fc::variant(query)});
+        return (find_plugin<tags_plugin>()->*method)(mp);
+    }
+};
+
+
+BOOST_FIXTURE_TEST_SUITE(tags_plugin_tests, tags_fixture)
+
+BOOST_AUTO_TEST_CASE(tag_ranking_ties) {
+    BOOST_TEST_MESSAGE("Testing: tag_ranking_ties");
+
+    ACTORS((alice)(bob)(carol));
+
+    fc::ecc::private_key voter_key = generate_private_key("voter");
+    for (auto i = 0; i < 3; i++) {
+        GOLOS_CHECK_NO_THROW(account_create("voter" + std::to_string(i), voter_key.get_public_key()));
+    }
+    generate_block();
+
+    BOOST_TEST_MESSAGE("--- posts are created in one block, so they have equal hot and trending");
+    post("alice", alice_private_key, "other");
+    post("bob", bob_private_key, "other");
+    post("carol", carol_private_key, "other");
+    generate_block();
+
+    BOOST_TEST_MESSAGE("--- tag objects of the queried tag are created in the reverse order of comments");
+    post("carol", carol_private_key, "test");
+    post("bob", bob_private_key, "test");
+    post("alice", alice_private_key, "test");
+    generate_block();
+
+    BOOST_TEST_MESSAGE("--- voters with equal vesting give equal rshares");
+    std::vector<std::string> authors = {"alice", "bob", "carol"};
+    for (auto i = 0; i < 3; i++) {
+        vote_operation op;
+        op.voter = "voter" + std::to_string(i);
+        op.author = authors[i];
+        op.permlink = "post";
+        op.weight = STEEMIT_100_PERCENT;
+        signed_transaction tx;
+        GOLOS_CHECK_NO_THROW(push_tx_with_ops(tx, voter_key, op));
+    }
+    generate_block();
+    validate_database();
+
+    for (auto method: {&tags_plugin::get_discussions_by_trending, &tags_plugin::get_discussions_by_hot}) {
+        BOOST_TEST_MESSAGE("--- ties are broken by comment id");
+        auto page = get_discussions(method, 2);
+        BOOST_REQUIRE_EQUAL(page.size(), 2);
+        BOOST_CHECK_EQUAL(page[0].trending, page[1].trending);
+        BOOST_CHECK_EQUAL(page[0].hot, page[1].hot);
+        BOOST_CHECK_EQUAL(page[0].author, "alice");
+        BOOST_CHECK_EQUAL(page[1].author, "bob");
+
+        BOOST_TEST_MESSAGE("--- the next page starts from the last discussion and doesn't skip tied ones");
+        page = get_discussions(method, 2, "bob");
+        BOOST_REQUIRE_EQUAL(page.size(), 2);
+        BOOST_CHECK_EQUAL(page[0].author, "bob");
+        BOOST_CHECK_EQUAL(page[1].author, "carol");
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,108 @@
+#include <boost/test/unit_test.hpp>
+
+#include <golos/plugins/webserver/request_scheduler.hpp>
+
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using golos::plugins::webserver::request_priority;
+using golos::plugins::webserver::request_scheduler;
+
+namespace {
+
+    void wait_executed(const request_scheduler &scheduler, uint64_t count) {
+        for (int i = 0; i < 500 && scheduler.get_stats().executed < count; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        BOOST_REQUIRE_EQUAL(scheduler.get_stats().executed, count);
+    }
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(request_scheduler_tests)
+
+    BOOST_AUTO_TEST_CASE(priority_order) {
+        request_scheduler scheduler(1, 0, 0);
+        std::mutex mutex;
+        std::vector<int> order;
+        auto task = [&](int value) {
+            return [&, value]() {
+                std::lock_guard<std::mutex> lock(mutex);
+                order.push_back(value);
+            };
+        };
+
+        BOOST_TEST_MESSAGE("--- Requests are taken by priority, then by arrival");
+        BOOST_CHECK(scheduler.post(request_priority::low, nullptr, task(5)));
+        BOOST_CHECK(scheduler.post(request_priority::normal, nullptr, task(3)));
+        BOOST_CHECK(scheduler.post(request_priority::high, nullptr, task(1)));
+        BOOST_CHECK(scheduler.post(request_priority::normal, nullptr, task(4)));
+        BOOST_CHECK(scheduler.post(request_priority::high, nullptr, task(2)));
+        BOOST_CHECK_EQUAL(scheduler.get_stats().queue_depth, 5);
+
+        scheduler.start();
+        wait_executed(scheduler, 5);
+        scheduler.stop();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        BOOST_CHECK((order == std::vector<int>{1, 2, 3, 4, 5}));
+    }
+
+    BOOST_AUTO_TEST_CASE(queue_overflow) {
+        request_scheduler scheduler(1, 2, 0);
+        auto task = []() {};
+
+        BOOST_TEST_MESSAGE("--- Request is rejected when the queue of its class is full");
+        BOOST_CHECK(scheduler.post(request_priority::low, nullptr, task));
+        BOOST_CHECK(scheduler.post(request_priority::low, nullptr, task));
+        BOOST_CHECK(!scheduler.post(request_priority::low, nullptr, task));
+        BOOST_CHECK_EQUAL(scheduler.get_stats().rejected_queue, 1);
+
+        BOOST_TEST_MESSAGE("--- Other classes still accept requests");
+        BOOST_CHECK(scheduler.post(request_priority::high, nullptr, task));
+        BOOST_CHECK(scheduler.post(request_priority::normal, nullptr, task));
+        BOOST_CHECK_EQUAL(scheduler.get_stats().queue_depth, 4);
+
+        BOOST_TEST_MESSAGE("--- Parts of accepted requests are queued without limits");
+        scheduler.execute(request_priority::low, task);
+        BOOST_CHECK_EQUAL(scheduler.get_stats().queue_depth, 5);
+
+        scheduler.start();
+        wait_executed(scheduler, 5);
+
+        BOOST_TEST_MESSAGE("--- Request is accepted again after the queue is drained");
+        BOOST_CHECK(scheduler.post(request_priority::low, nullptr, task));
+        wait_executed(scheduler, 6);
+        scheduler.stop();
+    }
+
+    BOOST_AUTO_TEST_CASE(connection_limit) {
+        request_scheduler scheduler(1, 0, 2);
+        auto task = []() {};
+        int alice = 0;
+        int bob = 0;
+
+        BOOST_TEST_MESSAGE("--- Request is rejected when its connection has too many pending requests");
+        BOOST_CHECK(scheduler.post(request_priority::normal, &alice, task));
+        BOOST_CHECK(scheduler.post(request_priority::high, &alice, task));
+        BOOST_CHECK(!scheduler.post(request_priority::low, &alice, task));
+        BOOST_CHECK_EQUAL(scheduler.get_stats().rejected_connection, 1);
+
+        BOOST_TEST_MESSAGE("--- Other connections aren't limited by it");
+        BOOST_CHECK(scheduler.post(request_priority::normal, &bob, task));
+
+        scheduler.start();
+        wait_executed(scheduler, 3);
+
+        BOOST_TEST_MESSAGE("--- Connection is released when its requests are executed");
+        BOOST_CHECK(scheduler.post(request_priority::normal, &alice, task));
+        wait_executed(scheduler, 4);
+        scheduler.stop();
+
+        BOOST_TEST_MESSAGE("--- Stopped scheduler rejects requests");
+        BOOST_CHECK(!scheduler.post(request_priority::normal, &bob, task));
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
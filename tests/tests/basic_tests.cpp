@@ -313,4 +313,33 @@ BOOST_FIXTURE_TEST_SUITE(basic_tests, clean_database_fixture)
         BOOST_CHECK(block.calculate_merkle_root() == c(dO));
     }
 
+    BOOST_AUTO_TEST_CASE(precompute_signature_keys) {
+        auto alice_key = fc::ecc::private_key::regenerate(fc::sha256::hash(std::string("alice")));
+        auto bob_key = fc::ecc::private_key::regenerate(fc::sha256::hash(std::string("bob")));
+
+        signed_transaction tx;
+        tx.ref_block_prefix = 1;
+        tx.sign(alice_key, STEEMIT_CHAIN_ID);
+
+        BOOST_TEST_MESSAGE("--- Cached keys are equal to recovered ones");
+        auto keys = tx.get_signature_keys(STEEMIT_CHAIN_ID);
+        tx.precompute_signature_keys(STEEMIT_CHAIN_ID);
+        BOOST_CHECK(tx.get_signature_keys(STEEMIT_CHAIN_ID) == keys);
+        BOOST_CHECK(keys.count(alice_key.get_public_key()) == 1);
+
+        BOOST_TEST_MESSAGE("--- Copy of transaction shares the cache");
+        signed_transaction copy = tx;
+        BOOST_CHECK(copy.get_signature_keys(STEEMIT_CHAIN_ID) == keys);
+
+        BOOST_TEST_MESSAGE("--- Cache is ignored after changing of signatures");
+        tx.sign(bob_key, STEEMIT_CHAIN_ID);
+        keys = tx.get_signature_keys(STEEMIT_CHAIN_ID);
+        BOOST_CHECK_EQUAL(keys.size(), 2);
+        BOOST_CHECK(keys.count(bob_key.get_public_key()) == 1);
+
+        BOOST_TEST_MESSAGE("--- Cache is ignored after changing of transaction");
+        copy.ref_block_prefix = 2;
+        BOOST_CHECK(copy.get_signature_keys(STEEMIT_CHAIN_ID).count(alice_key.get_public_key()) == 0);
+    }
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -29,6 +29,7 @@
 
 #include <golos/chain/database.hpp>
 #include <golos/chain/steem_objects.hpp>
+#include <golos/chain/compressed_block_log.hpp>
 
 #include <golos/plugins/account_history/history_object.hpp>
 #include <golos/plugins/account_history/plugin.hpp>
@@ -37,6 +38,8 @@
 
 #include <fc/crypto/digest.hpp>
 
+#include <numeric>
+
 #include "database_fixture.hpp"
 
 using namespace golos;
@@ -749,5 +752,422 @@ BOOST_AUTO_TEST_SUITE(block_tests)
         FC_LOG_AND_RETHROW()
     }
 
+    BOOST_AUTO_TEST_CASE(compressed_block_log_test) {
+        try {
+            BOOST_TEST_MESSAGE("Testing: compressed_block_log");
+
+            fc::temp_directory data_dir(golos::utilities::temp_directory_path());
+            auto path = data_dir.path() / "block_log";
+
+            std::vector<signed_block> blocks;
+            auto make_block = [&]() {
+                signed_block b;
+                b.witness = "alice";
+                b.timestamp = fc::time_point_sec(STEEMIT_TESTING_GENESIS_TIMESTAMP + blocks.size() * 3);
+                if (!blocks.empty()) {
+                    b.previous = blocks.back().id();
+                }
+                blocks.push_back(b);
+                return b;
+            };
+
+            BOOST_TEST_MESSAGE("--- Append blocks to several frames and head frame");
+            {
+                compressed_block_log log;
+                log.open(path, 10);
+                for (int i = 0; i < 25; ++i) {
+                    BOOST_CHECK_EQUAL(log.append(make_block()), i);
+                }
+                BOOST_CHECK_EQUAL(log.head()->block_num(), 25);
+                BOOST_CHECK(log.head()->id() == blocks.back().id());
+                log.close();
+            }
+
+            BOOST_TEST_MESSAGE("--- Reopen through block_log and read blocks by num");
+            {
+                BOOST_CHECK(compressed_block_log::is_compressed(path));
+
+                block_log log;
+                log.open(path);
+                BOOST_CHECK(log.is_compressed());
+                BOOST_CHECK_EQUAL(log.head()->block_num(), 25);
+
+                for (uint32_t n = 25; n >= 1; --n) {
+                    auto block = log.read_block_by_num(n);
+                    BOOST_REQUIRE(block.valid());
+                    BOOST_CHECK(block->id() == blocks[n - 1].id());
+                }
+                BOOST_CHECK(!log.read_block_by_num(26).valid());
+
+                auto result = log.read_block(log.get_block_pos(10));
+                BOOST_CHECK(result.first.id() == blocks[9].id());
+                BOOST_CHECK(log.read_block(result.second).first.id() == blocks[10].id());
+
+                BOOST_TEST_MESSAGE("--- Append after reopen fills the head frame");
+                for (int i = 0; i < 10; ++i) {
+                    log.append(make_block());
+                }
+                BOOST_CHECK_EQUAL(log.head()->block_num(), 35);
+                log.close();
+            }
+
+            BOOST_TEST_MESSAGE("--- Rebuild lost index");
+            {
+                fc::remove_all(path.string() + ".index");
+
+                compressed_block_log log;
+                log.open(path);
+                BOOST_CHECK_EQUAL(log.frame_size(), 10);
+                BOOST_CHECK_EQUAL(log.head()->block_num(), 35);
+                for (uint32_t n = 1; n <= 35; ++n) {
+                    BOOST_CHECK(log.read_block_by_num(n)->id() == blocks[n - 1].id());
+                }
+            }
+        } FC_LOG_AND_RETHROW()
+    }
+    BOOST_AUTO_TEST_CASE(block_log_packed_blocks) {
+        try {
+            BOOST_TEST_MESSAGE("Testing: block_log_packed_blocks");
+
+            fc::temp_directory data_dir(golos::utilities::temp_directory_path());
+
+            std::vector<signed_block> blocks;
+            for (int i = 0; i < 10; ++i) {
+                signed_block b;
+                b.witness = "alice";
+                b.timestamp = fc::time_point_sec(STEEMIT_TESTING_GENESIS_TIMESTAMP + i * 3);
+                if (!blocks.empty()) {
+                    b.previous = blocks.back().id();
+                }
+                blocks.push_back(b);
+            }
+
+            auto check_packed_blocks = [&](const block_log& log) {
+                std::vector<char> data;
+                BOOST_CHECK_EQUAL(log.read_packed_blocks(3, 5, 1024 * 1024, data), 5);
+                fc::datastream<const char*> ds(data.data(), data.size());
+                for (uint32_t n = 3; n < 8; ++n) {
+                    signed_block block;
+                    fc::raw::unpack(ds, block);
+                    BOOST_CHECK(block.id() == blocks[n - 1].id());
+                }
+                BOOST_CHECK_EQUAL(ds.remaining(), 0);
+
+                BOOST_TEST_MESSAGE("--- Size limit, at least one block is read");
+                data.clear();
+                BOOST_CHECK_EQUAL(log.read_packed_blocks(3, 5, 1, data), 1);
+                BOOST_CHECK(fc::raw::unpack<signed_block>(data).id() == blocks[2].id());
+
+                BOOST_TEST_MESSAGE("--- Range after head");
+                data.clear();
+                BOOST_CHECK_EQUAL(log.read_packed_blocks(8, 5, 1024 * 1024, data), 3);
+                data.clear();
+                BOOST_CHECK_EQUAL(log.read_packed_blocks(11, 5, 1024 * 1024, data), 0);
+                BOOST_CHECK(data.empty());
+            };
+
+            BOOST_TEST_MESSAGE("--- Read from block log");
+            {
+                block_log log;
+                log.open(data_dir.path() / "block_log");
+                for (const auto& b: blocks) {
+                    log.append(b);
+                }
+                check_packed_blocks(log);
+            }
+
+            BOOST_TEST_MESSAGE("--- Read from compressed block log");
+            {
+                auto path = data_dir.path() / "compressed_block_log";
+                {
+                    compressed_block_log log;
+                    log.open(path, 4);
+                    for (const auto& b: blocks) {
+                        log.append(b);
+                    }
+                    log.close();
+                }
+                block_log log;
+                log.open(path);
+                check_packed_blocks(log);
+            }
+        } FC_LOG_AND_RETHROW()
+    }
+
+    BOOST_AUTO_TEST_CASE(state_snapshot) {
+        try {
+            BOOST_TEST_MESSAGE("Testing: state_snapshot");
+
+            fc::temp_directory data_dir(golos::utilities::temp_directory_path());
+            fc::temp_directory data_dir2(golos::utilities::temp_directory_path());
+            auto snapshot_file = data_dir.path() / "snapshot.bin";
+            auto init_account_priv_key = STEEMIT_INIT_PRIVATE_KEY;
+
+            uint32_t head_block_num = 0;
+            block_id_type head_block_id;
+            std::vector<std::pair<std::string, asset>> balances;
+
+            BOOST_TEST_MESSAGE("--- Generate blocks and write snapshot");
+            {
+                database db;
+                db._log_hardforks = false;
+                db.open(data_dir.path(), data_dir.path(), INITIAL_TEST_SUPPLY, TEST_SHARED_MEM_SIZE, chainbase::database::read_write);
+                for (uint32_t i = 0; i < 50; ++i) {
+                    db.generate_block(db.get_slot_time(1), db.get_scheduled_witness(1), init_account_priv_key, database::skip_nothing);
+                }
+                db.close();
+
+                // reopen to rewind state to the last irreversible block, which is the head of block log
+                db.open(data_dir.path(), data_dir.path(), INITIAL_TEST_SUPPLY, TEST_SHARED_MEM_SIZE, chainbase::database::read_write);
+                head_block_num = db.head_block_num();
+                head_block_id = db.head_block_id();
+                BOOST_REQUIRE(head_block_num > 0);
+
+                db.with_weak_read_lock([&]() {
+                    for (const auto& account: db.get_index<account_index>().indices()) {
+                        balances.emplace_back(account.name, account.balance);
+                    }
+                    db.write_snapshot(snapshot_file);
+                });
+                db.close();
+            }
+
+            fc::copy(data_dir.path() / "block_log", data_dir2.path() / "block_log");
+            fc::copy(data_dir.path() / "block_log.index", data_dir2.path() / "block_log.index");
+
+            BOOST_TEST_MESSAGE("--- Start from snapshot");
+            {
+                database db;
+                db._log_hardforks = false;
+                db.set_snapshot_file(snapshot_file);
+                db.open(data_dir2.path(), data_dir2.path(), INITIAL_TEST_SUPPLY, TEST_SHARED_MEM_SIZE, chainbase::database::read_write);
+
+                BOOST_CHECK_EQUAL(db.head_block_num(), head_block_num);
+                BOOST_CHECK(db.head_block_id() == head_block_id);
+                BOOST_CHECK_EQUAL(db.revision(), head_block_num);
+
+                db.with_weak_read_lock([&]() {
+                    BOOST_CHECK_EQUAL(db.get_index<account_index>().indices().size(), balances.size());
+                    for (const auto& balance: balances) {
+                        BOOST_CHECK_EQUAL(db.get_account(balance.first).balance, balance.second);
+                    }
+                });
+
+                BOOST_TEST_MESSAGE("--- Continue producing blocks");
+                for (uint32_t i = 0; i < 5; ++i) {
+                    db.generate_block(db.get_slot_time(1), db.get_scheduled_witness(1), init_account_priv_key, database::skip_nothing);
+                }
+                BOOST_CHECK_EQUAL(db.head_block_num(), head_block_num + 5);
+                db.close();
+            }
+
+            BOOST_TEST_MESSAGE("--- Snapshot beyond head of block log is refused");
+            {
+                fc::temp_directory data_dir3(golos::utilities::temp_directory_path());
+                database db;
+                db._log_hardforks = false;
+                db.set_snapshot_file(snapshot_file);
+                BOOST_CHECK_THROW(
+                    db.open(data_dir3.path(), data_dir3.path(), INITIAL_TEST_SUPPLY, TEST_SHARED_MEM_SIZE, chainbase::database::read_write),
+                    fc::exception);
+            }
+        } FC_LOG_AND_RETHROW()
+    }
+
+    BOOST_AUTO_TEST_CASE(lock_stats_test) {
+        try {
+            BOOST_TEST_MESSAGE("Testing: lock_stats");
+
+            fc::temp_directory data_dir(golos::utilities::temp_directory_path());
+            auto init_account_priv_key = STEEMIT_INIT_PRIVATE_KEY;
+
+            database db;
+            db._log_hardforks = false;
+            db.open(data_dir.path(), data_dir.path(), INITIAL_TEST_SUPPLY, TEST_SHARED_MEM_SIZE, chainbase::database::read_write);
+            db.get_lock_stats().enable(true);
+
+            db.generate_block(db.get_slot_time(1), db.get_scheduled_witness(1), init_account_priv_key, database::skip_nothing);
+            {
+                golos::chain::lock_stats::context_guard context("test_api.get_something");
+                db.with_weak_read_lock([&]() {
+                    // nested lock isn't counted
+                    db.with_weak_read_lock([&]() {
+                        BOOST_CHECK(db.head_block_num() > 0);
+                    });
+                });
+            }
+
+            auto stats = db.get_lock_stats().get();
+            auto find = [&](const std::string& context, lock_type type) {
+                auto itr = std::find_if(stats.begin(), stats.end(), [&](const lock_stats_item& item) {
+                    return item.context == context && item.type == type;
+                });
+                BOOST_REQUIRE(itr != stats.end());
+                return *itr;
+            };
+
+            auto generate = find("generate_block", lock_type::strong_write);
+            BOOST_CHECK_EQUAL(generate.count, 1);
+            BOOST_CHECK_EQUAL(generate.timeouts, 0);
+
+            auto api = find("test_api.get_something", lock_type::weak_read);
+            BOOST_CHECK_EQUAL(api.count, 1);
+            BOOST_CHECK_EQUAL(api.wait_histogram.size(), golos::chain::lock_stats::wait_buckets.size() + 1);
+            BOOST_CHECK_EQUAL(std::accumulate(api.wait_histogram.begin(), api.wait_histogram.end(), uint64_t(0)), 1);
+            BOOST_CHECK_EQUAL(golos::chain::lock_stats::current_context(), "other");
+
+            db.get_lock_stats().clear();
+            BOOST_CHECK(db.get_lock_stats().get().empty());
+            db.close();
+        } FC_LOG_AND_RETHROW()
+    }
+
+    BOOST_AUTO_TEST_CASE(pending_transactions_restore) {
+        try {
+            BOOST_TEST_MESSAGE("Testing: re-applying of pending transactions after block");
+
+            fc::temp_directory dir1(golos::utilities::temp_directory_path()),
+                    dir2(golos::utilities::temp_directory_path());
+            database db1,
+                    db2;
+            db1._log_hardforks = false;
+            db1.open(dir1.path(), dir1.path(), INITIAL_TEST_SUPPLY, TEST_SHARED_MEM_SIZE, chainbase::database::read_write);
+            db2._log_hardforks = false;
+            db2.open(dir2.path(), dir2.path(), INITIAL_TEST_SUPPLY, TEST_SHARED_MEM_SIZE, chainbase::database::read_write);
+
+            auto skip_sigs = database::skip_transaction_signatures |
+                             database::skip_authority_check;
+
+            auto init_account_priv_key = STEEMIT_INIT_PRIVATE_KEY;
+            public_key_type init_account_pub_key = init_account_priv_key.get_public_key();
+
+            auto make_transfer = [&](const std::string& from, const std::string& to, int64_t amount, uint32_t ttl) {
+                signed_transaction trx;
+                transfer_operation t;
+                t.from = from;
+                t.to = to;
+                t.amount = asset(amount, STEEM_SYMBOL);
+                trx.operations.push_back(t);
+                trx.set_expiration(db1.head_block_time() + ttl);
+                trx.sign(init_account_priv_key, db1.get_chain_id());
+                return trx;
+            };
+
+            signed_transaction trx;
+            account_create_operation cop;
+            cop.new_account_name = "alice";
+            cop.creator = STEEMIT_INIT_MINER_NAME;
+            cop.owner = authority(1, init_account_pub_key, 1);
+            cop.active = cop.owner;
+            trx.operations.push_back(cop);
+            transfer_operation t;
+            t.from = STEEMIT_INIT_MINER_NAME;
+            t.to = "alice";
+            t.amount = asset(500, STEEM_SYMBOL);
+            trx.operations.push_back(t);
+            trx.set_expiration(db1.head_block_time() + STEEMIT_MAX_TIME_UNTIL_EXPIRATION);
+            trx.sign(init_account_priv_key, db1.get_chain_id());
+            PUSH_TX(db1, trx, skip_sigs);
+
+            auto b = db1.generate_block(db1.get_slot_time(1), db1.get_scheduled_witness(1), init_account_priv_key, skip_sigs);
+            PUSH_BLOCK(db2, b, skip_sigs);
+
+            // the block of db2 includes the transaction of initminer
+            auto included = make_transfer(STEEMIT_INIT_MINER_NAME, "alice", 10, STEEMIT_MAX_TIME_UNTIL_EXPIRATION);
+            PUSH_TX(db2, included, skip_sigs);
+            b = db2.generate_block(db2.get_slot_time(1), db2.get_scheduled_witness(1), init_account_priv_key, skip_sigs);
+
+            auto transfer_out = make_transfer("alice", STEEMIT_INIT_MINER_NAME, 100, STEEMIT_MAX_TIME_UNTIL_EXPIRATION);
+            auto transfer_in = make_transfer(STEEMIT_INIT_MINER_NAME, "alice", 20, STEEMIT_MAX_TIME_UNTIL_EXPIRATION);
+            auto expiring = make_transfer("alice", STEEMIT_INIT_MINER_NAME, 1, 1);
+            PUSH_TX(db1, transfer_out, skip_sigs);
+            PUSH_TX(db1, included, skip_sigs);
+            PUSH_TX(db1, transfer_in, skip_sigs);
+            PUSH_TX(db1, expiring, skip_sigs);
+
+            auto before = db1.get_pending_transactions_stats();
+            PUSH_BLOCK(db1, b, skip_sigs);
+            auto after = db1.get_pending_transactions_stats();
+
+            BOOST_CHECK_EQUAL(after.rebuilds - before.rebuilds, 1);
+            BOOST_CHECK_EQUAL(after.reapplied - before.reapplied, 2);
+            BOOST_CHECK_EQUAL(after.dropped_included - before.dropped_included, 1);
+            BOOST_CHECK_EQUAL(after.dropped_expired - before.dropped_expired, 1);
+            BOOST_CHECK_EQUAL(after.failed - before.failed, 0);
+            BOOST_CHECK_EQUAL(after.pending, 2);
+
+            // pending transactions are applied on top of the new block
+            BOOST_CHECK_EQUAL(db1.get_balance("alice", STEEM_SYMBOL).amount.value, 500 + 10 + 20 - 100);
+
+            b = db1.generate_block(db1.get_slot_time(1), db1.get_scheduled_witness(1), init_account_priv_key, skip_sigs);
+            BOOST_CHECK_EQUAL(b.transactions.size(), 2);
+            BOOST_CHECK_EQUAL(db1.get_pending_transactions_stats().pending, 0);
+
+            db1.close();
+            db2.close();
+        } FC_LOG_AND_RETHROW()
+    }
+
+    BOOST_AUTO_TEST_CASE(candidate_block) {
+        try {
+            BOOST_TEST_MESSAGE("Testing: generating of block from candidate");
+
+            fc::temp_directory data_dir(golos::utilities::temp_directory_path());
+            database db;
+            db._log_hardforks = false;
+            db.open(data_dir.path(), data_dir.path(), INITIAL_TEST_SUPPLY, TEST_SHARED_MEM_SIZE, chainbase::database::read_write);
+            db.enable_candidate_block(true);
+
+            auto skip_sigs = database::skip_transaction_signatures |
+                             database::skip_authority_check;
+
+            auto init_account_priv_key = STEEMIT_INIT_PRIVATE_KEY;
+            public_key_type init_account_pub_key = init_account_priv_key.get_public_key();
+
+            auto make_transfer = [&](int64_t amount, uint32_t ttl) {
+                signed_transaction trx;
+                transfer_operation t;
+                t.from = STEEMIT_INIT_MINER_NAME;
+                t.to = "alice";
+                t.amount = asset(amount, STEEM_SYMBOL);
+                trx.operations.push_back(t);
+                trx.set_expiration(db.head_block_time() + ttl);
+                trx.sign(init_account_priv_key, db.get_chain_id());
+                return trx;
+            };
+
+            signed_transaction trx;
+            account_create_operation cop;
+            cop.new_account_name = "alice";
+            cop.creator = STEEMIT_INIT_MINER_NAME;
+            cop.owner = authority(1, init_account_pub_key, 1);
+            cop.active = cop.owner;
+            trx.operations.push_back(cop);
+            trx.set_expiration(db.head_block_time() + STEEMIT_MAX_TIME_UNTIL_EXPIRATION);
+            trx.sign(init_account_priv_key, db.get_chain_id());
+            PUSH_TX(db, trx, skip_sigs);
+            PUSH_TX(db, make_transfer(500, STEEMIT_MAX_TIME_UNTIL_EXPIRATION), skip_sigs);
+
+            auto rebuilds = db.get_pending_transactions_stats().rebuilds;
+            auto b = db.generate_block(db.get_slot_time(1), db.get_scheduled_witness(1), init_account_priv_key, skip_sigs);
+            BOOST_CHECK_EQUAL(b.transactions.size(), 2);
+            BOOST_CHECK_EQUAL(db.get_balance("alice", STEEM_SYMBOL).amount.value, 500);
+            // the candidate is taken without rebuilding, only push_block restores the pending state
+            BOOST_CHECK_EQUAL(db.get_pending_transactions_stats().rebuilds - rebuilds, 1);
+            BOOST_CHECK_EQUAL(db.get_pending_transactions_stats().pending, 0);
+
+            // the expiring transaction makes the candidate invalid, the block is rebuilt without it
+            PUSH_TX(db, make_transfer(10, STEEMIT_MAX_TIME_UNTIL_EXPIRATION), skip_sigs);
+            PUSH_TX(db, make_transfer(1, 1), skip_sigs);
+            rebuilds = db.get_pending_transactions_stats().rebuilds;
+            b = db.generate_block(db.get_slot_time(1), db.get_scheduled_witness(1), init_account_priv_key, skip_sigs);
+            BOOST_CHECK_EQUAL(b.transactions.size(), 1);
+            BOOST_CHECK_EQUAL(db.get_balance("alice", STEEM_SYMBOL).amount.value, 510);
+            BOOST_CHECK_EQUAL(db.get_pending_transactions_stats().rebuilds - rebuilds, 2);
+            BOOST_CHECK_EQUAL(db.get_pending_transactions_stats().pending, 0);
+
+            db.close();
+        } FC_LOG_AND_RETHROW()
+    }
 BOOST_AUTO_TEST_SUITE_END()
 #endif